@@ -0,0 +1,371 @@
+#include "allocation.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// The passes followed by the time outside of them
+#define ALLOCATION_PASS_COUNT (compiler_pass_count + 1)
+
+typedef struct allocation_counters {
+    size_t allocations;
+    size_t allocated_bytes;
+    size_t frees;
+    size_t live_objects;
+    size_t live_bytes;
+    size_t peak_bytes;
+} allocation_counters_t;
+
+typedef struct allocation_thread allocation_thread_t;
+
+// Counters of the blocks allocated by one thread. Blocks may be released
+// by other threads, so the counters they decrement are updated atomically,
+// and a thread's counters outlive it to be reported on exit.
+struct allocation_thread {
+    allocation_counters_t kinds[allocation_kind_count];
+    // Peak bytes of a pass are the most this thread held during it
+    allocation_counters_t passes[ALLOCATION_PASS_COUNT];
+    size_t live_bytes;
+    size_t leaked_objects[allocation_kind_count];
+    size_t leaked_bytes[allocation_kind_count];
+    const char* leak_owners[allocation_kind_count];
+    allocation_thread_t* next;
+};
+
+typedef struct allocation_header {
+    allocation_thread_t* owner;
+    size_t size;
+    allocation_kind_t kind;
+    compiler_pass_t pass;
+} allocation_header_t;
+
+// Keeps the blocks handed out as aligned as malloc's
+#define ALLOCATION_HEADER_SIZE \
+    ((sizeof(allocation_header_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+static const allocator_t* current_allocator = &default_allocator;
+static allocation_thread_t* allocation_threads = NULL;
+static pthread_mutex_t allocation_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local allocation_thread_t* current_allocation_thread = NULL;
+static _Thread_local compiler_pass_t current_allocation_pass = compiler_pass_count;
+
+void* default_allocate(allocation_kind_t kind, size_t size);
+
+void* default_reallocate(allocation_kind_t kind, void* memory, size_t size);
+
+void default_release(allocation_kind_t kind, void* memory);
+
+void* tracking_allocate(allocation_kind_t kind, size_t size);
+
+void* tracking_reallocate(allocation_kind_t kind, void* memory, size_t size);
+
+void tracking_release(allocation_kind_t kind, void* memory);
+
+allocation_thread_t* allocation_current_thread();
+
+void allocation_track(allocation_header_t* header, allocation_kind_t kind, size_t size);
+
+void allocation_untrack(allocation_header_t* header);
+
+size_t allocation_counters_add(allocation_counters_t* counters, size_t size);
+
+void allocation_counters_remove(allocation_counters_t* counters, size_t size);
+
+void allocation_counters_merge(allocation_counters_t* total, const allocation_counters_t* counters);
+
+void print_allocation_counters(FILE* stream, const char* name, const allocation_counters_t* counters);
+
+const char* allocation_kind_to_string(allocation_kind_t kind);
+
+const allocator_t default_allocator = {
+    &default_allocate,
+    &default_reallocate,
+    &default_release
+};
+
+const allocator_t tracking_allocator = {
+    &tracking_allocate,
+    &tracking_reallocate,
+    &tracking_release
+};
+
+
+void set_allocator(const allocator_t* allocator) {
+    current_allocator = allocator;
+}
+
+
+void* allocate(allocation_kind_t kind, size_t size) {
+    return current_allocator->allocate(kind, size);
+}
+
+
+void* reallocate(allocation_kind_t kind, void* memory, size_t size) {
+    return current_allocator->reallocate(kind, memory, size);
+}
+
+
+void release(allocation_kind_t kind, void* memory) {
+    current_allocator->release(kind, memory);
+}
+
+
+char* allocate_string(const char* string) {
+    size_t size = strlen(string) + 1;
+    char* copy = allocate(allocation_string, size);
+    memcpy(copy, string, size);
+    return copy;
+}
+
+
+void allocation_set_pass(compiler_pass_t pass) {
+    current_allocation_pass = pass;
+}
+
+
+allocation_mark_t allocation_mark() {
+    allocation_mark_t mark;
+    memset(&mark, 0, sizeof(mark));
+    if(current_allocator != &tracking_allocator) {
+        return mark;
+    }
+    allocation_thread_t* thread = allocation_current_thread();
+    for(allocation_kind_t kind = 0; kind < allocation_kind_count; kind++) {
+        mark.objects[kind] = __atomic_load_n(&thread->kinds[kind].live_objects, __ATOMIC_RELAXED);
+        mark.bytes[kind] = __atomic_load_n(&thread->kinds[kind].live_bytes, __ATOMIC_RELAXED);
+    }
+    return mark;
+}
+
+
+void allocation_check_leaks(const allocation_mark_t* mark, allocation_kind_t kind, const char* owner) {
+    if(current_allocator != &tracking_allocator) {
+        return;
+    }
+    allocation_thread_t* thread = allocation_current_thread();
+    size_t objects = __atomic_load_n(&thread->kinds[kind].live_objects, __ATOMIC_RELAXED);
+    size_t bytes = __atomic_load_n(&thread->kinds[kind].live_bytes, __ATOMIC_RELAXED);
+    if(objects > mark->objects[kind]) {
+        thread->leaked_objects[kind] += objects - mark->objects[kind];
+        thread->leaked_bytes[kind] += bytes > mark->bytes[kind] ? bytes - mark->bytes[kind] : 0;
+        thread->leak_owners[kind] = owner;
+    }
+}
+
+
+void print_allocation_statistics(FILE* stream) {
+    if(current_allocator != &tracking_allocator) {
+        return;
+    }
+
+    allocation_counters_t kinds[allocation_kind_count];
+    allocation_counters_t passes[ALLOCATION_PASS_COUNT];
+    size_t leaked_objects[allocation_kind_count];
+    size_t leaked_bytes[allocation_kind_count];
+    const char* leak_owners[allocation_kind_count] = { NULL };
+    memset(kinds, 0, sizeof(kinds));
+    memset(passes, 0, sizeof(passes));
+    memset(leaked_objects, 0, sizeof(leaked_objects));
+    memset(leaked_bytes, 0, sizeof(leaked_bytes));
+
+    pthread_mutex_lock(&allocation_threads_lock);
+    for(allocation_thread_t* thread = allocation_threads; thread != NULL; thread = thread->next) {
+        for(allocation_kind_t kind = 0; kind < allocation_kind_count; kind++) {
+            allocation_counters_merge(&kinds[kind], &thread->kinds[kind]);
+            leaked_objects[kind] += thread->leaked_objects[kind];
+            leaked_bytes[kind] += thread->leaked_bytes[kind];
+            if(thread->leaked_objects[kind] > 0) {
+                leak_owners[kind] = thread->leak_owners[kind];
+            }
+        }
+        for(size_t pass = 0; pass < ALLOCATION_PASS_COUNT; pass++) {
+            allocation_counters_merge(&passes[pass], &thread->passes[pass]);
+        }
+    }
+    pthread_mutex_unlock(&allocation_threads_lock);
+
+    fprintf(stream, "%-18s %10s %12s %10s %10s %12s %12s\n", "Pass", "Allocs", "Bytes",
+            "Frees", "Live", "Live bytes", "Peak bytes");
+    for(size_t pass = 0; pass < ALLOCATION_PASS_COUNT; pass++) {
+        print_allocation_counters(stream, pass < compiler_pass_count ? compiler_pass_to_string(pass) : "outside passes",
+                                  &passes[pass]);
+    }
+    fprintf(stream, "%-18s %10s %12s %10s %10s %12s %12s\n", "Kind", "Allocs", "Bytes",
+            "Frees", "Live", "Live bytes", "Peak bytes");
+    for(allocation_kind_t kind = 0; kind < allocation_kind_count; kind++) {
+        print_allocation_counters(stream, allocation_kind_to_string(kind), &kinds[kind]);
+    }
+
+    allocation_counters_t live;
+    memset(&live, 0, sizeof(live));
+    for(allocation_kind_t kind = 0; kind < allocation_kind_count; kind++) {
+        allocation_counters_merge(&live, &kinds[kind]);
+    }
+    fprintf(stream, "Still allocated on exit: %zu objects (%zu bytes)\n", live.live_objects, live.live_bytes);
+
+    bool leaked = false;
+    for(allocation_kind_t kind = 0; kind < allocation_kind_count; kind++) {
+        if(leaked_objects[kind] > 0) {
+            fprintf(stream, "Leaked by %s: %zu %s objects (%zu bytes)\n", leak_owners[kind],
+                    leaked_objects[kind], allocation_kind_to_string(kind), leaked_bytes[kind]);
+            leaked = true;
+        }
+    }
+    if(!leaked) {
+        fprintf(stream, "No leaks found by delete_symbol_table or delete_ast\n");
+    }
+}
+
+
+void* default_allocate(allocation_kind_t kind, size_t size) {
+    return malloc(size);
+}
+
+
+void* default_reallocate(allocation_kind_t kind, void* memory, size_t size) {
+    return realloc(memory, size);
+}
+
+
+void default_release(allocation_kind_t kind, void* memory) {
+    free(memory);
+}
+
+
+void* tracking_allocate(allocation_kind_t kind, size_t size) {
+    allocation_header_t* header = malloc(ALLOCATION_HEADER_SIZE + size);
+    if(header == NULL) {
+        return NULL;
+    }
+    allocation_track(header, kind, size);
+    return (unsigned char*)header + ALLOCATION_HEADER_SIZE;
+}
+
+
+// A reallocation counts as freeing the old block and allocating the new one
+void* tracking_reallocate(allocation_kind_t kind, void* memory, size_t size) {
+    if(memory == NULL) {
+        return tracking_allocate(kind, size);
+    }
+    allocation_header_t* header = (allocation_header_t*)((unsigned char*)memory - ALLOCATION_HEADER_SIZE);
+    size_t old_size = header->size;
+    allocation_untrack(header);
+    allocation_header_t* moved = realloc(header, ALLOCATION_HEADER_SIZE + size);
+    if(moved == NULL) {
+        allocation_track(header, kind, old_size);
+        return NULL;
+    }
+    allocation_track(moved, kind, size);
+    return (unsigned char*)moved + ALLOCATION_HEADER_SIZE;
+}
+
+
+void tracking_release(allocation_kind_t kind, void* memory) {
+    if(memory == NULL) {
+        return;
+    }
+    allocation_header_t* header = (allocation_header_t*)((unsigned char*)memory - ALLOCATION_HEADER_SIZE);
+    allocation_untrack(header);
+    free(header);
+}
+
+
+allocation_thread_t* allocation_current_thread() {
+    if(current_allocation_thread == NULL) {
+        allocation_thread_t* thread = calloc(1, sizeof(allocation_thread_t));
+        pthread_mutex_lock(&allocation_threads_lock);
+        thread->next = allocation_threads;
+        allocation_threads = thread;
+        pthread_mutex_unlock(&allocation_threads_lock);
+        current_allocation_thread = thread;
+    }
+    return current_allocation_thread;
+}
+
+
+void allocation_track(allocation_header_t* header, allocation_kind_t kind, size_t size) {
+    allocation_thread_t* thread = allocation_current_thread();
+    header->owner = thread;
+    header->size = size;
+    header->kind = kind;
+    header->pass = current_allocation_pass;
+
+    size_t live_bytes = __atomic_add_fetch(&thread->live_bytes, size, __ATOMIC_RELAXED);
+    size_t kind_live_bytes = allocation_counters_add(&thread->kinds[kind], size);
+    allocation_counters_add(&thread->passes[header->pass], size);
+    // Only the owning thread raises its peaks
+    if(kind_live_bytes > thread->kinds[kind].peak_bytes) {
+        thread->kinds[kind].peak_bytes = kind_live_bytes;
+    }
+    if(live_bytes > thread->passes[header->pass].peak_bytes) {
+        thread->passes[header->pass].peak_bytes = live_bytes;
+    }
+}
+
+
+void allocation_untrack(allocation_header_t* header) {
+    allocation_thread_t* thread = header->owner;
+    __atomic_sub_fetch(&thread->live_bytes, header->size, __ATOMIC_RELAXED);
+    allocation_counters_remove(&thread->kinds[header->kind], header->size);
+    allocation_counters_remove(&thread->passes[header->pass], header->size);
+}
+
+
+// Returns the live bytes after the allocation
+size_t allocation_counters_add(allocation_counters_t* counters, size_t size) {
+    counters->allocations++;
+    counters->allocated_bytes += size;
+    __atomic_add_fetch(&counters->live_objects, 1, __ATOMIC_RELAXED);
+    return __atomic_add_fetch(&counters->live_bytes, size, __ATOMIC_RELAXED);
+}
+
+
+void allocation_counters_remove(allocation_counters_t* counters, size_t size) {
+    __atomic_add_fetch(&counters->frees, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&counters->live_objects, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&counters->live_bytes, size, __ATOMIC_RELAXED);
+}
+
+
+// Peaks of different threads are not simultaneous, the largest is kept
+void allocation_counters_merge(allocation_counters_t* total, const allocation_counters_t* counters) {
+    total->allocations += counters->allocations;
+    total->allocated_bytes += counters->allocated_bytes;
+    total->frees += __atomic_load_n(&counters->frees, __ATOMIC_RELAXED);
+    total->live_objects += __atomic_load_n(&counters->live_objects, __ATOMIC_RELAXED);
+    total->live_bytes += __atomic_load_n(&counters->live_bytes, __ATOMIC_RELAXED);
+    if(counters->peak_bytes > total->peak_bytes) {
+        total->peak_bytes = counters->peak_bytes;
+    }
+}
+
+
+void print_allocation_counters(FILE* stream, const char* name, const allocation_counters_t* counters) {
+    fprintf(stream, "%-18s %10zu %12zu %10zu %10zu %12zu %12zu\n", name,
+            counters->allocations,
+            counters->allocated_bytes,
+            counters->frees,
+            counters->live_objects,
+            counters->live_bytes,
+            counters->peak_bytes);
+}
+
+
+const char* allocation_kind_to_string(allocation_kind_t kind) {
+    switch(kind) {
+        case allocation_list: return "list";
+        case allocation_list_node: return "list node";
+        case allocation_ast: return "AST";
+        case allocation_symbol: return "symbol";
+        case allocation_symbol_table: return "symbol table";
+        case allocation_tac: return "TAC";
+        case allocation_string: return "string";
+        case allocation_tac_buffer: return "TAC buffer";
+        case allocation_emitter: return "emitter";
+        case allocation_assembly: return "assembly";
+        case allocation_function_cache: return "function cache";
+        case allocation_constant_folding: return "constant folding";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef ALLOCATION_H
+#define ALLOCATION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "compiler_pass.h"
+
+/*
+ * Allocation layer of the compiler's data structures. Every block is
+ * allocated and released through the current allocator, tagged with the
+ * kind of object it holds. The default allocator calls malloc directly;
+ * the tracking allocator also counts allocations, live bytes and peak
+ * bytes per kind and per compiler pass, and finds the symbols, strings and
+ * AST blocks still alive when their symbol table or tree is deleted.
+ * Scratch tables of the other optimization passes, the machine code
+ * encoder, the object writer and the thread pool use malloc directly and
+ * are not counted.
+ */
+typedef enum allocation_kind {
+    allocation_list,
+    allocation_list_node,
+    // Arena blocks, which hold the AST nodes and their children lists
+    allocation_ast,
+    allocation_symbol,
+    allocation_symbol_table,
+    allocation_tac,
+    allocation_string,
+    allocation_tac_buffer,
+    allocation_emitter,
+    // Assembly text of functions, as emitted, cached and put together
+    allocation_assembly,
+    allocation_function_cache,
+    allocation_constant_folding,
+    allocation_kind_count
+} allocation_kind_t;
+
+typedef struct allocator {
+    void* (*allocate)(allocation_kind_t kind, size_t size);
+    void* (*reallocate)(allocation_kind_t kind, void* memory, size_t size);
+    void (*release)(allocation_kind_t kind, void* memory);
+} allocator_t;
+
+extern const allocator_t default_allocator;
+extern const allocator_t tracking_allocator;
+
+// Live objects of this thread, taken when a structure is created so that
+// its destructor can tell what it failed to free
+typedef struct allocation_mark {
+    size_t objects[allocation_kind_count];
+    size_t bytes[allocation_kind_count];
+} allocation_mark_t;
+
+// Blocks must be released by the allocator that made them, so it can only
+// be chosen before the first allocation
+void set_allocator(const allocator_t* allocator);
+
+void* allocate(allocation_kind_t kind, size_t size);
+
+void* reallocate(allocation_kind_t kind, void* memory, size_t size);
+
+void release(allocation_kind_t kind, void* memory);
+
+char* allocate_string(const char* string);
+
+// Allocations of this thread are charged to the pass from now on,
+// compiler_pass_count meaning none
+void allocation_set_pass(compiler_pass_t pass);
+
+allocation_mark_t allocation_mark();
+
+// Records as leaked the objects of the kind allocated by this thread since
+// the mark that are still alive
+void allocation_check_leaks(const allocation_mark_t* mark, allocation_kind_t kind, const char* owner);
+
+// Totals of every thread, nothing is printed by the default allocator
+void print_allocation_statistics(FILE* stream);
+
+#endif
@@ -0,0 +1,118 @@
+#include "arena.h"
+
+#include <stddef.h>
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+
+typedef struct arena_block arena_block_t;
+
+struct arena_block {
+    arena_block_t* previous;
+    size_t capacity;
+    size_t used;
+};
+
+struct arena {
+    arena_block_t* current;
+    size_t block_size;
+    allocation_kind_t kind;
+    arena_stats_t stats;
+};
+
+size_t arena_align(size_t size);
+
+arena_block_t* new_arena_block(arena_t* arena, size_t capacity);
+
+unsigned char* arena_block_data(arena_block_t* block);
+
+
+arena_t* new_arena(size_t block_size, allocation_kind_t kind) {
+    arena_t* arena = allocate(kind, sizeof(arena_t));
+    arena->current = NULL;
+    arena->kind = kind;
+    arena->block_size = block_size > 0 ? arena_align(block_size) : ARENA_DEFAULT_BLOCK_SIZE;
+    arena->stats.bytes_used = 0;
+    arena->stats.bytes_reserved = 0;
+    arena->stats.blocks = 0;
+    arena->stats.allocations = 0;
+    return arena;
+}
+
+
+void delete_arena(arena_t* arena) {
+    if(arena == NULL) {
+        return;
+    }
+    arena_block_t* block = arena->current;
+    while(block != NULL) {
+        arena_block_t* previous = block->previous;
+        release(arena->kind, block);
+        block = previous;
+    }
+    release(arena->kind, arena);
+}
+
+
+void* arena_allocate(arena_t* arena, size_t size) {
+    size = arena_align(size > 0 ? size : 1);
+    arena_block_t* block = arena->current;
+
+    if(block == NULL || block->capacity - block->used < size) {
+        if(size > arena->block_size / 4 && block != NULL) {
+            // Big requests get a block of their own, chained behind the
+            // current one so its free space is not thrown away.
+            arena_block_t* big_block = new_arena_block(arena, size);
+            big_block->previous = block->previous;
+            block->previous = big_block;
+            block = big_block;
+        } else {
+            block = new_arena_block(arena, size > arena->block_size ? size : arena->block_size);
+            block->previous = arena->current;
+            arena->current = block;
+        }
+    }
+
+    void* memory = arena_block_data(block) + block->used;
+    block->used += size;
+    arena->stats.bytes_used += size;
+    arena->stats.allocations++;
+    return memory;
+}
+
+
+arena_stats_t arena_get_stats(const arena_t* arena) {
+    return arena->stats;
+}
+
+
+void arena_print_stats(FILE* stream, const char* name, const arena_t* arena) {
+    arena_stats_t stats = arena_get_stats(arena);
+    fprintf(stream, "%s arena: %zu bytes used in %zu allocations, "
+            "%zu blocks (%zu bytes reserved)\n",
+            name,
+            stats.bytes_used,
+            stats.allocations,
+            stats.blocks,
+            stats.bytes_reserved);
+}
+
+
+size_t arena_align(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+
+arena_block_t* new_arena_block(arena_t* arena, size_t capacity) {
+    arena_block_t* block = allocate(arena->kind, arena_align(sizeof(arena_block_t)) + capacity);
+    block->previous = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    arena->stats.bytes_reserved += capacity;
+    arena->stats.blocks++;
+    return block;
+}
+
+
+unsigned char* arena_block_data(arena_block_t* block) {
+    return (unsigned char*)block + arena_align(sizeof(arena_block_t));
+}
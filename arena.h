@@ -0,0 +1,31 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "allocation.h"
+
+typedef struct arena arena_t;
+
+typedef struct arena_stats {
+    size_t bytes_used;
+    size_t bytes_reserved;
+    size_t blocks;
+    size_t allocations;
+} arena_stats_t;
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+// Blocks are allocated as objects of the kind
+arena_t* new_arena(size_t block_size, allocation_kind_t kind);
+
+void delete_arena(arena_t* arena);
+
+void* arena_allocate(arena_t* arena, size_t size);
+
+arena_stats_t arena_get_stats(const arena_t* arena);
+
+void arena_print_stats(FILE* stream, const char* name, const arena_t* arena);
+
+#endif
@@ -1,19 +1,44 @@
 #include "argparse.h"
+#include <ctype.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <getopt.h>
 #include <stdio.h>
+#include <string.h>
 #include <libgen.h>
 
 void print_usage(char* program_name);
 
 void print_help(char* program_name);
 
+void add_file_pair(arguments_t* arguments, const char* source_file, const char* output_file);
+
+argparse_error_t read_manifest(arguments_t* arguments);
+
 argparse_error_t parse_arguments(int argc, char** argv, arguments_t* arguments) {
     arguments->print_parser_steps = 0;
     arguments->print_scanner_steps = 0;
     arguments->print_symbol_table = false;
     arguments->print_syntax_table = false;
     arguments->print_tacs_list = false;
+    arguments->print_ast_memory_stats = false;
+    arguments->print_function_times = false;
+    arguments->no_optimize = false;
+    arguments->print_statistics = false;
+    arguments->statistics_json = false;
+    arguments->print_allocations = false;
+    arguments->map_source_files = false;
+    arguments->emit_object = false;
+    arguments->run_program = false;
+    arguments->emit_tac = false;
+    arguments->dump_tac = false;
+    arguments->load_tac = false;
+    arguments->source_files = NULL;
+    arguments->output_files = NULL;
+    arguments->file_count = 0;
+    arguments->manifest_file = NULL;
+    arguments->cache_directory = NULL;
+    arguments->jobs = 0;
 
     int c = 0;
     while (c != -1) {
@@ -24,6 +49,20 @@ argparse_error_t parse_arguments(int argc, char** argv, arguments_t* arguments)
           {"print-symbol_table", no_argument, NULL, 't'},
           {"print-syntax_tree", no_argument, NULL, 'a'},
           {"print_tacs_list", no_argument, NULL, 'l'},
+          {"print-ast-memory", no_argument, NULL, 'm'},
+          {"print-function-times", no_argument, NULL, 'F'},
+          {"no-optimize", no_argument, NULL, 'N'},
+          {"time-passes", optional_argument, NULL, 'P'},
+          {"print-allocations", no_argument, NULL, 'A'},
+          {"mmap", no_argument, NULL, 'M'},
+          {"object", no_argument, NULL, 'c'},
+          {"run", no_argument, NULL, 'r'},
+          {"emit-tac", no_argument, NULL, 'T'},
+          {"dump-tac", no_argument, NULL, 'D'},
+          {"load-tac", no_argument, NULL, 'L'},
+          {"batch", required_argument, NULL, 'b'},
+          {"cache-dir", required_argument, NULL, 'C'},
+          {"jobs", required_argument, NULL, 'j'},
           {"help", no_argument, NULL, 'h'},
           {"usage", no_argument, NULL, 'u'},
           {0, 0, 0, 0}
@@ -31,7 +70,7 @@ argparse_error_t parse_arguments(int argc, char** argv, arguments_t* arguments)
       
         int option_index = 0;
 
-        c = getopt_long (argc, argv, "pstalh",
+        c = getopt_long (argc, argv, "pstalmFNP::AMcrTDLb:C:j:h",
                          long_options, &option_index);
 
         switch (c) {
@@ -50,6 +89,61 @@ argparse_error_t parse_arguments(int argc, char** argv, arguments_t* arguments)
             case 'l':
                 arguments->print_tacs_list = true;
                 break;
+            case 'm':
+                arguments->print_ast_memory_stats = true;
+                break;
+            case 'F':
+                arguments->print_function_times = true;
+                break;
+            case 'N':
+                arguments->no_optimize = true;
+                break;
+            case 'P':
+                arguments->print_statistics = true;
+                if(optarg != NULL && strcmp(optarg, "json") == 0) {
+                    arguments->statistics_json = true;
+                } else if(optarg != NULL && strcmp(optarg, "text") != 0) {
+                    fprintf(stderr, "%s: invalid statistics format '%s'\n", argv[0], optarg);
+                    return argparse_invalid_option;
+                }
+                break;
+            case 'A':
+                arguments->print_allocations = true;
+                break;
+            case 'M':
+                arguments->map_source_files = true;
+                break;
+            case 'c':
+                arguments->emit_object = true;
+                break;
+            case 'r':
+                arguments->run_program = true;
+                break;
+            case 'T':
+                arguments->emit_tac = true;
+                break;
+            case 'D':
+                arguments->dump_tac = true;
+                break;
+            case 'L':
+                arguments->load_tac = true;
+                break;
+            case 'b':
+                arguments->manifest_file = optarg;
+                break;
+            case 'C':
+                arguments->cache_directory = optarg;
+                break;
+            case 'j': {
+                char* end = NULL;
+                errno = 0;
+                arguments->jobs = strtoul(optarg, &end, 10);
+                if(!isdigit((unsigned char)optarg[0]) || *end != '\0' || errno != 0 || arguments->jobs == 0) {
+                    fprintf(stderr, "%s: invalid number of jobs '%s'\n", argv[0], optarg);
+                    return argparse_invalid_option;
+                }
+                break;
+            }
             case 'h':
                 print_help(argv[0]);
                 exit(EXIT_SUCCESS);
@@ -67,29 +161,103 @@ argparse_error_t parse_arguments(int argc, char** argv, arguments_t* arguments)
         }
     }
 
-    if(argc - optind != 2) {
+    int positionals = argc - optind;
+    if(arguments->run_program) {
+        if(positionals != 1 || arguments->manifest_file != NULL) {
+            print_usage(argv[0]);
+            return argparse_missing_positional;
+        }
+        add_file_pair(arguments, argv[optind], NULL);
+        return argparse_success;
+    }
+    if(positionals % 2 != 0 || (positionals == 0 && arguments->manifest_file == NULL)) {
         print_usage(argv[0]);
         return argparse_missing_positional;
-    } else {
-        arguments->source_file = argv[optind];
-        arguments->output_file = argv[optind+1];
+    }
+    for(int i = optind; i < argc; i += 2) {
+        add_file_pair(arguments, argv[i], argv[i+1]);
+    }
+
+    if(arguments->manifest_file != NULL) {
+        return read_manifest(arguments);
     }
 
     return argparse_success;
 }
 
+void delete_arguments(arguments_t* arguments) {
+    for(size_t i = 0; i < arguments->file_count; i++) {
+        free(arguments->source_files[i]);
+        free(arguments->output_files[i]);
+    }
+    free(arguments->source_files);
+    free(arguments->output_files);
+    arguments->file_count = 0;
+}
+
+void add_file_pair(arguments_t* arguments, const char* source_file, const char* output_file) {
+    size_t count = arguments->file_count + 1;
+    arguments->source_files = realloc(arguments->source_files, count * sizeof(char*));
+    arguments->output_files = realloc(arguments->output_files, count * sizeof(char*));
+    arguments->source_files[count-1] = strdup(source_file);
+    arguments->output_files[count-1] = output_file != NULL ? strdup(output_file) : NULL;
+    arguments->file_count = count;
+}
+
+// Each line of a manifest holds a source file and its output file separated
+// by blanks. Empty lines and lines starting with '#' are skipped. There
+// must be at least one file to compile, here or in the command line.
+argparse_error_t read_manifest(arguments_t* arguments) {
+    FILE* manifest = fopen(arguments->manifest_file, "r");
+    if(manifest == NULL) {
+        perror("Error openning manifest file");
+        return argparse_invalid_manifest;
+    }
+
+    argparse_error_t error = argparse_success;
+    char* line = NULL;
+    size_t capacity = 0;
+    int line_number = 0;
+    while(getline(&line, &capacity, manifest) != -1) {
+        line_number++;
+        char* saveptr = NULL;
+        char* source_file = strtok_r(line, " \t\r\n", &saveptr);
+        if(source_file == NULL || source_file[0] == '#') {
+            continue;
+        }
+        char* output_file = strtok_r(NULL, " \t\r\n", &saveptr);
+        if(output_file == NULL || strtok_r(NULL, " \t\r\n", &saveptr) != NULL) {
+            fprintf(stderr, "%s:%d: expected a source file and an output file\n",
+                    arguments->manifest_file, line_number);
+            error = argparse_invalid_manifest;
+            continue;
+        }
+        add_file_pair(arguments, source_file, output_file);
+    }
+
+    free(line);
+    fclose(manifest);
+    if(error == argparse_success && arguments->file_count == 0) {
+        fprintf(stderr, "%s: no source files listed\n", arguments->manifest_file);
+        error = argparse_invalid_manifest;
+    }
+    return error;
+}
+
 const char* usage_string() {
-    return "Usage: %s [OPTION...] source_file output_file";
+    return "Usage: %s [OPTION...] source_file output_file [source_file output_file...]";
 }
 
 void print_usage(char* program_name) {
-    fprintf(stderr, "Usage: %s [OPTION...] source_file output_file\n"
+    fprintf(stderr, "Usage: %s [OPTION...] source_file output_file [source_file output_file...]\n"
+            "  or:  %s --run [OPTION...] source_file\n"
             "Try `%s --help' for more information.\n", 
-            basename(program_name), program_name);
+            basename(program_name), basename(program_name), program_name);
 }
 
 void print_help(char* program_name) {
-    fprintf(stderr, "Usage: %s [OPTION...] source_file output_file\n"
+    fprintf(stderr, "Usage: %s [OPTION...] source_file output_file [source_file output_file...]\n"
+            "  or:  %s --run [OPTION...] source_file\n"
             "    UFRGS Compilers discipline assignment.\n"
             "\n"
             "    -a, --print-syntax-tree    Print the Abstract Syntax Tree generated\n"
@@ -99,12 +267,49 @@ void print_help(char* program_name) {
             "    -t, --print-symbol-table   Print all the contents of the parser's\n"
             "                               symbol table\n"
             "    -l, --print_tacs_list      Print list of generated TACS\n"
+            "    -m, --print-ast-memory     Print memory used by the Abstract Syntax\n"
+            "                               Tree arena\n"
+            "    -F, --print-function-times Print the time spent emitting the\n"
+            "                               assembly of each function\n"
+            "    -N, --no-optimize          Skip the constant folding, dead code\n"
+            "                               elimination and other optimizations\n"
+            "                               of the generated TAC\n"
+            "    -P, --time-passes[=FORMAT] Print the time spent in each pass and\n"
+            "                               counts of tokens, nodes, symbols and\n"
+            "                               TACs, as text (default) or json\n"
+            "    -A, --print-allocations    Print the memory allocated in each pass\n"
+            "                               and for each kind of object on exit,\n"
+            "                               and the objects leaked\n"
+            "    -M, --mmap                 Map source files into memory and scan\n"
+            "                               them in place instead of reading them\n"
+            "    -c, --object               Write ELF relocatable objects instead\n"
+            "                               of assembly\n"
+            "    -r, --run                  Compile the source file in memory and\n"
+            "                               run it, exiting with its status\n"
+            "    -T, --emit-tac             Write the generated TAC as a binary\n"
+            "                               file instead of assembly\n"
+            "    -D, --dump-tac             Write the generated TAC as text\n"
+            "                               instead of assembly\n"
+            "    -L, --load-tac             Read TAC files written by --emit-tac\n"
+            "                               instead of sources and only run the\n"
+            "                               back end\n"
+            "    -b, --batch=MANIFEST       Also compile every source and output\n"
+            "                               file pair listed in MANIFEST\n"
+            "    -C, --cache-dir=DIR        Reuse the assembly of functions that\n"
+            "                               did not change since it was cached\n"
+            "                               in DIR\n"
+            "    -j, --jobs=N               With several files, compile up to N\n"
+            "                               of them in parallel, each on a single\n"
+            "                               thread (default: number of\n"
+            "                               processors). With a single file, emit\n"
+            "                               its functions on N back end threads\n"
+            "                               (default: one)\n"
             "    -h, --help                 Give this help list\n"
             "        --usage                Give a short usage message\n"
             "\n"
             "Author: Felipe de Almeida Graeff.\n"
             "\n"
             "Report bugs to <felipe.graeff@inf.ufrgs.br>.\n",
-            basename(program_name));
+            basename(program_name), basename(program_name));
 }
 
@@ -2,23 +2,48 @@
 #define ARGPARSE_H
 
 #include <stdbool.h>
+#include <stdlib.h>
 
 typedef struct arguments {
-    char* source_file;
-    char* output_file;
+    // Source and output files are paired by index. In run mode there is a
+    // single source file and no output file.
+    char** source_files;
+    char** output_files;
+    size_t file_count;
+    char* manifest_file;
+    char* cache_directory;
+    size_t jobs;
     int print_parser_steps;
     int print_scanner_steps;
     bool print_symbol_table;
     bool print_syntax_table;
     bool print_tacs_list;
+    bool print_ast_memory_stats;
+    bool print_function_times;
+    bool no_optimize;
+    bool print_statistics;
+    // Statistics are printed as JSON instead of text
+    bool statistics_json;
+    // Memory is allocated through the tracking allocator and reported on exit
+    bool print_allocations;
+    bool map_source_files;
+    bool emit_object;
+    bool run_program;
+    bool emit_tac;
+    bool dump_tac;
+    // Source files are TAC files written with --emit-tac
+    bool load_tac;
 } arguments_t;
 
 typedef enum argparse_error {
     argparse_success = 0,
     argparse_invalid_option,
-    argparse_missing_positional
+    argparse_missing_positional,
+    argparse_invalid_manifest
 } argparse_error_t;
 
 argparse_error_t parse_arguments(int argc, char** argv, arguments_t* arguments);
 
+void delete_arguments(arguments_t* arguments);
+
 #endif
\ No newline at end of file
@@ -1,152 +1,350 @@
 #include "assembly_generator.h"
 
+#include <time.h>
+
+#include "allocation.h"
+#include "elf_writer.h"
+#include "emitter.h"
+#include "encoder.h"
 #include "tac.h"
+#include "thread_pool.h"
+
+/*
+ * Consecutive TACs generated together, either a whole function or the
+ * global data between two functions.
+ */
+typedef struct assembly_unit {
+    list_iterator_t first;
+    size_t tac_count;
+    // NULL for global data
+    const char* function;
+    const function_cache_t* cache;
+    bool cached;
+    char* text;
+    size_t text_size;
+    double milliseconds;
+} assembly_unit_t;
+
+void generate_program(emitter_t* emitter, list_t* tacs);
+
+bool generate_units(FILE* stream, list_t* tacs, size_t threads, FILE* times_log,
+                    const function_cache_t* cache);
+
+assembly_unit_t* partition_units(list_t* tacs, const function_cache_t* cache, size_t* unit_count);
 
-void generate_printf_strings(FILE* stream);
+void generate_unit(void* argument);
 
-void generate_assembly_for_tac(FILE* stream, tac_t* tac);
+double elapsed_milliseconds(const struct timespec* start, const struct timespec* end);
 
-void generate_init(FILE* stream, tac_t* tac);
+void generate_printf_strings(emitter_t* emitter);
 
-void generate_temp(FILE* stream, tac_t* tac);
+void generate_assembly_for_tac(emitter_t* emitter, tac_t* tac);
 
-void generate_literal(FILE* stream, tac_t* tac);
+void generate_init(emitter_t* emitter, tac_t* tac);
 
-void generate_vector_uninit(FILE* stream, tac_t* tac);
+void generate_temp(emitter_t* emitter, tac_t* tac);
 
-void generate_vector_init(FILE* stream, tac_t* tac);
+void generate_literal(emitter_t* emitter, tac_t* tac);
 
-void generate_vector_init_value(FILE* stream, tac_t* tac);
+void generate_vector_uninit(emitter_t* emitter, tac_t* tac);
 
-void generate_begin_function(FILE* stream, tac_t* tac);
+void generate_vector_init(emitter_t* emitter, tac_t* tac);
 
-void generate_end_function(FILE* stream, tac_t* tac);
+void generate_vector_init_value(emitter_t* emitter, tac_t* tac);
 
-void generate_vector_index(FILE* stream, tac_t* tac);
+void generate_begin_function(emitter_t* emitter, tac_t* tac);
 
-void generate_symbol(FILE* stream, tac_t* tac);
+void generate_end_function(emitter_t* emitter, tac_t* tac);
 
-void generate_basic_arithmetic(FILE* stream, tac_t* tac);
+void generate_vector_index(emitter_t* emitter, tac_t* tac);
 
-void generate_sub(FILE* stream, tac_t* tac);
+void generate_symbol(emitter_t* emitter, tac_t* tac);
 
-void generate_mul(FILE* stream, tac_t* tac);
+void generate_basic_arithmetic(emitter_t* emitter, tac_t* tac);
 
-void generate_div(FILE* stream, tac_t* tac);
+void generate_sub(emitter_t* emitter, tac_t* tac);
 
-void generate_comparison(FILE* stream, tac_t* tac);
+void generate_mul(emitter_t* emitter, tac_t* tac);
 
-void generate_dif(FILE* stream, tac_t* tac);
+void generate_div(emitter_t* emitter, tac_t* tac);
 
-void generate_gt(FILE* stream, tac_t* tac);
+void generate_comparison(emitter_t* emitter, tac_t* tac);
 
-void generate_ge(FILE* stream, tac_t* tac);
+void generate_dif(emitter_t* emitter, tac_t* tac);
 
-void generate_lt(FILE* stream, tac_t* tac);
+void generate_gt(emitter_t* emitter, tac_t* tac);
 
-void generate_le(FILE* stream, tac_t* tac);
+void generate_ge(emitter_t* emitter, tac_t* tac);
 
-void generate_move(FILE* stream, tac_t* tac);
+void generate_lt(emitter_t* emitter, tac_t* tac);
 
-void generate_vector_move(FILE* stream, tac_t* tac);
+void generate_le(emitter_t* emitter, tac_t* tac);
 
-void generate_jump_false(FILE* stream, tac_t* tac);
+void generate_move(emitter_t* emitter, tac_t* tac);
 
-void generate_jump(FILE* stream, tac_t* tac);
+void generate_vector_move(emitter_t* emitter, tac_t* tac);
 
-void generate_call(FILE* stream, tac_t* tac);
+void generate_jump_false(emitter_t* emitter, tac_t* tac);
 
-void generate_argument(FILE* stream, tac_t* tac);
+void generate_jump(emitter_t* emitter, tac_t* tac);
 
-void generate_parameter(FILE* stream, tac_t* tac);
+void generate_call(emitter_t* emitter, tac_t* tac);
 
-void generate_return(FILE* stream, tac_t* tac);
+void generate_argument(emitter_t* emitter, tac_t* tac);
 
-void generate_print(FILE* stream, tac_t* tac);
+void generate_parameter(emitter_t* emitter, tac_t* tac);
 
-void generate_read(FILE* stream, tac_t* tac);
+void generate_return(emitter_t* emitter, tac_t* tac);
 
-void generate_label(FILE* stream, tac_t* tac);
+void generate_print(emitter_t* emitter, tac_t* tac);
+
+void generate_read(emitter_t* emitter, tac_t* tac);
+
+void generate_label(emitter_t* emitter, tac_t* tac);
 
 size_t data_type_size(data_type_t type);
 
-void convert_byte_to_int(FILE* stream, char* variable);
+void convert_byte_to_int(emitter_t* emitter, char* variable);
+
+void convert_byte_to_float(emitter_t* emitter, char* variable);
 
-void convert_byte_to_float(FILE* stream, char* variable);
+void convert_int_to_float(emitter_t* emitter, char* variable);
 
-void convert_int_to_float(FILE* stream, char* variable);
+void convert_data_type(emitter_t* emitter, char* variable, data_type_t from, data_type_t to);
 
-void convert_data_type(FILE* stream, char* variable, data_type_t from, data_type_t to);
+x86_mnemonic_t operator_to_mnemonic(tac_type_t operator, data_type_t data_type);
 
-char* operator_to_mnemonic(tac_type_t operator, data_type_t data_type);
+// Instruction for each operator, on integers and on floats
+static const x86_mnemonic_t operator_mnemonics[][2] = {
+    [tac_sum] = { x86_addl, x86_addss },
+    [tac_sub] = { x86_subl, x86_subss },
+    [tac_mul] = { x86_imull, x86_mulss },
+    [tac_div] = { x86_idivl, x86_divss },
+    [tac_eq] = { x86_sete, x86_cmovne },
+    [tac_dif] = { x86_setne, x86_cmovne },
+    [tac_gt] = { x86_setg, x86_seta },
+    [tac_ge] = { x86_setge, x86_setnb },
+    [tac_lt] = { x86_setl, x86_seta },
+    [tac_le] = { x86_setle, x86_setnb }
+};
 
 
+bool generate_assembly(compilation_context_t* context, FILE* stream, list_t* tacs,
+                       size_t threads, FILE* times_log, const function_cache_t* cache) {
+    if(threads > 1 || times_log != NULL || cache != NULL) {
+        return generate_units(stream, tacs, threads, times_log, cache);
+    }
+    emitter_t* emitter = new_emitter(stream);
+    generate_program(emitter, tacs);
+    bool success = emitter_flush(emitter);
+    delete_emitter(emitter);
+    return success;
+}
 
 
-void generate_assembly(FILE* stream, list_t* tacs) {
-    generate_printf_strings(stream);
+bool generate_object(compilation_context_t* context, FILE* stream, list_t* tacs) {
+    encoder_t* encoder = generate_machine_code(context, tacs);
+    bool success = write_elf_object(encoder, stream);
+    delete_encoder(encoder);
+    return success;
+}
+
+
+encoder_t* generate_machine_code(compilation_context_t* context, list_t* tacs) {
+    encoder_t* encoder = new_encoder();
+    emitter_t* emitter = new_object_emitter(encoder);
+    generate_program(emitter, tacs);
+    delete_emitter(emitter);
+    encoder_finish(encoder);
+    return encoder;
+}
+
+
+void generate_program(emitter_t* emitter, list_t* tacs) {
+    generate_printf_strings(emitter);
     for(list_iterator_t it = list_begin(tacs); list_current(it) != NULL; list_next(&it)) {
-        generate_assembly_for_tac(stream, list_current(it));
+        generate_assembly_for_tac(emitter, list_current(it));
+    }
+}
+
+
+bool generate_units(FILE* stream, list_t* tacs, size_t threads, FILE* times_log,
+                    const function_cache_t* cache) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t unit_count;
+    assembly_unit_t* units = partition_units(tacs, cache, &unit_count);
+    size_t pool_size = threads < unit_count ? threads : unit_count;
+    if(pool_size > 1) {
+        thread_pool_t* pool = new_thread_pool(pool_size);
+        for(size_t i = 0; i < unit_count; i++) {
+            thread_pool_submit(pool, &generate_unit, &units[i]);
+        }
+        delete_thread_pool(pool);
+    } else {
+        for(size_t i = 0; i < unit_count; i++) {
+            generate_unit(&units[i]);
+        }
+    }
+
+    emitter_t* emitter = new_emitter(stream);
+    generate_printf_strings(emitter);
+    for(size_t i = 0; i < unit_count; i++) {
+        emitter_append(emitter, units[i].text, units[i].text_size);
+        release(allocation_assembly, units[i].text);
+    }
+    bool success = emitter_flush(emitter);
+    delete_emitter(emitter);
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if(times_log != NULL) {
+        size_t cached_count = 0;
+        for(size_t i = 0; i < unit_count; i++) {
+            if(units[i].cached) {
+                fprintf(times_log, "Function %s: %.3f ms (cached)\n", units[i].function, units[i].milliseconds);
+                cached_count++;
+            } else if(units[i].function != NULL) {
+                fprintf(times_log, "Function %s: %.3f ms\n", units[i].function, units[i].milliseconds);
+            } else {
+                fprintf(times_log, "Global data: %.3f ms\n", units[i].milliseconds);
+            }
+        }
+        fprintf(times_log, "%zu units emitted on %zu threads in %.3f ms\n",
+                unit_count, pool_size > 1 ? pool_size : 1, elapsed_milliseconds(&start, &end));
+        if(cache != NULL) {
+            fprintf(times_log, "%zu functions reused from the cache\n", cached_count);
+        }
+    }
+    release(allocation_assembly, units);
+    return success;
+}
+
+
+assembly_unit_t* partition_units(list_t* tacs, const function_cache_t* cache, size_t* unit_count) {
+    size_t capacity = 16;
+    assembly_unit_t* units = allocate(allocation_assembly, capacity * sizeof(assembly_unit_t));
+    *unit_count = 0;
+
+    assembly_unit_t* current = NULL;
+    for(list_iterator_t it = list_begin(tacs); list_current(it) != NULL; list_next(&it)) {
+        tac_t* tac = list_current(it);
+        bool starts_function = tac->type == tac_begin_function;
+        if(current == NULL || starts_function) {
+            if(*unit_count == capacity) {
+                capacity *= 2;
+                units = reallocate(allocation_assembly, units, capacity * sizeof(assembly_unit_t));
+            }
+            current = &units[(*unit_count)++];
+            current->first = it;
+            current->tac_count = 0;
+            current->function = starts_function ? tac->res->value : NULL;
+            current->cache = starts_function ? cache : NULL;
+            current->cached = false;
+            current->text = NULL;
+            current->text_size = 0;
+            current->milliseconds = 0;
+        }
+        current->tac_count++;
+        if(tac->type == tac_end_function) {
+            current = NULL;
+        }
+    }
+    return units;
+}
+
+
+void generate_unit(void* argument) {
+    assembly_unit_t* unit = argument;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if(unit->cache != NULL) {
+        unit->text = function_cache_load(unit->cache, unit->function, &unit->text_size);
+        unit->cached = unit->text != NULL;
     }
+    if(!unit->cached) {
+        emitter_t* emitter = new_buffer_emitter();
+        list_iterator_t it = unit->first;
+        for(size_t i = 0; i < unit->tac_count; i++) {
+            generate_assembly_for_tac(emitter, list_current(it));
+            list_next(&it);
+        }
+        unit->text = emitter_take_text(emitter, &unit->text_size);
+        delete_emitter(emitter);
+        if(unit->cache != NULL) {
+            function_cache_store(unit->cache, unit->function, unit->text, unit->text_size);
+        }
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    unit->milliseconds = elapsed_milliseconds(&start, &end);
 }
 
 
-void generate_printf_strings(FILE* stream) {
-    fprintf(stream,
-            ".intfmt:\n"
-            "\t.string \"%%d\"\n"
-            ".charfmt:\n"
-            "\t.string \"%%c\"\n"
-            ".floatfmt:\n"
-            "\t.string \"%%f\"\n");
+double elapsed_milliseconds(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec) * 1e3 + (end->tv_nsec - start->tv_nsec) / 1e6;
 }
 
 
-void generate_assembly_for_tac(FILE* stream, tac_t* tac) {
+void generate_printf_strings(emitter_t* emitter) {
+    emit_section(emitter, x86_section_rodata);
+    emit_label(emitter, ".intfmt");
+    emit_data_text(emitter, x86_data_string, "\"%d\"");
+    emit_label(emitter, ".charfmt");
+    emit_data_text(emitter, x86_data_string, "\"%c\"");
+    emit_label(emitter, ".floatfmt");
+    emit_data_text(emitter, x86_data_string, "\"%f\"");
+}
+
+
+void generate_assembly_for_tac(emitter_t* emitter, tac_t* tac) {
     switch (tac->type) {
         case tac_init:
-            generate_init(stream, tac);
+            generate_init(emitter, tac);
             break;
         case tac_temp:
-            generate_temp(stream, tac);
+            generate_temp(emitter, tac);
             break;
         case tac_literal:
-            generate_literal(stream, tac);
+            generate_literal(emitter, tac);
             break;
         case tac_vector_uninit:
-            generate_vector_uninit(stream, tac);
+            generate_vector_uninit(emitter, tac);
             break;
         case tac_vector_init:
-            generate_vector_init(stream, tac);
+            generate_vector_init(emitter, tac);
             break;
         case tac_vector_init_value:
-            generate_vector_init_value(stream, tac);
+            generate_vector_init_value(emitter, tac);
             break;
         case tac_begin_function:
-            generate_begin_function(stream, tac);
+            generate_begin_function(emitter, tac);
             break;
         case tac_end_function:
-            generate_end_function(stream, tac);
+            generate_end_function(emitter, tac);
             break;
         case tac_argument:
-            generate_argument(stream, tac);
+            generate_argument(emitter, tac);
             break;
         case tac_call:
-            generate_call(stream, tac);
+            generate_call(emitter, tac);
             break;
         case tac_parameter:
-            generate_parameter(stream, tac);
+            generate_parameter(emitter, tac);
             break;
         case tac_return:
-            generate_return(stream, tac);
+            generate_return(emitter, tac);
             break;
         case tac_sum:
         case tac_sub:
         case tac_mul:
-            generate_basic_arithmetic(stream, tac);
+            generate_basic_arithmetic(emitter, tac);
             break;
         case tac_div:
-            generate_div(stream, tac);
+            generate_div(emitter, tac);
             break;
         case tac_eq:
         case tac_dif:
@@ -154,31 +352,31 @@ void generate_assembly_for_tac(FILE* stream, tac_t* tac) {
         case tac_ge:
         case tac_lt:
         case tac_le:
-            generate_comparison(stream, tac);
+            generate_comparison(emitter, tac);
             break;
         case tac_move:
-            generate_move(stream, tac);
+            generate_move(emitter, tac);
             break;
         case tac_label:
-            generate_label(stream, tac);
+            generate_label(emitter, tac);
             break;
         case tac_jump_false:
-            generate_jump_false(stream, tac);
+            generate_jump_false(emitter, tac);
             break;
         case tac_jump:
-            generate_jump(stream, tac);
+            generate_jump(emitter, tac);
             break;
         case tac_vector_index:
-            generate_vector_index(stream, tac);
+            generate_vector_index(emitter, tac);
             break;
         case tac_vector_move:
-            generate_vector_move(stream, tac);
+            generate_vector_move(emitter, tac);
             break;
         case tac_print:
-            generate_print(stream, tac);
+            generate_print(emitter, tac);
             break;
         case tac_read:
-            generate_read(stream, tac);
+            generate_read(emitter, tac);
             break;
         case tac_symbol:
 
@@ -187,43 +385,28 @@ void generate_assembly_for_tac(FILE* stream, tac_t* tac) {
 }
 
 
-void generate_init(FILE* stream, tac_t* tac) {
+void generate_init(emitter_t* emitter, tac_t* tac) {
     size_t size = data_type_size(tac->res->data_type);
-    fprintf(stream, 
-            "\t.globl %s\n"
-            "\t.data\n"
-            "\t.align %ld\n"
-            "\t.type\t%s, @object\n"
-            "\t.size\t%s, %ld\n"
-            "%s:\n",
-            tac->res->value, 
-            size, 
-            tac->res->value, 
-            tac->res->value, 
-            size, 
-            tac->res->value);
-        
+    emit_global(emitter, tac->res->value);
+    emit_section(emitter, x86_section_data);
+    emit_align(emitter, size);
+    emit_object_type(emitter, tac->res->value);
+    emit_size(emitter, tac->res->value, size);
+    emit_label(emitter, tac->res->value);
+
     switch(tac->res->data_type) {
         case data_type_int:
-            fprintf(stream, 
-                    "\t.long %s\n",
-                    tac->op1->value);
+            emit_data_text(emitter, x86_data_long, tac->op1->value);
             break;
         case data_type_bool:
         case data_type_char:
-            fprintf(stream, 
-                    "\t.byte %s\n",
-                    tac->op1->value);
+            emit_data_text(emitter, x86_data_byte, tac->op1->value);
             break;
         case data_type_float:
-            fprintf(stream, 
-                    "\t.float %f\n",
-                    atof(tac->op1->value)/atof(tac->op2->value));
+            emit_data_float(emitter, atof(tac->op1->value)/atof(tac->op2->value));
             break;
         case data_type_string:
-            fprintf(stream, 
-                    "\t.string %s\n",
-                    tac->op1->value);
+            emit_data_text(emitter, x86_data_string, tac->op1->value);
             break;
         default:
             break;
@@ -231,16 +414,13 @@ void generate_init(FILE* stream, tac_t* tac) {
 }
 
 
-void generate_temp(FILE* stream, tac_t* tac) {
+void generate_temp(emitter_t* emitter, tac_t* tac) {
     size_t size = data_type_size(tac->res->data_type);
-    
-    fprintf(stream,
-            "\t.comm\t%s,%ld,%ld\n",
-            tac->res->value, size, size);
+    emit_common(emitter, tac->res->value, size, size);
 }
 
 
-void generate_literal(FILE* stream, tac_t* tac) {
+void generate_literal(emitter_t* emitter, tac_t* tac) {
 
 }
 
@@ -263,37 +443,26 @@ size_t data_type_size(data_type_t type) {
 }
 
 
-void generate_vector_uninit(FILE* stream, tac_t* tac) {
+void generate_vector_uninit(emitter_t* emitter, tac_t* tac) {
     size_t size = data_type_size(tac->res->data_type);
-    
-    fprintf(stream,
-            "\t.globl %s\n"
-            "\t.comm %s %ld\n",
-            tac->res->value, 
-            tac->res->value, 
-            atoi(tac->op1->value)*size);
+    emit_global(emitter, tac->res->value);
+    emit_common_unaligned(emitter, tac->res->value, atoi(tac->op1->value)*size);
 }
 
 
-void generate_vector_init(FILE* stream, tac_t* tac) {
-    fprintf(stream, 
-            "\t.globl %s\n"
-            "%s:\n",
-            tac->res->value, tac->res->value);
+void generate_vector_init(emitter_t* emitter, tac_t* tac) {
+    emit_global(emitter, tac->res->value);
+    emit_label(emitter, tac->res->value);
 }
 
 
-void generate_vector_init_value(FILE* stream, tac_t* tac) {
+void generate_vector_init_value(emitter_t* emitter, tac_t* tac) {
     switch(tac->res->data_type) {
         case data_type_int:
-            fprintf(stream, 
-                    "\t.long %s\n",
-                    tac->op1->value);
+            emit_data_text(emitter, x86_data_long, tac->op1->value);
             break;
         case data_type_char:
-            fprintf(stream, 
-                    "\t.byte %d\n",
-                    tac->op1->value[1]);
+            emit_data_integer(emitter, x86_data_byte, tac->op1->value[1]);
             break;
         default:
             break;
@@ -301,83 +470,70 @@ void generate_vector_init_value(FILE* stream, tac_t* tac) {
 }
 
 
-void generate_begin_function(FILE* stream, tac_t* tac) {
-    fprintf(stream, 
-            "\t.text\n"
-            "\t.globl %s\n"
-            "%s:\n"
-            "\t.cfi_startproc\n"
-            "\tpushq\t%%rbp\n"
-            "\t.cfi_def_cfa_offset\t16\n"
-	        "\t.cfi_offset\t6, -16\n"
-            "\tmovq\t%%rsp, %%rbp\n"
-            "\t.cfi_def_cfa_register\t6\n",
-            tac->res->value, tac->res->value);
+void generate_begin_function(emitter_t* emitter, tac_t* tac) {
+    emit_section(emitter, x86_section_text);
+    emit_global(emitter, tac->res->value);
+    emit_label(emitter, tac->res->value);
+    emit_cfi_startproc(emitter);
+    emit_instruction1(emitter, x86_pushq, x86_reg(x86_rbp));
+    emit_cfi_def_cfa_offset(emitter, 16);
+    emit_cfi_offset(emitter, 6, -16);
+    emit_instruction2(emitter, x86_movq, x86_reg(x86_rsp), x86_reg(x86_rbp));
+    emit_cfi_def_cfa_register(emitter, 6);
     int stack_parameter_initial_displacement = 16;
     int parameter_size = 8;
     for(int i = list_size(tac->res->parameters) - 1; i >= 0 ; i--) {
-        fprintf(stream,
-                "\tmovl\t%d(%%rbp), %%eax\n"
-                "\tpushq\t%%rax\n",
-                i * parameter_size + stack_parameter_initial_displacement);
+        emit_instruction2(emitter, x86_movl,
+                          x86_mem(x86_rbp, i * parameter_size + stack_parameter_initial_displacement),
+                          x86_reg(x86_eax));
+        emit_instruction1(emitter, x86_pushq, x86_reg(x86_rax));
     }
 }
 
 
-void generate_end_function(FILE* stream, tac_t* tac) {
-    fprintf(stream,
-            ".%s_end:\n"
-            "\tmovq\t%%rbp, %%rsp\n"
-            "\tpopq\t%%rbp\n"
-            "\t.cfi_def_cfa\t7, 8\n"
-            "\tret\n"
-            "\t.cfi_endproc\n",
-            tac->res->value);
+void generate_end_function(emitter_t* emitter, tac_t* tac) {
+    emit_function_end_label(emitter, tac->res->value);
+    emit_instruction2(emitter, x86_movq, x86_reg(x86_rbp), x86_reg(x86_rsp));
+    emit_instruction1(emitter, x86_popq, x86_reg(x86_rbp));
+    emit_cfi_def_cfa(emitter, 7, 8);
+    emit_instruction0(emitter, x86_ret);
+    emit_cfi_endproc(emitter);
 }
 
 
-void generate_print(FILE* stream, tac_t* tac) {
+void generate_print(emitter_t* emitter, tac_t* tac) {
     switch(tac->res->data_type) {
         case data_type_bool:
-            convert_byte_to_int(stream, tac->res->value);
-            fprintf(stream,
-                    "\tmovl\t%%eax, %%esi\n"
-                    "\tleaq\t.intfmt(%%rip), %%rdi\n"
-                    "\tmovl\t$0, %%eax\n"
-                    "\tcall\tprintf@PLT\n");
+            convert_byte_to_int(emitter, tac->res->value);
+            emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_reg(x86_esi));
+            emit_instruction2(emitter, x86_leaq, x86_rip(".intfmt"), x86_reg(x86_rdi));
+            emit_instruction2(emitter, x86_movl, x86_imm(0), x86_reg(x86_eax));
+            emit_instruction1(emitter, x86_call, x86_target("printf", x86_target_plt));
             break;
         case data_type_int:
-            fprintf(stream,
-                    "\tmovl\t%s(%%rip), %%eax\n"
-                    "\tmovl\t%%eax, %%esi\n"
-                    "\tleaq\t.intfmt(%%rip), %%rdi\n"
-                    "\tmovl\t$0, %%eax\n"
-                    "\tcall\tprintf@PLT\n",
-                    tac->res->value);
+            emit_instruction2(emitter, x86_movl, x86_rip(tac->res->value), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_reg(x86_esi));
+            emit_instruction2(emitter, x86_leaq, x86_rip(".intfmt"), x86_reg(x86_rdi));
+            emit_instruction2(emitter, x86_movl, x86_imm(0), x86_reg(x86_eax));
+            emit_instruction1(emitter, x86_call, x86_target("printf", x86_target_plt));
             break;
         case data_type_char:
-            fprintf(stream,
-                    "\tmovzbl\t%s(%%rip), %%eax\n"
-                    "\tmovsbl\t%%al, %%eax\n"
-                    "\tmovl\t%%eax, %%edi\n"
-                    "\tcall\tputchar@PLT\n",
-                    tac->res->value);
+            emit_instruction2(emitter, x86_movzbl, x86_rip(tac->res->value), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movsbl, x86_reg(x86_al), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_reg(x86_edi));
+            emit_instruction1(emitter, x86_call, x86_target("putchar", x86_target_plt));
             break;
         case data_type_float:
-            fprintf(stream,
-                    "\tmovss\t%s(%%rip), %%xmm0\n"
-                    "\tcvtss2sd\t%%xmm0, %%xmm0\n"
-                    "\tleaq\t.floatfmt(%%rip), %%rdi\n"
-                    "\tmovl\t$1, %%eax\n"
-                    "\tcall\tprintf@PLT\n",
-                    tac->res->value);
+            emit_instruction2(emitter, x86_movss, x86_rip(tac->res->value), x86_reg(x86_xmm0));
+            emit_instruction2(emitter, x86_cvtss2sd, x86_reg(x86_xmm0), x86_reg(x86_xmm0));
+            emit_instruction2(emitter, x86_leaq, x86_rip(".floatfmt"), x86_reg(x86_rdi));
+            emit_instruction2(emitter, x86_movl, x86_imm(1), x86_reg(x86_eax));
+            emit_instruction1(emitter, x86_call, x86_target("printf", x86_target_plt));
             break;
         case data_type_string:
-            fprintf(stream,
-                    "\tleaq\t%s(%%rip), %%rdi\n"
-                    "\tmovl\t$0, %%eax\n"
-                    "\tcall\tprintf@PLT\n",
-                    tac->res->value);
+            emit_instruction2(emitter, x86_leaq, x86_rip(tac->res->value), x86_reg(x86_rdi));
+            emit_instruction2(emitter, x86_movl, x86_imm(0), x86_reg(x86_eax));
+            emit_instruction1(emitter, x86_call, x86_target("printf", x86_target_plt));
             break;
         default:
             break;
@@ -385,28 +541,22 @@ void generate_print(FILE* stream, tac_t* tac) {
 }
 
 
-void generate_argument(FILE* stream, tac_t* tac) {
+void generate_argument(emitter_t* emitter, tac_t* tac) {
     switch(tac->res->data_type) {
         case data_type_bool:
         case data_type_int:
-            fprintf(stream,
-                    "\tmovl\t%s(%%rip), %%eax\n"
-                    "\tpushq\t%%rax\n",
-                    tac->res->value);
+            emit_instruction2(emitter, x86_movl, x86_rip(tac->res->value), x86_reg(x86_eax));
+            emit_instruction1(emitter, x86_pushq, x86_reg(x86_rax));
             break;
         case data_type_char:
-            fprintf(stream,
-                    "\tmovzbl\t%s(%%rip), %%eax\n"
-                    "\tmovsbl\t%%al, %%eax\n"
-                    "\tpushq\t%%rax\n",
-                    tac->res->value);
+            emit_instruction2(emitter, x86_movzbl, x86_rip(tac->res->value), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movsbl, x86_reg(x86_al), x86_reg(x86_eax));
+            emit_instruction1(emitter, x86_pushq, x86_reg(x86_rax));
             break;
         case data_type_float:
-            fprintf(stream,
-                    "\tmovss\t%s(%%rip), %%xmm0\n"
-                    "\tleaq\t-8(%%rsp), %%rsp\n"
-                    "\tmovss\t%%xmm0, (%%rsp)\n",
-                    tac->res->value);
+            emit_instruction2(emitter, x86_movss, x86_rip(tac->res->value), x86_reg(x86_xmm0));
+            emit_instruction2(emitter, x86_leaq, x86_mem(x86_rsp, -8), x86_reg(x86_rsp));
+            emit_instruction2(emitter, x86_movss, x86_reg(x86_xmm0), x86_mem(x86_rsp, 0));
             break;
         default:
             break;
@@ -414,35 +564,23 @@ void generate_argument(FILE* stream, tac_t* tac) {
 }
 
 
-void generate_call(FILE* stream, tac_t* tac) {
-    fprintf(stream,
-            "\tcall\t%s\n"
-            "\tmovl\t%%eax, %s(%%rip)\n",
-            tac->op1->value,
-            tac->res->value);
+void generate_call(emitter_t* emitter, tac_t* tac) {
+    emit_instruction1(emitter, x86_call, x86_target(tac->op1->value, x86_target_local));
+    emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_rip(tac->res->value));
 }
 
 
-void generate_parameter(FILE* stream, tac_t* tac) {
+void generate_parameter(emitter_t* emitter, tac_t* tac) {
     switch(tac->res->data_type) {
         case data_type_bool:
         case data_type_int:
-            fprintf(stream,
-                    "\tpopq\t%%rax\n"
-                    "\tmovl\t%%eax, %s(%%rip)\n",
-                    tac->res->value);
+        case data_type_float:
+            emit_instruction1(emitter, x86_popq, x86_reg(x86_rax));
+            emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_rip(tac->res->value));
             break;
         case data_type_char:
-            fprintf(stream,
-                    "\tpopq\t%%rax\n"
-                    "\tmovb\t%%al, %s(%%rip)\n",
-                tac->res->value);
-            break;
-        case data_type_float:
-            fprintf(stream,
-                    "\tpopq\t%%rax\n"
-                    "\tmovl\t%%eax, %s(%%rip)\n",
-                    tac->res->value);
+            emit_instruction1(emitter, x86_popq, x86_reg(x86_rax));
+            emit_instruction2(emitter, x86_movb, x86_reg(x86_al), x86_rip(tac->res->value));
             break;
         default:
             break;
@@ -450,273 +588,148 @@ void generate_parameter(FILE* stream, tac_t* tac) {
 }
 
 
-void generate_return(FILE* stream, tac_t* tac) {
-    fprintf(stream,
-            "\tmovl\t%s(%%rip), %%eax\n"
-            "\tjmp\t.%s_end\n",
-            tac->res->value,
-            tac->op1->value);
+void generate_return(emitter_t* emitter, tac_t* tac) {
+    emit_instruction2(emitter, x86_movl, x86_rip(tac->res->value), x86_reg(x86_eax));
+    emit_instruction1(emitter, x86_jmp, x86_target(tac->op1->value, x86_target_function_end));
 }
 
 
-void convert_byte_to_int(FILE* stream, char* variable) {
-    fprintf(stream,
-            "\tmovzbl\t%s(%%rip), %%eax\n"
-            "\tmovsbl\t%%al, %%eax\n",
-            variable);
+void convert_byte_to_int(emitter_t* emitter, char* variable) {
+    emit_instruction2(emitter, x86_movzbl, x86_rip(variable), x86_reg(x86_eax));
+    emit_instruction2(emitter, x86_movsbl, x86_reg(x86_al), x86_reg(x86_eax));
 }
 
 
-void convert_byte_to_float(FILE* stream, char* variable) {
-    convert_byte_to_int(stream, variable);
-    fprintf(stream,
-            "\tcvtsi2ss\t%%eax, %%xmm0\n");
+void convert_byte_to_float(emitter_t* emitter, char* variable) {
+    convert_byte_to_int(emitter, variable);
+    emit_instruction2(emitter, x86_cvtsi2ss, x86_reg(x86_eax), x86_reg(x86_xmm0));
 }
 
 
-void convert_int_to_float(FILE* stream, char* variable) {
-    fprintf(stream,
-            "\tmovl\t%s(%%rip), %%eax\n"
-	        "\tcvtsi2ss\t%%eax, %%xmm0\n",
-            variable);
+void convert_int_to_float(emitter_t* emitter, char* variable) {
+    emit_instruction2(emitter, x86_movl, x86_rip(variable), x86_reg(x86_eax));
+    emit_instruction2(emitter, x86_cvtsi2ss, x86_reg(x86_eax), x86_reg(x86_xmm0));
 }
 
 
-void convert_data_type(FILE* stream, char* variable, data_type_t from, data_type_t to) {
+void convert_data_type(emitter_t* emitter, char* variable, data_type_t from, data_type_t to) {
     if(from == to) {
-        if(from == data_type_char ) {
-            fprintf(stream,
-                "\tmovzbl\t%s(%%rip), %%eax\n",
-                variable);
-        } else if(from == data_type_int ) {
-            fprintf(stream,
-                "\tmovl\t%s(%%rip), %%eax\n",
-                variable);
-    }
+        if(from == data_type_char || from == data_type_bool) {
+            emit_instruction2(emitter, x86_movzbl, x86_rip(variable), x86_reg(x86_eax));
+        } else if(from == data_type_int) {
+            emit_instruction2(emitter, x86_movl, x86_rip(variable), x86_reg(x86_eax));
+        }
     } else if(from == data_type_int && to == data_type_float) {
-        convert_int_to_float(stream, variable);
+        convert_int_to_float(emitter, variable);
     } else if(from == data_type_char) {
         if(to == data_type_int) {
-            convert_byte_to_int(stream, variable);
+            convert_byte_to_int(emitter, variable);
         } else if(to == data_type_float) {
-            convert_byte_to_float(stream, variable);
+            convert_byte_to_float(emitter, variable);
         }
     }
 }
 
 
-char* operator_to_mnemonic(tac_type_t operator, data_type_t data_type) {
-    switch(data_type) {
-        case data_type_char:
-        case data_type_int:
-            switch(operator) {
-                case tac_sum:
-                    return "addl";
-                    break;
-                case tac_sub:
-                    return "subl";
-                    break;
-                case tac_mul:
-                    return "imull";
-                    break;
-                case tac_div:
-                    return "idivl";
-                    break;
-                case tac_eq:
-                    return "sete";
-                    break;
-                case tac_dif:
-                    return "setne";
-                    break;
-                case tac_gt:
-                    return "setg";
-                    break;
-                case tac_ge:
-                    return "setge";
-                    break;
-                case tac_lt:
-                    return "setl";
-                    break;
-                case tac_le:
-                    return "setle";
-                    break;
-                default:
-                    return "";
-                    break;
-            }
-            break;
-        case data_type_float:
-            switch(operator) {
-                case tac_sum:
-                    return "addss";
-                    break;
-                case tac_sub:
-                    return "subss";
-                    break;
-                case tac_mul:
-                    return "mulss";
-                    break;
-                case tac_div:
-                    return "divss";
-                    break;
-                case tac_eq:
-                    return "cmovne";
-                    break;
-                case tac_dif:
-                    return "cmovne";
-                    break;
-                case tac_gt:
-                    return "seta";
-                    break;
-                case tac_ge:
-                    return "setnb";
-                    break;
-                case tac_lt:
-                    return "seta";
-                    break;
-                case tac_le:
-                    return "setnb";
-                    break;
-                default:
-                    return "";
-                    break;
-            }
-            break;
-        default:
-            return "";
-            break;
-    }
+x86_mnemonic_t operator_to_mnemonic(tac_type_t operator, data_type_t data_type) {
+    return operator_mnemonics[operator][data_type == data_type_float];
 }
 
 
-void generate_basic_arithmetic(FILE* stream, tac_t* tac) {
-    convert_data_type(stream, tac->op2->value, tac->op2->data_type, tac->res->data_type);
-    fprintf(stream,
-            "\tmovl\t%%eax, %%edx\n");
-    convert_data_type(stream, tac->op1->value, tac->op1->data_type, tac->res->data_type);
-    fprintf(stream,
-            "\t%s\t%%edx, %%eax\n"
-            "\tmovl\t%%eax, %s(%%rip)\n",
-            operator_to_mnemonic(tac->type, data_type_int),
-            tac->res->value);
+void generate_basic_arithmetic(emitter_t* emitter, tac_t* tac) {
+    convert_data_type(emitter, tac->op2->value, tac->op2->data_type, tac->res->data_type);
+    emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_reg(x86_edx));
+    convert_data_type(emitter, tac->op1->value, tac->op1->data_type, tac->res->data_type);
+    emit_instruction2(emitter, operator_to_mnemonic(tac->type, data_type_int),
+                      x86_reg(x86_edx), x86_reg(x86_eax));
+    emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_rip(tac->res->value));
 }
 
 
-void generate_div(FILE* stream, tac_t* tac) {
-    convert_data_type(stream, tac->op1->value, tac->op1->data_type, tac->res->data_type);
-    convert_data_type(stream, tac->op2->value, tac->op2->data_type, tac->res->data_type);
-    fprintf(stream,
-            "\tmovl\t%s(%%rip), %%eax\n"
-            "\tmovl\t%s(%%rip), %%ecx\n"
-            "\tcltd\n"
-            "\t%s\t%%ecx\n"
-            "\tmovl\t%%eax, %s(%%rip)\n",
-            tac->op1->value,
-            tac->op2->value,
-            operator_to_mnemonic(tac->type, data_type_int),
-            tac->res->value);
+void generate_div(emitter_t* emitter, tac_t* tac) {
+    convert_data_type(emitter, tac->op1->value, tac->op1->data_type, tac->res->data_type);
+    convert_data_type(emitter, tac->op2->value, tac->op2->data_type, tac->res->data_type);
+    emit_instruction2(emitter, x86_movl, x86_rip(tac->op1->value), x86_reg(x86_eax));
+    emit_instruction2(emitter, x86_movl, x86_rip(tac->op2->value), x86_reg(x86_ecx));
+    emit_instruction0(emitter, x86_cltd);
+    emit_instruction1(emitter, operator_to_mnemonic(tac->type, data_type_int), x86_reg(x86_ecx));
+    emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_rip(tac->res->value));
 }
 
 
-void generate_comparison(FILE* stream, tac_t* tac) {
-    convert_data_type(stream, tac->op1->value, tac->op1->data_type, tac->res->data_type);
-    convert_data_type(stream, tac->op2->value, tac->op2->data_type, tac->res->data_type);
-    
-    fprintf(stream,
-        "\tmovl\t%s(%%rip), %%edx\n"
-        "\tmovl\t%s(%%rip), %%eax\n"
-        "\tcmpl\t%%eax, %%edx\n"
-        "\t%s\t%%al\n"
-        "\tmovb\t%%al, %s(%%rip)\n",
-        tac->op1->value,
-        tac->op2->value,
-        operator_to_mnemonic(tac->type, data_type_int),
-        tac->res->value);
+void generate_comparison(emitter_t* emitter, tac_t* tac) {
+    convert_data_type(emitter, tac->op1->value, tac->op1->data_type, tac->res->data_type);
+    convert_data_type(emitter, tac->op2->value, tac->op2->data_type, tac->res->data_type);
+    emit_instruction2(emitter, x86_movl, x86_rip(tac->op1->value), x86_reg(x86_edx));
+    emit_instruction2(emitter, x86_movl, x86_rip(tac->op2->value), x86_reg(x86_eax));
+    emit_instruction2(emitter, x86_cmpl, x86_reg(x86_eax), x86_reg(x86_edx));
+    emit_instruction1(emitter, operator_to_mnemonic(tac->type, data_type_int), x86_reg(x86_al));
+    emit_instruction2(emitter, x86_movb, x86_reg(x86_al), x86_rip(tac->res->value));
 }
 
 
-void generate_move(FILE* stream, tac_t* tac) {
-    convert_data_type(stream, tac->op1->value, tac->op1->data_type, tac->res->data_type);
+void generate_move(emitter_t* emitter, tac_t* tac) {
+    convert_data_type(emitter, tac->op1->value, tac->op1->data_type, tac->res->data_type);
     switch(tac->res->data_type) {
         case data_type_int:
-                fprintf(stream,
-                        "\tmovl\t%%eax, %s(%%rip)\n",
-                        tac->res->value);
-                break;
+            emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_rip(tac->res->value));
+            break;
+        // Comparisons folded by the optimizer move constants into bools
+        case data_type_bool:
         case data_type_char:
-                fprintf(stream,
-	                    "\tmovb\t%%al, %s(%%rip)\n",
-                        tac->res->value);
+            emit_instruction2(emitter, x86_movb, x86_reg(x86_al), x86_rip(tac->res->value));
             break;
         case data_type_float:
-            
+
             break;
         default:
             break;
     }
-    
 }
 
 
-void generate_label(FILE* stream, tac_t* tac) {
-    fprintf(stream,
-            "%s:\n",
-            tac->res->value);
+void generate_label(emitter_t* emitter, tac_t* tac) {
+    emit_label(emitter, tac->res->value);
 }
 
 
-void generate_jump_false(FILE* stream, tac_t* tac) {
-    fprintf(stream,
-            "\tmovzbl\t%s(%%rip), %%eax\n"
-            "\ttestb\t%%al, %%al\n"
-            "\tje\t%s\n",
-            tac->op1->value,
-            tac->res->value);
+void generate_jump_false(emitter_t* emitter, tac_t* tac) {
+    emit_instruction2(emitter, x86_movzbl, x86_rip(tac->op1->value), x86_reg(x86_eax));
+    emit_instruction2(emitter, x86_testb, x86_reg(x86_al), x86_reg(x86_al));
+    emit_instruction1(emitter, x86_je, x86_target(tac->res->value, x86_target_local));
 }
 
 
-void generate_jump(FILE* stream, tac_t* tac) {
-    fprintf(stream,
-            "\tjmp\t%s\n",
-            tac->res->value);
+void generate_jump(emitter_t* emitter, tac_t* tac) {
+    emit_instruction1(emitter, x86_jmp, x86_target(tac->res->value, x86_target_local));
 }
 
 
-void generate_read(FILE* stream, tac_t* tac) {
-    fprintf(stream,
-	        "\tcall\tgetchar@PLT\n"
-	        "\tmovb\t%%al, %s(%%rip)\n",
-            tac->res->value);
+void generate_read(emitter_t* emitter, tac_t* tac) {
+    emit_instruction1(emitter, x86_call, x86_target("getchar", x86_target_plt));
+    emit_instruction2(emitter, x86_movb, x86_reg(x86_al), x86_rip(tac->res->value));
 }
 
 
-void generate_vector_index(FILE* stream, tac_t* tac) {
+void generate_vector_index(emitter_t* emitter, tac_t* tac) {
     switch(tac->res->data_type) {
         case data_type_int:
-                fprintf(stream,
-                        "\tmovl\t%s(%%rip), %%eax\n"
-                        "\tcltq\n"
-                        "\tleaq\t0(,%%rax,4), %%rdx\n"
-                        "\tleaq\t%s(%%rip), %%rax\n"
-                        "\tmovl\t(%%rdx,%%rax), %%eax\n"
-                        "\tmovl\t%%eax, %s(%%rip)\n",
-                        tac->op2->value,
-                        tac->op1->value,
-                        tac->res->value);
-                break;
+            emit_instruction2(emitter, x86_movl, x86_rip(tac->op2->value), x86_reg(x86_eax));
+            emit_instruction0(emitter, x86_cltq);
+            emit_instruction2(emitter, x86_leaq, x86_mem_index(x86_no_register, x86_rax, 4, 0), x86_reg(x86_rdx));
+            emit_instruction2(emitter, x86_leaq, x86_rip(tac->op1->value), x86_reg(x86_rax));
+            emit_instruction2(emitter, x86_movl, x86_mem_index(x86_rdx, x86_rax, 1, 0), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movl, x86_reg(x86_eax), x86_rip(tac->res->value));
+            break;
         case data_type_char:
-                fprintf(stream,
-	                    "\tmovl\t%s(%%rip), %%eax\n"
-                        "\tmovslq\t%%eax, %%rdx\n"
-                        "\tleaq\t%s(%%rip), %%rax\n"
-                        "\tmovzbl\t(%%rdx,%%rax), %%eax\n"
-                        "\tmovb\t%%al, %s(%%rip)\n",
-                        tac->op2->value,
-                        tac->op1->value,
-                        tac->res->value);
+            emit_instruction2(emitter, x86_movl, x86_rip(tac->op2->value), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movslq, x86_reg(x86_eax), x86_reg(x86_rdx));
+            emit_instruction2(emitter, x86_leaq, x86_rip(tac->op1->value), x86_reg(x86_rax));
+            emit_instruction2(emitter, x86_movzbl, x86_mem_index(x86_rdx, x86_rax, 1, 0), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movb, x86_reg(x86_al), x86_rip(tac->res->value));
             break;
         case data_type_float:
-            
+
             break;
         default:
             break;
@@ -724,35 +737,27 @@ void generate_vector_index(FILE* stream, tac_t* tac) {
 }
 
 
-void generate_vector_move(FILE* stream, tac_t* tac) {
+void generate_vector_move(emitter_t* emitter, tac_t* tac) {
     switch(tac->res->data_type) {
         case data_type_int:
-                fprintf(stream,
-                        "\tmovl\t%s(%%rip), %%eax\n"
-                        "\tmovl\t%s(%%rip), %%edx\n"
-                        "\tcltq\n"
-                        "\tleaq\t0(,%%rax,4), %%rcx\n"
-                        "\tleaq\t%s(%%rip), %%rax\n"
-                        "\tmovl\t%%edx, (%%rcx,%%rax)\n",
-                        tac->op1->value,
-                        tac->op2->value,
-                        tac->res->value);
-                break;
+            emit_instruction2(emitter, x86_movl, x86_rip(tac->op1->value), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movl, x86_rip(tac->op2->value), x86_reg(x86_edx));
+            emit_instruction0(emitter, x86_cltq);
+            emit_instruction2(emitter, x86_leaq, x86_mem_index(x86_no_register, x86_rax, 4, 0), x86_reg(x86_rcx));
+            emit_instruction2(emitter, x86_leaq, x86_rip(tac->res->value), x86_reg(x86_rax));
+            emit_instruction2(emitter, x86_movl, x86_reg(x86_edx), x86_mem_index(x86_rcx, x86_rax, 1, 0));
+            break;
         case data_type_char:
-                fprintf(stream,
-                        "\tmovl\t%s(%%rip), %%eax\n"
-                        "\tmovzbl\t%s(%%rip), %%ecx\n"
-                        "\tmovslq\t%%eax, %%rdx\n"
-                        "\tleaq\t%s(%%rip), %%rax\n"
-                        "\tmovb\t%%cl, (%%rdx,%%rax)\n",
-                        tac->op1->value,
-                        tac->op2->value,
-                        tac->res->value);
+            emit_instruction2(emitter, x86_movl, x86_rip(tac->op1->value), x86_reg(x86_eax));
+            emit_instruction2(emitter, x86_movzbl, x86_rip(tac->op2->value), x86_reg(x86_ecx));
+            emit_instruction2(emitter, x86_movslq, x86_reg(x86_eax), x86_reg(x86_rdx));
+            emit_instruction2(emitter, x86_leaq, x86_rip(tac->res->value), x86_reg(x86_rax));
+            emit_instruction2(emitter, x86_movb, x86_reg(x86_cl), x86_mem_index(x86_rdx, x86_rax, 1, 0));
             break;
         case data_type_float:
-            
+
             break;
         default:
             break;
     }
-}
\ No newline at end of file
+}
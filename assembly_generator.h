@@ -1,9 +1,29 @@
 #ifndef ASSEMBLY_GENERATOR_H
 #define ASSEMBLY_GENERATOR_H
 
+#include <stdbool.h>
 #include <stdio.h>
 #include "list.h"
+#include "compilation_context.h"
+#include "encoder.h"
+#include "function_cache.h"
 
-void generate_assembly(FILE* stream, list_t* tacs);
+/*
+ * With more than one thread, every function and every run of global data
+ * between functions is generated as a separate unit on a thread pool, and
+ * the units are written in source order. Emission times of the units are
+ * printed to times_log unless it is NULL. Functions found in the cache, if
+ * there is one, are copied from it instead of being generated, and the
+ * others are stored in it. Returns false if writing to the stream failed.
+ */
+bool generate_assembly(compilation_context_t* context, FILE* stream, list_t* tacs,
+                       size_t threads, FILE* times_log, const function_cache_t* cache);
+
+// Writes an ELF relocatable object instead of assembly text. Returns false
+// if writing to the stream failed.
+bool generate_object(compilation_context_t* context, FILE* stream, list_t* tacs);
+
+// Finished encoder holding the program's machine code, to be deleted by the caller
+encoder_t* generate_machine_code(compilation_context_t* context, list_t* tacs);
 
 #endif
\ No newline at end of file
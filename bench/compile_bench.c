@@ -0,0 +1,196 @@
+/*
+ * Times the compiler on programs of increasing size, given smallest first.
+ * Each program is compiled several times and the fastest run is kept. The
+ * token count comes from the compiler's --time-passes=json report and the
+ * peak memory from the resource usage of the compiler process.
+ */
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct compile_measure {
+    size_t lines;
+    size_t tokens;
+    double milliseconds;
+    // Kilobytes
+    long peak_memory;
+} compile_measure_t;
+
+int measure_compilation(const char* compiler, const char* program, size_t repeat, compile_measure_t* measure);
+
+int run_compiler_once(const char* compiler, const char* program, double* milliseconds,
+                      long* peak_memory, size_t* tokens);
+
+size_t count_lines(const char* path);
+
+void print_bench_help(const char* program_name);
+
+
+int main(int argc, char** argv) {
+    size_t repeat = 3;
+    // Time per token may grow this much between sizes before it is flagged
+    double threshold = 1.25;
+
+    static struct option long_options[] = {
+        {"repeat", required_argument, NULL, 'n'},
+        {"threshold", required_argument, NULL, 't'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}
+    };
+    int c;
+    while((c = getopt_long(argc, argv, "n:t:h", long_options, NULL)) != -1) {
+        switch(c) {
+            case 'n': repeat = strtoul(optarg, NULL, 10); break;
+            case 't': threshold = strtod(optarg, NULL); break;
+            case 'h':
+                print_bench_help(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                print_bench_help(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(argc - optind < 2 || repeat == 0) {
+        print_bench_help(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char* compiler = argv[optind];
+    printf("%-32s %9s %9s %10s %12s %12s %10s %8s\n", "Program", "Lines", "Tokens",
+           "Time (ms)", "Lines/s", "Tokens/s", "Peak (KB)", "Growth");
+    compile_measure_t previous = { 0, 0, 0, 0 };
+    bool has_previous = false;
+    int failures = 0;
+    size_t super_linear = 0;
+    for(int i = optind + 1; i < argc; i++) {
+        compile_measure_t measure;
+        if(measure_compilation(compiler, argv[i], repeat, &measure) != 0) {
+            fprintf(stderr, "%s: could not compile %s\n", argv[0], argv[i]);
+            failures++;
+            continue;
+        }
+        double seconds = measure.milliseconds / 1e3;
+        printf("%-32s %9zu %9zu %10.3f %12.0f %12.0f %10ld", argv[i], measure.lines, measure.tokens,
+               measure.milliseconds, measure.lines / seconds, measure.tokens / seconds, measure.peak_memory);
+        // Growth is the time per token relative to the previous size, about
+        // 1 when compilation time is linear in the size of the program
+        if(has_previous && previous.tokens > 0 && measure.tokens > 0) {
+            double growth = (measure.milliseconds / previous.milliseconds)
+                          / ((double)measure.tokens / previous.tokens);
+            printf(" %8.2f%s", growth, growth > threshold ? "  super-linear" : "");
+            if(growth > threshold) {
+                super_linear++;
+            }
+        }
+        printf("\n");
+        previous = measure;
+        has_previous = true;
+    }
+    if(super_linear > 0) {
+        printf("%zu size steps grew super-linearly (threshold %.2f)\n", super_linear, threshold);
+    }
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+int measure_compilation(const char* compiler, const char* program, size_t repeat, compile_measure_t* measure) {
+    measure->lines = count_lines(program);
+    measure->tokens = 0;
+    measure->milliseconds = 0;
+    measure->peak_memory = 0;
+    for(size_t i = 0; i < repeat; i++) {
+        double milliseconds;
+        long peak_memory;
+        if(run_compiler_once(compiler, program, &milliseconds, &peak_memory, &measure->tokens) != 0) {
+            return -1;
+        }
+        if(i == 0 || milliseconds < measure->milliseconds) {
+            measure->milliseconds = milliseconds;
+        }
+        if(peak_memory > measure->peak_memory) {
+            measure->peak_memory = peak_memory;
+        }
+    }
+    return 0;
+}
+
+
+// The compiler writes its output to /dev/null and its log to a temporary
+// file, which is searched for the token count
+int run_compiler_once(const char* compiler, const char* program, double* milliseconds,
+                      long* peak_memory, size_t* tokens) {
+    FILE* log = tmpfile();
+    if(log == NULL) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t child = fork();
+    if(child == -1) {
+        fclose(log);
+        return -1;
+    }
+    if(child == 0) {
+        dup2(fileno(log), STDERR_FILENO);
+        execl(compiler, compiler, "--time-passes=json", program, "/dev/null", (char*)NULL);
+        _exit(127);
+    }
+
+    int status;
+    struct rusage usage;
+    wait4(child, &status, 0, &usage);
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *milliseconds = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    *peak_memory = usage.ru_maxrss;
+
+    rewind(log);
+    char* line = NULL;
+    size_t line_capacity = 0;
+    while(getline(&line, &line_capacity, log) != -1) {
+        const char* tokens_field = strstr(line, "\"tokens\":");
+        if(tokens_field != NULL) {
+            *tokens = strtoul(tokens_field + strlen("\"tokens\":"), NULL, 10);
+        }
+    }
+    free(line);
+    fclose(log);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+
+size_t count_lines(const char* path) {
+    FILE* file = fopen(path, "r");
+    if(file == NULL) {
+        return 0;
+    }
+    size_t lines = 0;
+    int c;
+    while((c = fgetc(file)) != EOF) {
+        if(c == '\n') {
+            lines++;
+        }
+    }
+    fclose(file);
+    return lines;
+}
+
+
+void print_bench_help(const char* program_name) {
+    fprintf(stderr, "Usage: %s [OPTION...] compiler program [program...]\n"
+            "    Programs are given from the smallest to the largest.\n"
+            "\n"
+            "    -n, --repeat=N       Compile each program N times and keep the\n"
+            "                         fastest run (default: 3)\n"
+            "    -t, --threshold=R    Flag sizes whose time per token grew more\n"
+            "                         than R times over the previous size\n"
+            "                         (default: 1.25)\n"
+            "    -h, --help           Give this help list\n",
+            program_name);
+}
@@ -0,0 +1,322 @@
+/*
+ * Writes a valid program of configurable size to stdout, for benchmarking
+ * the compiler. Only the first eighth of the functions are called, and
+ * they call nothing; loops have small constant bounds and gotos only jump
+ * forward, so the programs also terminate quickly when run.
+ */
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Identifiers can't hold digits, numbers are written with letters
+#define NAME_LENGTH 16
+
+typedef struct generator_options {
+    size_t globals;
+    size_t vectors;
+    size_t vector_size;
+    size_t functions;
+    size_t statements;
+    size_t expression_depth;
+    size_t nesting;
+    // Percentage of statements that are a forward goto
+    size_t goto_density;
+    uint64_t seed;
+} generator_options_t;
+
+typedef struct generator {
+    generator_options_t options;
+    uint64_t state;
+    // Functions that make no calls, the others may call them
+    size_t leaf_functions;
+    // Function being written and its labels
+    size_t function;
+    size_t labels;
+} generator_t;
+
+void generate_program(generator_t* generator);
+
+void generate_function(generator_t* generator, size_t function);
+
+void generate_statements(generator_t* generator, size_t count, size_t depth, int indentation);
+
+void generate_statement(generator_t* generator, size_t depth, int indentation);
+
+void generate_expression(generator_t* generator, size_t depth);
+
+void generate_operand(generator_t* generator, size_t depth);
+
+void generate_condition(generator_t* generator);
+
+const char* letters(size_t number, char* name);
+
+size_t random_below(generator_t* generator, size_t bound);
+
+void print_generator_help(const char* program_name);
+
+
+int main(int argc, char** argv) {
+    generator_t generator;
+    generator.options.globals = 200;
+    generator.options.vectors = 20;
+    generator.options.vector_size = 16;
+    generator.options.functions = 40;
+    generator.options.statements = 12;
+    generator.options.expression_depth = 3;
+    generator.options.nesting = 2;
+    generator.options.goto_density = 5;
+    generator.options.seed = 1;
+    size_t scale = 1;
+
+    static struct option long_options[] = {
+        {"scale", required_argument, NULL, 'S'},
+        {"globals", required_argument, NULL, 'g'},
+        {"vectors", required_argument, NULL, 'v'},
+        {"functions", required_argument, NULL, 'f'},
+        {"statements", required_argument, NULL, 's'},
+        {"depth", required_argument, NULL, 'd'},
+        {"nesting", required_argument, NULL, 'n'},
+        {"gotos", required_argument, NULL, 'G'},
+        {"seed", required_argument, NULL, 'r'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}
+    };
+    int c;
+    while((c = getopt_long(argc, argv, "S:g:v:f:s:d:n:G:r:h", long_options, NULL)) != -1) {
+        switch(c) {
+            case 'S': scale = strtoul(optarg, NULL, 10); break;
+            case 'g': generator.options.globals = strtoul(optarg, NULL, 10); break;
+            case 'v': generator.options.vectors = strtoul(optarg, NULL, 10); break;
+            case 'f': generator.options.functions = strtoul(optarg, NULL, 10); break;
+            case 's': generator.options.statements = strtoul(optarg, NULL, 10); break;
+            case 'd': generator.options.expression_depth = strtoul(optarg, NULL, 10); break;
+            case 'n': generator.options.nesting = strtoul(optarg, NULL, 10); break;
+            case 'G': generator.options.goto_density = strtoul(optarg, NULL, 10); break;
+            case 'r': generator.options.seed = strtoull(optarg, NULL, 10); break;
+            case 'h':
+                print_generator_help(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                print_generator_help(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    // The scale multiplies the number of declarations, not their shape
+    generator.options.globals *= scale;
+    generator.options.vectors *= scale;
+    generator.options.functions *= scale;
+    if(generator.options.globals == 0) {
+        generator.options.globals = 1;
+    }
+    generator.leaf_functions = (generator.options.functions + 7) / 8;
+    generator.state = generator.options.seed * 0x9E3779B97F4A7C15ULL + 1;
+    generate_program(&generator);
+    return EXIT_SUCCESS;
+}
+
+
+void generate_program(generator_t* generator) {
+    const generator_options_t* options = &generator->options;
+    char name[NAME_LENGTH];
+    char other_name[NAME_LENGTH];
+    for(size_t i = 0; i < options->globals; i++) {
+        printf("int g_%s: %zu;\n", letters(i, name), random_below(generator, 100));
+    }
+    for(size_t i = 0; i < options->vectors; i++) {
+        printf("int v_%s[%zu]:", letters(i, name), options->vector_size);
+        for(size_t j = 0; j < options->vector_size; j++) {
+            printf(" %zu", random_below(generator, 100));
+        }
+        printf(";\n");
+    }
+    // Loop counters, one per function and nesting level so that calls made
+    // inside a loop can't reset the caller's counter
+    for(size_t i = 0; i < options->functions; i++) {
+        for(size_t depth = 0; depth < options->nesting; depth++) {
+            printf("int i_%s_%s: 0;\n", letters(i, name), letters(depth, other_name));
+        }
+    }
+    for(size_t i = 0; i < options->functions; i++) {
+        generate_function(generator, i);
+    }
+
+    printf("int main() {\n");
+    for(size_t i = 0; i < options->functions; i++) {
+        printf("    print f_%s(%zu, %zu), \"\\n\";\n", letters(i, name),
+               random_below(generator, 10), random_below(generator, 10));
+    }
+    printf("    return 0;\n}\n");
+}
+
+
+void generate_function(generator_t* generator, size_t function) {
+    char name[NAME_LENGTH];
+    generator->function = function;
+    generator->labels = 0;
+    printf("int f_%s(int p_a, int p_b) {\n", letters(function, name));
+    generate_statements(generator, generator->options.statements, 0, 1);
+    printf("    return ");
+    generate_expression(generator, generator->options.expression_depth);
+    printf(";\n}\n");
+}
+
+
+void generate_statements(generator_t* generator, size_t count, size_t depth, int indentation) {
+    for(size_t i = 0; i < count; i++) {
+        generate_statement(generator, depth, indentation);
+    }
+}
+
+
+void generate_statement(generator_t* generator, size_t depth, int indentation) {
+    const generator_options_t* options = &generator->options;
+    char name[NAME_LENGTH];
+    char other_name[NAME_LENGTH];
+    size_t choice = random_below(generator, 100);
+
+    if(choice < options->goto_density) {
+        // The label is placed right after the skipped statement
+        letters(generator->labels++, name);
+        letters(generator->function, other_name);
+        printf("%*sgoto l_%s_%s;\n", 4 * indentation, "", other_name, name);
+        generate_statement(generator, options->nesting, indentation);
+        printf("%*sl_%s_%s:\n", 4 * indentation, "", other_name, name);
+        return;
+    }
+
+    // Nested statements get rarer the deeper they are
+    size_t nesting_chance = depth < options->nesting ? 30 / (depth + 1) : 0;
+    printf("%*s", 4 * indentation, "");
+    if(choice < options->goto_density + nesting_chance / 2) {
+        printf("if ");
+        generate_condition(generator);
+        printf(" then {\n");
+        generate_statements(generator, 1 + random_below(generator, 3), depth + 1, indentation + 1);
+        printf("%*s} else {\n", 4 * indentation, "");
+        generate_statements(generator, 1 + random_below(generator, 3), depth + 1, indentation + 1);
+        printf("%*s};\n", 4 * indentation, "");
+    } else if(choice < options->goto_density + nesting_chance) {
+        letters(generator->function, name);
+        letters(depth, other_name);
+        printf("i_%s_%s = 0;\n", name, other_name);
+        printf("%*swhile i_%s_%s < %zu {\n", 4 * indentation, "", name, other_name,
+               1 + random_below(generator, 4));
+        generate_statements(generator, 1 + random_below(generator, 3), depth + 1, indentation + 1);
+        printf("%*si_%s_%s = i_%s_%s + 1;\n", 4 * (indentation + 1), "", name, other_name, name, other_name);
+        printf("%*s};\n", 4 * indentation, "");
+    } else if(choice < 80 && options->vectors > 0 && choice % 4 == 0) {
+        printf("v_%s[%zu] = ", letters(random_below(generator, options->vectors), name),
+               random_below(generator, options->vector_size));
+        generate_expression(generator, options->expression_depth);
+        printf(";\n");
+    } else if(choice < 95) {
+        printf("g_%s = ", letters(random_below(generator, options->globals), name));
+        generate_expression(generator, options->expression_depth);
+        printf(";\n");
+    } else {
+        printf("print \"value \", ");
+        generate_expression(generator, options->expression_depth);
+        printf(", \"\\n\";\n");
+    }
+}
+
+
+void generate_expression(generator_t* generator, size_t depth) {
+    static const char* operators[] = { "+", "-", "*", "+", "-" };
+    if(depth == 0 || random_below(generator, 4) == 0) {
+        generate_operand(generator, depth);
+        return;
+    }
+    if(random_below(generator, 8) == 0) {
+        // Divisors are literals so that nothing divides by zero
+        printf("(");
+        generate_expression(generator, depth - 1);
+        printf(" / %zu)", 1 + random_below(generator, 9));
+        return;
+    }
+    printf("(");
+    generate_expression(generator, depth - 1);
+    printf(" %s ", operators[random_below(generator, sizeof(operators) / sizeof(operators[0]))]);
+    generate_expression(generator, depth - 1);
+    printf(")");
+}
+
+
+void generate_operand(generator_t* generator, size_t depth) {
+    const generator_options_t* options = &generator->options;
+    char name[NAME_LENGTH];
+    size_t choice = random_below(generator, 10);
+    if(choice < 3) {
+        printf("%zu", random_below(generator, 1000));
+    } else if(choice < 5) {
+        printf("p_%c", random_below(generator, 2) == 0 ? 'a' : 'b');
+    } else if(choice < 7 || (options->vectors == 0 && choice < 9)) {
+        printf("g_%s", letters(random_below(generator, options->globals), name));
+    } else if(choice < 9) {
+        printf("v_%s[%zu]", letters(random_below(generator, options->vectors), name),
+               random_below(generator, options->vector_size));
+    } else if(generator->function >= generator->leaf_functions && depth > 0) {
+        printf("f_%s(", letters(random_below(generator, generator->leaf_functions), name));
+        generate_expression(generator, depth - 1);
+        printf(", ");
+        generate_expression(generator, depth - 1);
+        printf(")");
+    } else {
+        printf("%zu", random_below(generator, 1000));
+    }
+}
+
+
+void generate_condition(generator_t* generator) {
+    static const char* comparisons[] = { "<", ">", "<=", ">=", "==", "!=" };
+    size_t depth = generator->options.expression_depth > 1 ? generator->options.expression_depth - 1 : 1;
+    generate_expression(generator, depth);
+    printf(" %s ", comparisons[random_below(generator, sizeof(comparisons) / sizeof(comparisons[0]))]);
+    generate_expression(generator, depth);
+}
+
+
+// Bijective base 26: a, b, ..., z, aa, ab, ...
+const char* letters(size_t number, char* name) {
+    char reversed[NAME_LENGTH];
+    size_t length = 0;
+    do {
+        reversed[length++] = 'a' + number % 26;
+        number = number / 26;
+    } while(number-- > 0 && length < sizeof(reversed) - 1);
+    for(size_t i = 0; i < length; i++) {
+        name[i] = reversed[length - i - 1];
+    }
+    name[length] = '\0';
+    return name;
+}
+
+
+// xorshift64*, deterministic for a seed on every platform
+size_t random_below(generator_t* generator, size_t bound) {
+    generator->state ^= generator->state >> 12;
+    generator->state ^= generator->state << 25;
+    generator->state ^= generator->state >> 27;
+    return (size_t)((generator->state * 0x2545F4914F6CDD1DULL) >> 32) % bound;
+}
+
+
+void print_generator_help(const char* program_name) {
+    fprintf(stderr, "Usage: %s [OPTION...] > program.txt\n"
+            "    -S, --scale=N       Multiply the globals, vectors and functions\n"
+            "                        by N (default: 1)\n"
+            "    -g, --globals=N     Global variables (default: 200)\n"
+            "    -v, --vectors=N     Global vectors (default: 20)\n"
+            "    -f, --functions=N   Functions besides main (default: 40)\n"
+            "    -s, --statements=N  Statements at the top of each function\n"
+            "                        (default: 12)\n"
+            "    -d, --depth=N       Depth of expressions (default: 3)\n"
+            "    -n, --nesting=N     Nesting of if and while (default: 2)\n"
+            "    -G, --gotos=PERCENT Statements that are forward gotos\n"
+            "                        (default: 5)\n"
+            "    -r, --seed=N        Seed of the generated program (default: 1)\n"
+            "    -h, --help          Give this help list\n",
+            program_name);
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+
+int buffer[4096];
+int size = 4096;
+int low = 1;
+int high = 0;
+int i = 0;
+int round_ = 0;
+int combined = 0;
+
+int main() {
+    i = 0;
+    while(i < size) {
+        buffer[i] = (i * 31 + 7) - ((i * 31 + 7) / 256) * 256;
+        i = i + 1;
+    }
+    round_ = 0;
+    while(round_ < 200) {
+        low = 1;
+        high = 0;
+        i = 0;
+        while(i < size) {
+            low = low + buffer[i];
+            low = low - (low / 65521) * 65521;
+            high = high + low;
+            high = high - (high / 65521) * 65521;
+            i = i + 1;
+        }
+        buffer[round_] = low - (low / 256) * 256;
+        combined = combined + high - (combined / 65536) * 65536;
+        round_ = round_ + 1;
+    }
+    printf("%d %d %d\n", low, high, combined);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include <stdio.h>
+
+int stack[64];
+int top = 0;
+int current = 0;
+int naive = 0;
+int total = 0;
+int round_ = 0;
+
+int fib(int n, int a, int b) {
+    if(n == 0) return a;
+    return fib(n - 1, b, a + b);
+}
+
+int main() {
+    stack[0] = 27;
+    top = 1;
+    while(top > 0) {
+        top = top - 1;
+        current = stack[top];
+        if(current < 2) {
+            naive = naive + current;
+        } else {
+            stack[top] = current - 1;
+            stack[top + 1] = current - 2;
+            top = top + 2;
+        }
+    }
+    printf("%d\n", naive);
+    round_ = 0;
+    while(round_ < 20000) {
+        total = total + fib(40, 0, 1) / 1000;
+        round_ = round_ + 1;
+    }
+    printf("%d\n", total);
+    return 0;
+}
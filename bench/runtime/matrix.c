@@ -0,0 +1,52 @@
+#include <stdio.h>
+
+int a[6400];
+int b[6400];
+int c[6400];
+int n = 80;
+int i = 0;
+int j = 0;
+int k = 0;
+int sum = 0;
+int round_ = 0;
+int checksum = 0;
+
+int main() {
+    i = 0;
+    while(i < n) {
+        j = 0;
+        while(j < n) {
+            a[i * n + j] = (i + j) - ((i + j) / 7) * 7;
+            b[i * n + j] = (i * j) - ((i * j) / 5) * 5 - 2;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    round_ = 0;
+    while(round_ < 10) {
+        i = 0;
+        while(i < n) {
+            j = 0;
+            while(j < n) {
+                sum = 0;
+                k = 0;
+                while(k < n) {
+                    sum = sum + a[i * n + k] * b[k * n + j];
+                    k = k + 1;
+                }
+                c[i * n + j] = sum + round_;
+                j = j + 1;
+            }
+            i = i + 1;
+        }
+        round_ = round_ + 1;
+    }
+    checksum = 0;
+    i = 0;
+    while(i < n * n) {
+        checksum = checksum + c[i] * (i - (i / 13) * 13);
+        i = i + 1;
+    }
+    printf("%d\n", checksum);
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include <stdio.h>
+
+int flags[100001];
+int count = 0;
+int i = 0;
+int j = 0;
+int round_ = 0;
+
+int main() {
+    round_ = 0;
+    while(round_ < 20) {
+        i = 2;
+        while(i <= 100000) {
+            flags[i] = 1;
+            i = i + 1;
+        }
+        count = 0;
+        i = 2;
+        while(i <= 100000) {
+            if(flags[i] == 1) {
+                count = count + 1;
+                j = i + i;
+                while(j <= 100000) {
+                    flags[j] = 0;
+                    j = j + i;
+                }
+            }
+            i = i + 1;
+        }
+        round_ = round_ + 1;
+    }
+    printf("%d\n", count);
+    return 0;
+}
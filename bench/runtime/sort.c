@@ -0,0 +1,90 @@
+#include <stdio.h>
+
+int data[3000];
+int values[3000];
+int n = 3000;
+int seed = 1;
+int i = 0;
+int j = 0;
+int key = 0;
+int swap = 0;
+int sorted = 0;
+int placing = 0;
+int ignored = 0;
+int checksum = 0;
+
+int fill() {
+    i = 0;
+    while(i < n) {
+        seed = seed * 75 + 74;
+        seed = seed - (seed / 65537) * 65537;
+        values[i] = seed;
+        i = i + 1;
+    }
+    return 0;
+}
+
+int check() {
+    sorted = 1;
+    checksum = 0;
+    i = 0;
+    while(i < n) {
+        if(i > 0) {
+            if(data[i - 1] > data[i]) sorted = 0;
+        }
+        checksum = checksum + data[i] / (1 + i - (i / 100) * 100);
+        i = i + 1;
+    }
+    printf("%d %d %d %d\n", sorted, checksum, data[0], data[n - 1]);
+    return 0;
+}
+
+int main() {
+    ignored = fill();
+    i = 0;
+    while(i < n) {
+        data[i] = values[i];
+        i = i + 1;
+    }
+    i = 0;
+    while(i < n - 1) {
+        j = 0;
+        while(j < n - 1 - i) {
+            if(data[j] > data[j + 1]) {
+                swap = data[j];
+                data[j] = data[j + 1];
+                data[j + 1] = swap;
+            }
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    ignored = check();
+    i = 0;
+    while(i < n) {
+        data[i] = values[i];
+        i = i + 1;
+    }
+    i = 1;
+    while(i < n) {
+        key = data[i];
+        j = i - 1;
+        placing = 1;
+        while(placing == 1) {
+            if(j < 0) {
+                placing = 0;
+            } else {
+                if(data[j] > key) {
+                    data[j + 1] = data[j];
+                    j = j - 1;
+                } else {
+                    placing = 0;
+                }
+            }
+        }
+        data[j + 1] = key;
+        i = i + 1;
+    }
+    ignored = check();
+    return 0;
+}
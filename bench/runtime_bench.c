@@ -0,0 +1,310 @@
+/*
+ * Measures how fast compiled programs run. Each program.txt is compiled
+ * with the compiler under test and its program.c counterpart with the C
+ * compiler at -O0 and -O2; every executable runs several times, its output
+ * is checked against program.expected, and the fastest wall time is kept
+ * together with the user space instructions retired, when the kernel lets
+ * perf_event_open count them.
+ */
+#include <fcntl.h>
+#include <getopt.h>
+#include <linux/perf_event.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RUNTIME_VARIANT_COUNT 3
+#define NO_INSTRUCTIONS UINT64_MAX
+
+typedef struct runtime_measure {
+    double milliseconds;
+    // NO_INSTRUCTIONS when they can't be counted
+    uint64_t instructions;
+    bool output_matches;
+} runtime_measure_t;
+
+int benchmark_program(const char* compiler, const char* cc, const char* program,
+                      const char* directory, size_t repeat);
+
+int build_variant(const char* compiler, const char* cc, size_t variant, const char* program,
+                  const char* base, const char* executable);
+
+int measure_executable(const char* executable, const char* expected, size_t repeat, runtime_measure_t* measure);
+
+int run_executable(const char* executable, FILE* output, double* milliseconds, uint64_t* instructions);
+
+int run_command(char* const* arguments);
+
+int open_instruction_counter(pid_t pid);
+
+bool files_equal(FILE* file, const char* path);
+
+void print_runtime_bench_help(const char* program_name);
+
+static const char* variant_names[RUNTIME_VARIANT_COUNT] = { "etapa6", "cc -O0", "cc -O2" };
+
+
+int main(int argc, char** argv) {
+    size_t repeat = 5;
+    const char* cc = "cc";
+
+    static struct option long_options[] = {
+        {"repeat", required_argument, NULL, 'n'},
+        {"cc", required_argument, NULL, 'c'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}
+    };
+    int c;
+    while((c = getopt_long(argc, argv, "n:c:h", long_options, NULL)) != -1) {
+        switch(c) {
+            case 'n': repeat = strtoul(optarg, NULL, 10); break;
+            case 'c': cc = optarg; break;
+            case 'h':
+                print_runtime_bench_help(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                print_runtime_bench_help(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(argc - optind < 2 || repeat == 0) {
+        print_runtime_bench_help(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char directory[] = "/tmp/runtime_bench.XXXXXX";
+    if(mkdtemp(directory) == NULL) {
+        perror(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-12s %-8s %12s %16s %10s  %s\n", "Program", "Variant", "Time (ms)",
+           "Instructions", "Slowdown", "Output");
+    int failures = 0;
+    for(int i = optind + 1; i < argc; i++) {
+        failures += benchmark_program(argv[optind], cc, argv[i], directory, repeat);
+    }
+
+    char* remove_arguments[] = { "rm", "-rf", directory, NULL };
+    run_command(remove_arguments);
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+// Returns the number of variants that failed to build, run or match the
+// expected output
+int benchmark_program(const char* compiler, const char* cc, const char* program,
+                      const char* directory, size_t repeat) {
+    size_t length = strlen(program);
+    if(length < 4 || strcmp(program + length - 4, ".txt") != 0) {
+        fprintf(stderr, "%s: not a .txt program\n", program);
+        return RUNTIME_VARIANT_COUNT;
+    }
+    char base[2048];
+    char name[2048];
+    char expected[2048 + sizeof(".expected")];
+    snprintf(base, sizeof(base), "%.*s", (int)(length - 4), program);
+    const char* slash = strrchr(base, '/');
+    snprintf(name, sizeof(name), "%s", slash != NULL ? slash + 1 : base);
+    snprintf(expected, sizeof(expected), "%s.expected", base);
+
+    runtime_measure_t measures[RUNTIME_VARIANT_COUNT];
+    bool measured[RUNTIME_VARIANT_COUNT];
+    int failures = 0;
+    for(size_t variant = 0; variant < RUNTIME_VARIANT_COUNT; variant++) {
+        char executable[4096];
+        snprintf(executable, sizeof(executable), "%s/%s.%zu", directory, name, variant);
+        measured[variant] = build_variant(compiler, cc, variant, program, base, executable) == 0
+                         && measure_executable(executable, expected, repeat, &measures[variant]) == 0;
+        if(!measured[variant] || !measures[variant].output_matches) {
+            failures++;
+        }
+    }
+
+    for(size_t variant = 0; variant < RUNTIME_VARIANT_COUNT; variant++) {
+        printf("%-12s %-8s", name, variant_names[variant]);
+        if(!measured[variant]) {
+            printf(" %12s %16s %10s  %s\n", "-", "-", "-", "failed");
+            continue;
+        }
+        const runtime_measure_t* measure = &measures[variant];
+        printf(" %12.3f", measure->milliseconds);
+        if(measure->instructions != NO_INSTRUCTIONS) {
+            printf(" %16llu", (unsigned long long)measure->instructions);
+        } else {
+            printf(" %16s", "n/a");
+        }
+        // How many times slower the compiler under test is than the variant
+        if(variant > 0 && measured[0] && measure->milliseconds > 0) {
+            printf(" %9.2fx", measures[0].milliseconds / measure->milliseconds);
+        } else {
+            printf(" %10s", "-");
+        }
+        printf("  %s\n", measure->output_matches ? "ok" : "WRONG");
+    }
+    return failures;
+}
+
+
+int build_variant(const char* compiler, const char* cc, size_t variant, const char* program,
+                  const char* base, const char* executable) {
+    char assembly[4096 + sizeof(".s")];
+    char source[2048 + sizeof(".c")];
+    snprintf(assembly, sizeof(assembly), "%s.s", executable);
+    snprintf(source, sizeof(source), "%s.c", base);
+    if(variant == 0) {
+        char* compile_arguments[] = { (char*)compiler, (char*)program, assembly, NULL };
+        char* link_arguments[] = { (char*)cc, "-o", (char*)executable, assembly, NULL };
+        return run_command(compile_arguments) == 0 ? run_command(link_arguments) : -1;
+    }
+    char* arguments[] = { (char*)cc, variant == 1 ? "-O0" : "-O2", "-o", (char*)executable, source, NULL };
+    return run_command(arguments);
+}
+
+
+int measure_executable(const char* executable, const char* expected, size_t repeat, runtime_measure_t* measure) {
+    measure->milliseconds = 0;
+    measure->instructions = NO_INSTRUCTIONS;
+    measure->output_matches = false;
+    for(size_t i = 0; i < repeat; i++) {
+        // Only the output of the first run is checked
+        FILE* output = i == 0 ? tmpfile() : NULL;
+        double milliseconds;
+        uint64_t instructions;
+        int status = run_executable(executable, output, &milliseconds, &instructions);
+        if(output != NULL) {
+            measure->output_matches = status == 0 && files_equal(output, expected);
+            fclose(output);
+        }
+        if(status != 0) {
+            return -1;
+        }
+        if(i == 0 || milliseconds < measure->milliseconds) {
+            measure->milliseconds = milliseconds;
+        }
+        if(instructions < measure->instructions) {
+            measure->instructions = instructions;
+        }
+    }
+    return 0;
+}
+
+
+// The child waits on a pipe until the counter is attached, which starts
+// counting when it calls exec
+int run_executable(const char* executable, FILE* output, double* milliseconds, uint64_t* instructions) {
+    int start_pipe[2];
+    if(pipe(start_pipe) == -1) {
+        return -1;
+    }
+    pid_t child = fork();
+    if(child == -1) {
+        close(start_pipe[0]);
+        close(start_pipe[1]);
+        return -1;
+    }
+    if(child == 0) {
+        char start;
+        close(start_pipe[1]);
+        if(read(start_pipe[0], &start, 1) < 0) {
+            _exit(127);
+        }
+        int null = open("/dev/null", O_RDWR);
+        dup2(null, STDIN_FILENO);
+        dup2(output != NULL ? fileno(output) : null, STDOUT_FILENO);
+        execl(executable, executable, (char*)NULL);
+        _exit(127);
+    }
+    close(start_pipe[0]);
+    int counter = open_instruction_counter(child);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    close(start_pipe[1]);
+    int status;
+    waitpid(child, &status, 0);
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *milliseconds = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+
+    *instructions = NO_INSTRUCTIONS;
+    if(counter != -1) {
+        uint64_t count;
+        if(read(counter, &count, sizeof(count)) == sizeof(count)) {
+            *instructions = count;
+        }
+        close(counter);
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+
+// Runs a build step with its output discarded
+int run_command(char* const* arguments) {
+    pid_t child = fork();
+    if(child == -1) {
+        return -1;
+    }
+    if(child == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        execvp(arguments[0], arguments);
+        _exit(127);
+    }
+    int status;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+
+// Returns -1 when counting is not supported or not allowed
+int open_instruction_counter(pid_t pid) {
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attributes.disabled = 1;
+    attributes.enable_on_exec = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attributes, pid, -1, -1, 0);
+}
+
+
+bool files_equal(FILE* file, const char* path) {
+    FILE* other = fopen(path, "r");
+    if(other == NULL) {
+        return false;
+    }
+    rewind(file);
+    int c;
+    int other_c;
+    do {
+        c = fgetc(file);
+        other_c = fgetc(other);
+    } while(c == other_c && c != EOF);
+    fclose(other);
+    return c == other_c;
+}
+
+
+void print_runtime_bench_help(const char* program_name) {
+    fprintf(stderr, "Usage: %s [OPTION...] compiler program.txt [program.txt...]\n"
+            "    Each program.txt needs an equivalent program.c and the output\n"
+            "    both must print in program.expected.\n"
+            "\n"
+            "    -n, --repeat=N       Run each executable N times and keep the\n"
+            "                         fastest run (default: 5)\n"
+            "    -c, --cc=CC          C compiler of the references, also used to\n"
+            "                         assemble and link (default: cc)\n"
+            "    -h, --help           Give this help list\n",
+            program_name);
+}
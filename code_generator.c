@@ -2,6 +2,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include "allocation.h"
 #include "tac.h"
 
 typedef list_t code_list_t;
@@ -13,9 +14,9 @@ void rename_parameters(symbol_table_t* st);
 
 void put_scope_in_returns(list_iterator_t it);
 
-tac_list_t* generate_node_code(ast_node_t* node, symbol_table_t* st);
+tac_list_t* generate_node_code(ast_node_t* node, compilation_context_t* context);
 
-tac_list_t* generate_literal_code(symbol_t* literal_symbol, symbol_table_t* st);
+tac_list_t* generate_literal_code(symbol_t* literal_symbol, compilation_context_t* context);
 
 tac_list_t* generate_variable_declaration(code_iterator_t declaration_codes);
 
@@ -27,18 +28,18 @@ tac_list_t* generate_move_code(code_iterator_t move_codes);
 
 tac_list_t* generate_move_to_vector_code(code_iterator_t move_codes);
 
-tac_list_t* generate_if_then_code(symbol_table_t* st, code_iterator_t condition_and_command_codes);
+tac_list_t* generate_if_then_code(compilation_context_t* context, code_iterator_t condition_and_command_codes);
 
-tac_list_t* generate_if_then_else_code(symbol_table_t* st, code_iterator_t condition_command_command_codes);
+tac_list_t* generate_if_then_else_code(compilation_context_t* context, code_iterator_t condition_command_command_codes);
 
-tac_list_t* generate_while_code(symbol_table_t* st, code_iterator_t condition_and_command_codes);
+tac_list_t* generate_while_code(compilation_context_t* context, code_iterator_t condition_and_command_codes);
 
-tac_list_t* generate_binary_operation_code(symbol_table_t* st, code_iterator_t expressions_codes, 
+tac_list_t* generate_binary_operation_code(compilation_context_t* context, code_iterator_t expressions_codes, 
                                            ast_node_type_t node_type, data_type_t resulting_type);
 
-tac_list_t* generate_read_code(symbol_table_t* st, data_type_t resulting_type);
+tac_list_t* generate_read_code(compilation_context_t* context, data_type_t resulting_type);
 
-tac_list_t* generate_vector_indexing_code(symbol_table_t* st, code_iterator_t vector_codes, 
+tac_list_t* generate_vector_indexing_code(compilation_context_t* context, code_iterator_t vector_codes, 
                                           data_type_t resulting_type);
 
 tac_list_t* generate_goto_code(code_iterator_t goto_codes);
@@ -49,7 +50,7 @@ tac_list_t* generate_label_code(code_iterator_t label_codes);
 
 tac_list_t* generate_function_argument_code(code_iterator_t argument_codes);
 
-tac_list_t* generate_function_call_code(symbol_table_t* st, code_iterator_t declaration_codes,
+tac_list_t* generate_function_call_code(compilation_context_t* context, code_iterator_t declaration_codes,
                                         data_type_t resulting_type);
 
 tac_list_t* generate_print_argument_code(code_iterator_t printable_codes);
@@ -62,25 +63,29 @@ tac_list_t* temps_initialization(symbol_table_t* st);
 
 tac_list_t* parameters_initialization(symbol_table_t* st);
 
-tac_list_t* literal_initialization(tac_list_t* tacs, symbol_table_t* st);
+tac_list_t* literal_initialization(tac_list_t* tacs, compilation_context_t* context);
 
 tac_type_t node_type_to_tac_type(ast_node_type_t node_type);
 
-symbol_t* make_literal(symbol_table_t* st);
+symbol_t* make_literal(compilation_context_t* context);
 
-symbol_t* make_temp(symbol_table_t* st);
+symbol_t* make_temp(compilation_context_t* context);
 
-symbol_t* make_label(symbol_table_t* st);
+symbol_t* make_label(compilation_context_t* context);
 
+symbol_t* make_numbered_symbol(compilation_context_t* context, const char* kind, int number,
+                               symbol_type_t type);
 
-tac_list_t* generate_code(ast_t* ast, symbol_table_t* st) {
+
+tac_list_t* generate_code(compilation_context_t* context) {
+    symbol_table_t* st = context->symbol_table;
     add_prefix_to_names(st, "");
-    tac_list_t* code = generate_node_code(ast_get_root(ast), st);
+    tac_list_t* code = generate_node_code(ast_get_root(context->ast), context);
     rename_parameters(st);
     put_scope_in_returns(list_begin(code));
     tac_list_t* temps = temps_initialization(st);
     tac_list_t* parameters = parameters_initialization(st);
-    tac_list_t* literals = literal_initialization(code, st);
+    tac_list_t* literals = literal_initialization(code, context);
     list_merge_at_beginning(code, temps);
     list_merge_at_beginning(code, parameters);
     list_merge_at_beginning(code, literals);
@@ -106,7 +111,7 @@ tac_list_t* temps_initialization(symbol_table_t* st) {
     tac_list_t* temps = new_list();
     for(symbol_table_iterator_t it = symbol_table_begin(st); symbol_table_current(it) != NULL; symbol_table_next(&it)) {
         symbol_t* temp = symbol_table_current(it);
-        if(strncmp(".temp", temp->value, strlen(".temp")) == 0) {
+        if(is_temp(temp)) {
             list_push_back(temps, new_tac(tac_temp, temp, NOP, NOP));
         }
     }
@@ -130,23 +135,31 @@ void rename_parameters(symbol_table_t* st) {
     for(symbol_table_iterator_t it = symbol_table_begin(st); symbol_table_current(it) != NULL; symbol_table_next(&it)) {
         symbol_t* s = symbol_table_current(it);
         if(s->type == symbol_parameter) {
-            char* prefixed_name = malloc(strlen(s->value)+strlen(s->scope->value)+3);
+            char* prefixed_name = allocate(allocation_string, strlen(s->value)+strlen(s->scope->value)+3);
             strcpy(prefixed_name, ".");
             strcat(prefixed_name, s->scope->value);
             strcat(prefixed_name, "_");
             strcat(prefixed_name, s->value);
-            free(s->value);
-            s->value = prefixed_name;
+            symbol_table_rename(st, s, prefixed_name);
         }
     }
 }
 
 
-tac_list_t* literal_initialization(tac_list_t* tacs, symbol_table_t* st) {
+tac_list_t* literal_initialization(tac_list_t* tacs, compilation_context_t* context) {
     tac_list_t* literals = new_list();
+    int global_literal_count = 0;
 
     for(list_iterator_t it = list_begin(tacs); list_current(it) != NULL; list_next(&it)) {
         tac_t* tac = list_current(it);
+        if(tac->type == tac_begin_function) {
+            global_literal_count = context->literal_count;
+            context->function = tac->res;
+            context->literal_count = 0;
+        } else if(tac->type == tac_end_function) {
+            context->function = NULL;
+            context->literal_count = global_literal_count;
+        }
         if(tac->type == tac_init ||
            tac->type == tac_vector_uninit ||
            tac->type == tac_vector_init ||
@@ -157,7 +170,7 @@ tac_list_t* literal_initialization(tac_list_t* tacs, symbol_table_t* st) {
         if(tac->res != NOP && (tac->res->type == symbol_int_literal ||
                                tac->res->type == symbol_char_literal ||
                                tac->res->type == symbol_string_literal)) {
-            symbol_t* literal_label = make_literal(st);
+            symbol_t* literal_label = make_literal(context);
             literal_label->data_type = tac->res->data_type;
             list_push_back(literals, new_tac(tac_init, literal_label, tac->res, NOP));
             tac->res = literal_label;
@@ -166,7 +179,7 @@ tac_list_t* literal_initialization(tac_list_t* tacs, symbol_table_t* st) {
         if(tac->op1 != NOP && (tac->op1->type == symbol_int_literal ||
                                tac->op1->type == symbol_char_literal ||
                                tac->op1->type == symbol_string_literal)) {
-            symbol_t* literal_label = make_literal(st);
+            symbol_t* literal_label = make_literal(context);
             literal_label->data_type = tac->op1->data_type;
             list_push_back(literals, new_tac(tac_init, literal_label, tac->op1, NOP));
             tac->op1 = literal_label;
@@ -175,7 +188,7 @@ tac_list_t* literal_initialization(tac_list_t* tacs, symbol_table_t* st) {
         if(tac->op2 != NOP && (tac->op2->type == symbol_int_literal ||
                                tac->op2->type == symbol_char_literal ||
                                tac->op2->type == symbol_string_literal)) {
-            symbol_t* literal_label = make_literal(st);
+            symbol_t* literal_label = make_literal(context);
             literal_label->data_type = tac->op2->data_type;
             list_push_back(literals, new_tac(tac_init, literal_label, tac->op2, NOP));
             tac->op2 = literal_label;
@@ -185,15 +198,20 @@ tac_list_t* literal_initialization(tac_list_t* tacs, symbol_table_t* st) {
 }
 
 
-tac_list_t* generate_node_code(ast_node_t* node, symbol_table_t* st) {
+tac_list_t* generate_node_code(ast_node_t* node, compilation_context_t* context) {
     if(node == NULL) {
         return new_list();
     }
+    if(ast_node_get_type(node) == ast_func_decl) {
+        context->function = ast_node_get_scope(node);
+        context->temp_count = 0;
+        context->label_count = 0;
+    }
     code_list_t* children_codes = new_list();
 
     ast_list_t* children = ast_node_get_children(node);
     for(list_iterator_t it = list_begin(children); list_current(it) != NULL; list_next(&it)) {
-        list_push_back(children_codes, generate_node_code(list_current(it), st));
+        list_push_back(children_codes, generate_node_code(list_current(it), context));
     }
 
     code_iterator_t children_codes_it = list_begin(children_codes);
@@ -203,7 +221,7 @@ tac_list_t* generate_node_code(ast_node_t* node, symbol_table_t* st) {
     switch(ast_node_get_type(node)) {
         case ast_symbol:
             list_push_back(node_code, new_tac(tac_symbol, ast_node_get_symbol(node), NULL, NULL));
-            //list_merge(node_code, generate_literal_code(ast_node_get_symbol(node), st));
+            //list_merge(node_code, generate_literal_code(ast_node_get_symbol(node), context));
             break;
         case ast_int_decl:
         case ast_char_decl:
@@ -232,23 +250,23 @@ tac_list_t* generate_node_code(ast_node_t* node, symbol_table_t* st) {
         case ast_ge:
         case ast_eq:
         case ast_dif:
-            list_merge(node_code, generate_binary_operation_code(st, children_codes_it, 
+            list_merge(node_code, generate_binary_operation_code(context, children_codes_it, 
                        ast_node_get_type(node), ast_node_get_evaluated_data_type(node)));
             break;
         case ast_if:;
-            list_merge(node_code, generate_if_then_code(st, children_codes_it));
+            list_merge(node_code, generate_if_then_code(context, children_codes_it));
             break;
         case ast_if_else:
-            list_merge(node_code, generate_if_then_else_code(st, children_codes_it));
+            list_merge(node_code, generate_if_then_else_code(context, children_codes_it));
             break;
         case ast_while:
-            list_merge(node_code, generate_while_code(st, children_codes_it));
+            list_merge(node_code, generate_while_code(context, children_codes_it));
             break;
         case ast_read:
-            list_merge(node_code, generate_read_code(st, ast_node_get_evaluated_data_type(node)));
+            list_merge(node_code, generate_read_code(context, ast_node_get_evaluated_data_type(node)));
             break;
         case ast_vector_index:
-            list_merge(node_code, generate_vector_indexing_code(st, children_codes_it, 
+            list_merge(node_code, generate_vector_indexing_code(context, children_codes_it, 
                        ast_node_get_evaluated_data_type(node)));
             break;
         case ast_goto:
@@ -264,7 +282,7 @@ tac_list_t* generate_node_code(ast_node_t* node, symbol_table_t* st) {
             list_merge(node_code, generate_function_argument_code(children_codes_it));
             break;
         case ast_func_call:
-            list_merge(node_code, generate_function_call_code(st, children_codes_it,
+            list_merge(node_code, generate_function_call_code(context, children_codes_it,
                        ast_node_get_evaluated_data_type(node)));
             break;
         case ast_print_arg:
@@ -286,16 +304,19 @@ tac_list_t* generate_node_code(ast_node_t* node, symbol_table_t* st) {
     }
 
     delete_list(children_codes, NULL);
+    if(ast_node_get_type(node) == ast_func_decl) {
+        context->function = NULL;
+    }
     return node_code;
 }
 
 
-tac_list_t* generate_literal_code(symbol_t* literal_symbol, symbol_table_t* st) {
+tac_list_t* generate_literal_code(symbol_t* literal_symbol, compilation_context_t* context) {
     list_t* literal_code = new_list();
     if(literal_symbol->type == symbol_int_literal ||
        literal_symbol->type == symbol_char_literal ||
        literal_symbol->type == symbol_string_literal) {
-        tac_t* literal = new_tac(tac_literal, make_literal(st), literal_symbol, NOP);
+        tac_t* literal = new_tac(tac_literal, make_literal(context), literal_symbol, NOP);
         literal->res->data_type = literal_symbol->data_type;
         list_push_back(literal_code, literal);
     }
@@ -304,44 +325,52 @@ tac_list_t* generate_literal_code(symbol_t* literal_symbol, symbol_table_t* st)
 }
 
 
-symbol_t* make_literal(symbol_table_t* st) {
-    static int serial = 0;
-    char name[256] = "";
-
-    sprintf(name, ".lit%d", serial);
-    serial++;
-
-    return symbol_table_add(st, name, symbol_label, 0);
+symbol_t* make_literal(compilation_context_t* context) {
+    context->statistics.literals++;
+    return make_numbered_symbol(context, "lit", context->literal_count++, symbol_label);
 }
 
 
-symbol_t* make_temp(symbol_table_t* st) {
-    static int serial = 0;
-    char name[256] = "";
+symbol_t* make_temp(compilation_context_t* context) {
+    context->statistics.temps++;
+    return make_numbered_symbol(context, "temp", context->temp_count++, symbol_variable);
+}
 
-    sprintf(name, ".temp%d", serial);
-    serial++;
 
-    return symbol_table_add(st, name, symbol_variable, 0);
+symbol_t* make_label(compilation_context_t* context) {
+    context->statistics.labels++;
+    return make_numbered_symbol(context, "label", context->label_count++, symbol_label);
 }
 
 
-symbol_t* make_label(symbol_table_t* st) {
-    static int serial = 0;
-    char name[256] = "";
+// Named .<function>.<kind><number> inside functions and .<kind><number>
+// outside them
+symbol_t* make_numbered_symbol(compilation_context_t* context, const char* kind, int number,
+                               symbol_type_t type) {
+    const char* function = context->function != NULL ? context->function->value : "";
+    const char* separator = context->function != NULL ? "." : "";
+    int length = snprintf(NULL, 0, ".%s%s%s%d", function, separator, kind, number);
+    char* name = allocate(allocation_string, length + 1);
+    snprintf(name, length + 1, ".%s%s%s%d", function, separator, kind, number);
 
-    sprintf(name, ".label%d", serial);
-    serial++;
+    symbol_t* symbol = symbol_table_add(context->symbol_table, name, type, 0);
+    release(allocation_string, name);
+    return symbol;
+}
 
-    return symbol_table_add(st, name, symbol_label, 0);
+
+// User variables can't start with a dot and renamed parameters are not
+// variables
+bool is_temp(symbol_t* symbol) {
+    return symbol->type == symbol_variable && symbol->value[0] == '.';
 }
 
 
-tac_list_t* generate_if_then_code(symbol_table_t* st, code_iterator_t condition_and_command_codes) {
+tac_list_t* generate_if_then_code(compilation_context_t* context, code_iterator_t condition_and_command_codes) {
     tac_list_t* condition_code = list_current(condition_and_command_codes);
     tac_list_t* command_code = list_current(list_next(&condition_and_command_codes));
 
-    symbol_t* label_symbol = make_label(st);
+    symbol_t* label_symbol = make_label(context);
     tac_t* condition_result = list_back(condition_code);
     tac_t* jump = new_tac(tac_jump_false, label_symbol, condition_result->res, NOP);
     tac_t* label = new_tac(tac_label, label_symbol, NOP, NOP);
@@ -356,13 +385,13 @@ tac_list_t* generate_if_then_code(symbol_table_t* st, code_iterator_t condition_
 }
 
 
-tac_list_t* generate_if_then_else_code(symbol_table_t* st, code_iterator_t condition_command_command_codes) {
+tac_list_t* generate_if_then_else_code(compilation_context_t* context, code_iterator_t condition_command_command_codes) {
     tac_list_t* condition_code = list_current(condition_command_command_codes);
     tac_list_t* then_code = list_current(list_next(&condition_command_command_codes));
     tac_list_t* else_code = list_current(list_next(&condition_command_command_codes));
 
-    symbol_t* else_symbol = make_label(st);
-    symbol_t* continue_symbol = make_label(st);
+    symbol_t* else_symbol = make_label(context);
+    symbol_t* continue_symbol = make_label(context);
     tac_t* condition_result = list_back(condition_code);
     tac_t* jump_to_else = new_tac(tac_jump_false, else_symbol, condition_result->res, NOP);
     tac_t* skip_else = new_tac(tac_jump, continue_symbol, NOP, NOP);
@@ -382,12 +411,12 @@ tac_list_t* generate_if_then_else_code(symbol_table_t* st, code_iterator_t condi
 }
 
 
-tac_list_t* generate_while_code(symbol_table_t* st, code_iterator_t condition_and_command_codes) {
+tac_list_t* generate_while_code(compilation_context_t* context, code_iterator_t condition_and_command_codes) {
     tac_list_t* condition_code = list_current(condition_and_command_codes);
     tac_list_t* command_code = list_current(list_next(&condition_and_command_codes));
 
-    symbol_t* while_begin_label = make_label(st);
-    symbol_t* while_end_label = make_label(st);
+    symbol_t* while_begin_label = make_label(context);
+    symbol_t* while_end_label = make_label(context);
 
     tac_t* while_begin = new_tac(tac_label, while_begin_label, NOP, NOP);
     tac_t* condition_result = list_back(condition_code);
@@ -407,14 +436,14 @@ tac_list_t* generate_while_code(symbol_table_t* st, code_iterator_t condition_an
 }
 
 
-tac_list_t* generate_binary_operation_code(symbol_table_t* st, code_iterator_t expressions_codes, 
+tac_list_t* generate_binary_operation_code(compilation_context_t* context, code_iterator_t expressions_codes, 
                                            ast_node_type_t node_type, data_type_t resulting_type) {
     tac_list_t* left_expression_code = list_current(expressions_codes);
     tac_list_t* right_expression_code = list_current(list_next(&expressions_codes));
 
     tac_t* left_expression_result = list_back(left_expression_code);
     tac_t* right_expression_result = list_back(right_expression_code);
-    tac_t* operation = new_tac(node_type_to_tac_type(node_type), make_temp(st), 
+    tac_t* operation = new_tac(node_type_to_tac_type(node_type), make_temp(context), 
                                left_expression_result->res, right_expression_result->res);
     operation->res->data_type = resulting_type;
 
@@ -431,18 +460,15 @@ tac_list_t* generate_binary_operation_code(symbol_table_t* st, code_iterator_t e
 }
 
 
-void tac_printer(list_element_t* element) {
-    tac_t* tac = element;
-    fprintf(stderr, "TAC(%s, %s, %s, %s)\n",
-            tac_type_to_string(tac->type),
-            tac->res->value,
-            tac->op1 != NULL ? tac->op1->value : "NOP",
-            tac->op2 != NULL ? tac->op2->value : "NOP");
-}
-
-
-void print_code(list_t* code) {
-    list_print(code, &tac_printer); 
+void print_code(FILE* stream, list_t* code) {
+    for(list_iterator_t it = list_begin(code); list_current(it) != NULL; list_next(&it)) {
+        tac_t* tac = list_current(it);
+        fprintf(stream, "TAC(%s, %s, %s, %s)\n",
+                tac_type_to_string(tac->type),
+                tac->res->value,
+                tac->op1 != NULL ? tac->op1->value : "NOP",
+                tac->op2 != NULL ? tac->op2->value : "NOP");
+    }
 }
 
 
@@ -573,8 +599,8 @@ tac_list_t* generate_move_to_vector_code(code_iterator_t move_codes) {
 }
 
 
-tac_list_t* generate_read_code(symbol_table_t* st, data_type_t resulting_type) {
-    symbol_t* read_result = make_temp(st);
+tac_list_t* generate_read_code(compilation_context_t* context, data_type_t resulting_type) {
+    symbol_t* read_result = make_temp(context);
     read_result->data_type = resulting_type;
     tac_t* read = new_tac(tac_read, read_result, NULL, NULL);
     tac_list_t* read_code = new_list();
@@ -584,7 +610,7 @@ tac_list_t* generate_read_code(symbol_table_t* st, data_type_t resulting_type) {
 }
 
 
-tac_list_t* generate_vector_indexing_code(symbol_table_t* st, code_iterator_t vector_codes, 
+tac_list_t* generate_vector_indexing_code(compilation_context_t* context, code_iterator_t vector_codes, 
                                           data_type_t resulting_type) {
     tac_list_t* identifier_code = list_current(vector_codes);
     tac_list_t* index_code = list_current(list_next(&vector_codes));
@@ -592,7 +618,7 @@ tac_list_t* generate_vector_indexing_code(symbol_table_t* st, code_iterator_t ve
     tac_t* identifier = list_back(identifier_code);
     tac_t* index = list_back(index_code);
 
-    symbol_t* temp = make_temp(st);
+    symbol_t* temp = make_temp(context);
     temp->data_type = resulting_type;
 
     tac_t* indexed_vector = new_tac(tac_vector_index, temp, identifier->res, index->res);
@@ -643,8 +669,10 @@ tac_list_t* generate_label_code(code_iterator_t label_codes) {
 
     tac_list_t* label_code = new_list();
     list_push_back(label_code, return_tac);
-    list_merge(label_code, following_code);
-    
+    // A label may end its block
+    if(following_code != NULL) {
+        list_merge(label_code, following_code);
+    }
 
     return label_code;
 }
@@ -670,13 +698,13 @@ tac_list_t* generate_function_argument_code(code_iterator_t argument_codes) {
 }
 
 
-tac_list_t* generate_function_call_code(symbol_table_t* st, code_iterator_t declaration_codes, 
+tac_list_t* generate_function_call_code(compilation_context_t* context, code_iterator_t declaration_codes, 
                                         data_type_t resulting_type) {
     tac_list_t* identifier_code = list_current(declaration_codes);
     tac_list_t* arguments_code = list_current(list_next(&declaration_codes));
 
     tac_t* identifier = list_back(identifier_code);
-    tac_t* call = new_tac(tac_call, make_temp(st), identifier->res, NULL);
+    tac_t* call = new_tac(tac_call, make_temp(context), identifier->res, NULL);
     call->res->data_type = resulting_type;
 
     tac_list_t* function_call = new_list();
@@ -750,11 +778,10 @@ void add_prefix_to_names(symbol_table_t* st, char* prefix) {
         if(s->type != symbol_char_literal &&
            s->type != symbol_int_literal &&
            s->type != symbol_string_literal) {
-            char* prefixed_name = malloc(strlen(s->value)+strlen(prefix)+1);
+            char* prefixed_name = allocate(allocation_string, strlen(s->value)+strlen(prefix)+1);
             strcpy(prefixed_name, prefix);
             strcat(prefixed_name, s->value);
-            free(s->value);
-            s->value = prefixed_name;
+            symbol_table_rename(st, s, prefixed_name);
         }
     }
 }
\ No newline at end of file
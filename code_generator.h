@@ -1,12 +1,17 @@
 #ifndef CODE_GENERATOR_H
 #define CODE_GENERATOR_H
 
+#include <stdio.h>
+
 #include "list.h"
-#include "syntax_tree.h"
-#include "symbol_table.h"
+#include "compilation_context.h"
+
+list_t* generate_code(compilation_context_t* context);
 
-list_t* generate_code(ast_t* ast, symbol_table_t* st);
+void print_code(FILE* stream, list_t* code);
 
-void print_code(list_t* code);
+// Whether the symbol is a temporary made by the code generator, which is
+// written by a single instruction
+bool is_temp(symbol_t* symbol);
 
 #endif
\ No newline at end of file
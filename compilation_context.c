@@ -0,0 +1,83 @@
+#include "compilation_context.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+void delete_diagnostic(diagnostic_t* diagnostic);
+
+
+compilation_context_t* new_compilation_context() {
+    compilation_context_t* context = malloc(sizeof(compilation_context_t));
+    context->symbol_table = new_symbol_table();
+    context->ast = new_ast();
+    context->scanner = NULL;
+    context->line_count = 1;
+    context->is_running = false;
+    context->has_syntax_error = false;
+    context->function = NULL;
+    context->temp_count = 0;
+    context->label_count = 0;
+    context->literal_count = 0;
+    context->statistics = new_compiler_statistics();
+    context->diagnostics = new_list();
+    context->diagnostics_stream = stderr;
+    return context;
+}
+
+
+void delete_compilation_context(compilation_context_t* context) {
+    if(context == NULL) {
+        return;
+    }
+    delete_symbol_table(context->symbol_table);
+    delete_ast(context->ast);
+    delete_list(context->diagnostics, (void (*)(list_element_t*))&delete_diagnostic);
+    free(context);
+}
+
+
+void compilation_error(compilation_context_t* context, compilation_phase_t phase,
+                       int line, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+
+    diagnostic_t* diagnostic = malloc(sizeof(diagnostic_t));
+    diagnostic->phase = phase;
+    diagnostic->line = line;
+    diagnostic->message = malloc(length + 1);
+    va_start(arguments, format);
+    vsnprintf(diagnostic->message, length + 1, format, arguments);
+    va_end(arguments);
+    list_push_back(context->diagnostics, diagnostic);
+
+    if(context->diagnostics_stream != NULL) {
+        if(line > 0) {
+            fprintf(context->diagnostics_stream, "Line %d: ", line);
+        }
+        fprintf(context->diagnostics_stream, "%s\n", diagnostic->message);
+    }
+}
+
+
+size_t compilation_error_count(compilation_context_t* context) {
+    return list_size(context->diagnostics);
+}
+
+
+const char* compilation_phase_to_string(compilation_phase_t phase) {
+    switch(phase) {
+        case compilation_phase_lexical: return "lexical";
+        case compilation_phase_syntax: return "syntax";
+        case compilation_phase_semantic: return "semantic";
+        case compilation_phase_code_generation: return "code generation";
+        default: return "unknown";
+    }
+}
+
+
+void delete_diagnostic(diagnostic_t* diagnostic) {
+    free(diagnostic->message);
+    free(diagnostic);
+}
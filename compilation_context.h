@@ -0,0 +1,61 @@
+#ifndef COMPILATION_CONTEXT_H
+#define COMPILATION_CONTEXT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "compiler_statistics.h"
+#include "list.h"
+#include "symbol_table.h"
+#include "syntax_tree.h"
+
+typedef enum compilation_phase {
+    compilation_phase_lexical,
+    compilation_phase_syntax,
+    compilation_phase_semantic,
+    compilation_phase_code_generation
+} compilation_phase_t;
+
+typedef struct diagnostic {
+    compilation_phase_t phase;
+    // Zero when the error is not tied to a source line
+    int line;
+    char* message;
+} diagnostic_t;
+
+/*
+ * State of a single compilation: everything the scanner, parser and code
+ * generators used to keep in globals. Contexts share nothing, so several
+ * compilations may run in the same process, each on its own thread.
+ */
+typedef struct compilation_context {
+    symbol_table_t* symbol_table;
+    ast_t* ast;
+    void* scanner;
+    int line_count;
+    bool is_running;
+    bool has_syntax_error;
+    // Temps, labels and literals are numbered from zero in every function
+    // and carry its name, so a function's code doesn't depend on the others
+    symbol_t* function;
+    int temp_count;
+    int label_count;
+    int literal_count;
+    compiler_statistics_t statistics;
+    list_t* diagnostics;
+    // Errors are also printed here as they are reported, unless NULL
+    FILE* diagnostics_stream;
+} compilation_context_t;
+
+compilation_context_t* new_compilation_context();
+
+void delete_compilation_context(compilation_context_t* context);
+
+void compilation_error(compilation_context_t* context, compilation_phase_t phase,
+                       int line, const char* format, ...);
+
+size_t compilation_error_count(compilation_context_t* context);
+
+const char* compilation_phase_to_string(compilation_phase_t phase);
+
+#endif
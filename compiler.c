@@ -0,0 +1,345 @@
+#include "compiler.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "lex_helper_functions.h"
+#include "yacc_helper_functions.h"
+#include "semantic.h"
+#include "code_generator.h"
+#include "assembly_generator.h"
+#include "function_cache.h"
+#include "jit.h"
+#include "optimizer.h"
+#include "tac.h"
+#include "tac_file.h"
+
+compilation_context_t* new_compiler_context(const compiler_options_t* options);
+
+compile_status_t run_compiler(compilation_context_t* context, const compiler_options_t* options,
+                              FILE* output, int* exit_status);
+
+compile_status_t run_back_end(compilation_context_t* context, const compiler_options_t* options,
+                              list_t* code, const function_cache_t* cache,
+                              FILE* output, int* exit_status);
+
+compile_status_t generate_output(compilation_context_t* context, const compiler_options_t* options,
+                                 list_t* code, const function_cache_t* cache,
+                                 FILE* output, int* exit_status);
+
+compile_status_t execute_program(compilation_context_t* context, list_t* code, int* exit_status);
+
+compile_result_t* new_compile_result(compile_status_t status, compilation_context_t* context);
+
+
+compiler_options_t compiler_default_options() {
+    compiler_options_t options;
+    options.print_parser_steps = false;
+    options.print_scanner_steps = false;
+    options.print_symbol_table = false;
+    options.print_syntax_table = false;
+    options.print_tacs_list = false;
+    options.print_ast_memory_stats = false;
+    options.print_function_times = false;
+    options.optimize = true;
+    options.output_format = compiler_output_assembly;
+    options.backend_threads = 1;
+    options.cache_directory = NULL;
+    options.log = NULL;
+    return options;
+}
+
+
+compile_result_t* compile_buffer(const char* source, size_t length,
+                                 const compiler_options_t* options,
+                                 output_buffer_t* output) {
+    compiler_options_t default_options = compiler_default_options();
+    if(options == NULL) {
+        options = &default_options;
+    }
+
+    compilation_context_t* context = new_compiler_context(options);
+    lex_set_input_buffer(context, source, length);
+
+    output->data = NULL;
+    output->size = 0;
+    FILE* stream = open_memstream(&output->data, &output->size);
+    int exit_status = 0;
+    compile_status_t status = run_compiler(context, options, stream, &exit_status);
+    fclose(stream);
+
+    compile_result_t* result = new_compile_result(status, context);
+    result->exit_status = exit_status;
+    delete_compilation_context(context);
+    return result;
+}
+
+
+compile_result_t* compile_stream(FILE* source, FILE* output,
+                                 const compiler_options_t* options) {
+    compiler_options_t default_options = compiler_default_options();
+    if(options == NULL) {
+        options = &default_options;
+    }
+
+    compilation_context_t* context = new_compiler_context(options);
+    lex_set_input(context, source);
+    int exit_status = 0;
+    compile_status_t status = run_compiler(context, options, output, &exit_status);
+
+    compile_result_t* result = new_compile_result(status, context);
+    result->exit_status = exit_status;
+    delete_compilation_context(context);
+    return result;
+}
+
+
+compile_result_t* compile_in_place(char* buffer, size_t size, FILE* output,
+                                   const compiler_options_t* options) {
+    compiler_options_t default_options = compiler_default_options();
+    if(options == NULL) {
+        options = &default_options;
+    }
+
+    compilation_context_t* context = new_compiler_context(options);
+    lex_set_input_in_place(context, buffer, size);
+    int exit_status = 0;
+    compile_status_t status = run_compiler(context, options, output, &exit_status);
+
+    compile_result_t* result = new_compile_result(status, context);
+    result->exit_status = exit_status;
+    delete_compilation_context(context);
+    return result;
+}
+
+
+compile_result_t* compile_tac_file(const char* path, FILE* output,
+                                   const compiler_options_t* options) {
+    compiler_options_t default_options = compiler_default_options();
+    if(options == NULL) {
+        options = &default_options;
+    }
+
+    compilation_context_t* context = new_compilation_context();
+    context->diagnostics_stream = options->log;
+    int exit_status = 0;
+    compile_status_t status = compile_input_error;
+    tac_file_t* file = load_tac_file(path);
+    if(file == NULL) {
+        compilation_error(context, compilation_phase_code_generation, 0,
+                          "Could not load TAC file %s: %s", path, strerror(errno));
+    } else {
+        if(options->log != NULL && options->print_tacs_list) {
+            print_code(options->log, tac_file_code(file));
+        }
+        status = run_back_end(context, options, tac_file_code(file), NULL, output, &exit_status);
+        delete_tac_file(file);
+    }
+
+    compile_result_t* result = new_compile_result(status, context);
+    result->exit_status = exit_status;
+    delete_compilation_context(context);
+    return result;
+}
+
+
+void delete_compile_result(compile_result_t* result) {
+    if(result == NULL) {
+        return;
+    }
+    for(size_t i = 0; i < result->diagnostic_count; i++) {
+        free(result->diagnostics[i].message);
+    }
+    free(result->diagnostics);
+    free(result);
+}
+
+
+void output_buffer_release(output_buffer_t* output) {
+    free(output->data);
+    output->data = NULL;
+    output->size = 0;
+}
+
+
+compilation_context_t* new_compiler_context(const compiler_options_t* options) {
+    compilation_context_t* context = new_compilation_context();
+    context->diagnostics_stream = options->log;
+    lex_init(context, options->print_parser_steps, options->print_scanner_steps);
+    return context;
+}
+
+
+compile_status_t run_compiler(compilation_context_t* context, const compiler_options_t* options,
+                              FILE* output, int* exit_status) {
+    FILE* log = options->log;
+    compiler_statistics_t* statistics = &context->statistics;
+
+    pass_timer_t timer = start_pass_timer(compiler_pass_parse);
+    yacc_init(context);
+    yacc_parse(context);
+    lex_destroy(context);
+    stop_pass_timer(statistics, &timer);
+    if(syntax_error_occured(context)) {
+        return compile_syntax_error;
+    }
+
+    if(log != NULL && options->print_ast_memory_stats) {
+        ast_print_memory_stats(log, context->ast);
+    }
+
+    timer = start_pass_timer(compiler_pass_semantic);
+    int semantic_errors = check_semantic_errors(context);
+    stop_pass_timer(statistics, &timer);
+    if(log != NULL && options->print_symbol_table) {
+        symbol_table_print(log, context->symbol_table);
+        symbol_table_print_statistics(log, context->symbol_table);
+    }
+
+    if(log != NULL && options->print_syntax_table) {
+        ast_print(log, context->ast);
+    }
+
+    if(semantic_errors > 0) {
+        return compile_semantic_error;
+    }
+
+    // Functions are keyed before code generation renames their parameters
+    timer = start_pass_timer(compiler_pass_code_generation);
+    function_cache_t* cache = NULL;
+    if(options->cache_directory != NULL && options->output_format == compiler_output_assembly) {
+        cache = new_function_cache(options->cache_directory, context->ast, options->optimize);
+        if(cache == NULL) {
+            compilation_error(context, compilation_phase_code_generation, 0,
+                              "Could not use the cache directory %s: %s",
+                              options->cache_directory, strerror(errno));
+            return compile_output_error;
+        }
+    }
+
+    list_t* code = generate_code(context);
+    stop_pass_timer(statistics, &timer);
+
+    if(options->optimize) {
+        timer = start_pass_timer(compiler_pass_optimization);
+        code = optimize_code(context, code);
+        stop_pass_timer(statistics, &timer);
+    }
+
+    if(log != NULL && options->print_symbol_table) {
+        symbol_table_print(log, context->symbol_table);
+        symbol_table_print_statistics(log, context->symbol_table);
+    }
+
+    if(log != NULL && options->print_syntax_table) {
+        ast_print(log, context->ast);
+    }
+
+    if(log != NULL && options->print_tacs_list) {
+        print_code(log, code);
+    }
+
+    compile_status_t status = run_back_end(context, options, code, cache, output, exit_status);
+    delete_list(code, (void (*)(list_element_t *))&delete_tac);
+    delete_function_cache(cache);
+    return status;
+}
+
+
+compile_status_t run_back_end(compilation_context_t* context, const compiler_options_t* options,
+                              list_t* code, const function_cache_t* cache,
+                              FILE* output, int* exit_status) {
+    compiler_statistics_t* statistics = &context->statistics;
+    for(list_iterator_t it = list_begin(code); list_current(it) != NULL; list_next(&it)) {
+        tac_t* tac = list_current(it);
+        statistics->tacs[tac->type]++;
+    }
+
+    pass_timer_t timer = start_pass_timer(compiler_pass_back_end);
+    compile_status_t status = generate_output(context, options, code, cache, output, exit_status);
+    stop_pass_timer(statistics, &timer);
+
+    if(output != NULL) {
+        timer = start_pass_timer(compiler_pass_output);
+        fflush(output);
+        stop_pass_timer(statistics, &timer);
+        long position = ftell(output);
+        statistics->output_bytes = position > 0 ? position : 0;
+    }
+    return status;
+}
+
+
+compile_status_t generate_output(compilation_context_t* context, const compiler_options_t* options,
+                                 list_t* code, const function_cache_t* cache,
+                                 FILE* output, int* exit_status) {
+    switch(options->output_format) {
+        case compiler_output_object:
+            if(!generate_object(context, output, code)) {
+                compilation_error(context, compilation_phase_code_generation, 0,
+                                  "Could not write the object file");
+                return compile_output_error;
+            }
+            return compile_success;
+        case compiler_output_execute:
+            return execute_program(context, code, exit_status);
+        case compiler_output_tac:
+            if(!write_tac_file(output, code)) {
+                compilation_error(context, compilation_phase_code_generation, 0,
+                                  "Could not write the TAC file");
+                return compile_output_error;
+            }
+            return compile_success;
+        case compiler_output_tac_text:
+            print_code(output, code);
+            return compile_success;
+        default:
+            if(!generate_assembly(context, output, code, options->backend_threads,
+                                  options->print_function_times ? options->log : NULL, cache)) {
+                compilation_error(context, compilation_phase_code_generation, 0,
+                                  "Could not write the assembly file");
+                return compile_output_error;
+            }
+            return compile_success;
+    }
+}
+
+
+compile_status_t execute_program(compilation_context_t* context, list_t* code, int* exit_status) {
+    encoder_t* encoder = generate_machine_code(context, code);
+    jit_program_t* program = new_jit_program(context, encoder);
+    delete_encoder(encoder);
+    if(program == NULL) {
+        return compile_output_error;
+    }
+    *exit_status = jit_program_run(program);
+    delete_jit_program(program);
+    return compile_success;
+}
+
+
+compile_result_t* new_compile_result(compile_status_t status, compilation_context_t* context) {
+    compile_result_t* result = malloc(sizeof(compile_result_t));
+    result->status = status;
+    result->exit_status = 0;
+    result->statistics = context->statistics;
+    result->statistics.ast_nodes = ast_node_count(context->ast);
+    symbol_table_t* symbol_table = context->symbol_table;
+    for(symbol_table_iterator_t it = symbol_table_begin(symbol_table); symbol_table_current(it) != NULL;
+        symbol_table_next(&it)) {
+        symbol_t* symbol = symbol_table_current(it);
+        result->statistics.symbols[symbol->type]++;
+    }
+    result->diagnostic_count = list_size(context->diagnostics);
+    result->diagnostics = malloc(result->diagnostic_count * sizeof(diagnostic_t));
+
+    size_t i = 0;
+    for(list_iterator_t it = list_begin(context->diagnostics); list_current(it) != NULL; list_next(&it)) {
+        diagnostic_t* diagnostic = list_current(it);
+        result->diagnostics[i].phase = diagnostic->phase;
+        result->diagnostics[i].line = diagnostic->line;
+        result->diagnostics[i].message = strdup(diagnostic->message);
+        i++;
+    }
+    return result;
+}
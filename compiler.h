@@ -0,0 +1,97 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "compilation_context.h"
+#include "compiler_statistics.h"
+#include "error_codes.h"
+
+/*
+ * Library entry points. They run the whole pipeline on one source and never
+ * print or exit on their own: errors come back as diagnostics in the result.
+ */
+
+typedef enum compile_status {
+    compile_success = 0,
+    compile_input_error = FILE_OPEN_ERROR,
+    compile_syntax_error = SYNTAX_ERROR,
+    compile_semantic_error = SEMANTIC_ERROR,
+    compile_output_error = OUTPUT_ERROR
+} compile_status_t;
+
+typedef enum compiler_output_format {
+    compiler_output_assembly,
+    // ELF relocatable object for x86-64
+    compiler_output_object,
+    // Nothing is written, the program is loaded and run in this process and
+    // its exit status is kept in the result
+    compiler_output_execute,
+    // Binary TAC file, see tac_file.h
+    compiler_output_tac,
+    // The TAC list as printed by print_code
+    compiler_output_tac_text
+} compiler_output_format_t;
+
+typedef struct compiler_options {
+    bool print_parser_steps;
+    bool print_scanner_steps;
+    bool print_symbol_table;
+    bool print_syntax_table;
+    bool print_tacs_list;
+    bool print_ast_memory_stats;
+    bool print_function_times;
+    // Runs the TAC optimizer between code generation and the back end
+    bool optimize;
+    compiler_output_format_t output_format;
+    // Threads generating the functions of an assembly output, 0 or 1 for none
+    size_t backend_threads;
+    // Directory caching the assembly of every function, NULL for none. Only
+    // used for assembly output.
+    const char* cache_directory;
+    // Debug dumps and diagnostics are printed here, nothing is printed if NULL
+    FILE* log;
+} compiler_options_t;
+
+typedef struct compile_result {
+    compile_status_t status;
+    diagnostic_t* diagnostics;
+    size_t diagnostic_count;
+    // Value returned by the program's main when it was executed
+    int exit_status;
+    // Times of the passes that ran and counts of what they produced
+    compiler_statistics_t statistics;
+} compile_result_t;
+
+typedef struct output_buffer {
+    char* data;
+    size_t size;
+} output_buffer_t;
+
+compiler_options_t compiler_default_options();
+
+// Options may be NULL. The assembly is written to a new buffer in output,
+// which must be released with output_buffer_release.
+compile_result_t* compile_buffer(const char* source, size_t length,
+                                 const compiler_options_t* options,
+                                 output_buffer_t* output);
+
+// Output may be NULL when the program is executed
+compile_result_t* compile_stream(FILE* source, FILE* output,
+                                 const compiler_options_t* options);
+
+// Scans the source where it is, see lex_set_input_in_place for the layout
+compile_result_t* compile_in_place(char* buffer, size_t size, FILE* output,
+                                   const compiler_options_t* options);
+
+// Runs only the back end on a file written with compiler_output_tac
+compile_result_t* compile_tac_file(const char* path, FILE* output,
+                                   const compiler_options_t* options);
+
+void delete_compile_result(compile_result_t* result);
+
+void output_buffer_release(output_buffer_t* output);
+
+#endif
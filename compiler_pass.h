@@ -0,0 +1,17 @@
+#ifndef COMPILER_PASS_H
+#define COMPILER_PASS_H
+
+typedef enum compiler_pass {
+    // Scanning and parsing run together, the parser pulls the tokens
+    compiler_pass_parse,
+    compiler_pass_semantic,
+    compiler_pass_code_generation,
+    compiler_pass_optimization,
+    compiler_pass_back_end,
+    compiler_pass_output,
+    compiler_pass_count
+} compiler_pass_t;
+
+const char* compiler_pass_to_string(compiler_pass_t pass);
+
+#endif
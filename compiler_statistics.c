@@ -0,0 +1,156 @@
+#include "compiler_statistics.h"
+
+#include <string.h>
+
+#include "allocation.h"
+
+void read_clocks(struct timespec* wall, struct timespec* cpu);
+
+double timespec_milliseconds_between(const struct timespec* start, const struct timespec* end);
+
+size_t sum_counts(const size_t* counts, size_t count);
+
+void print_statistics_text(FILE* stream, const compiler_statistics_t* statistics);
+
+void print_statistics_json(FILE* stream, const compiler_statistics_t* statistics);
+
+
+compiler_statistics_t new_compiler_statistics() {
+    compiler_statistics_t statistics;
+    memset(&statistics, 0, sizeof(statistics));
+    return statistics;
+}
+
+
+pass_timer_t start_pass_timer(compiler_pass_t pass) {
+    pass_timer_t timer;
+    timer.pass = pass;
+    allocation_set_pass(pass);
+    read_clocks(&timer.wall, &timer.cpu);
+    return timer;
+}
+
+
+void stop_pass_timer(compiler_statistics_t* statistics, const pass_timer_t* timer) {
+    struct timespec wall;
+    struct timespec cpu;
+    read_clocks(&wall, &cpu);
+    allocation_set_pass(compiler_pass_count);
+    pass_time_t* time = &statistics->passes[timer->pass];
+    time->wall_milliseconds += timespec_milliseconds_between(&timer->wall, &wall);
+    time->cpu_milliseconds += timespec_milliseconds_between(&timer->cpu, &cpu);
+}
+
+
+void print_compiler_statistics(FILE* stream, const compiler_statistics_t* statistics,
+                               compiler_statistics_format_t format) {
+    if(format == compiler_statistics_json) {
+        print_statistics_json(stream, statistics);
+    } else {
+        print_statistics_text(stream, statistics);
+    }
+}
+
+
+const char* compiler_pass_to_string(compiler_pass_t pass) {
+    switch(pass) {
+        case compiler_pass_parse: return "parse";
+        case compiler_pass_semantic: return "semantic";
+        case compiler_pass_code_generation: return "code generation";
+        case compiler_pass_optimization: return "optimization";
+        case compiler_pass_back_end: return "back end";
+        case compiler_pass_output: return "output";
+        default: return "unknown";
+    }
+}
+
+
+void read_clocks(struct timespec* wall, struct timespec* cpu) {
+    clock_gettime(CLOCK_MONOTONIC, wall);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, cpu);
+}
+
+
+double timespec_milliseconds_between(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec) * 1e3 + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+
+size_t sum_counts(const size_t* counts, size_t count) {
+    size_t sum = 0;
+    for(size_t i = 0; i < count; i++) {
+        sum += counts[i];
+    }
+    return sum;
+}
+
+
+void print_statistics_text(FILE* stream, const compiler_statistics_t* statistics) {
+    pass_time_t total = { 0, 0 };
+    fprintf(stream, "%-18s %12s %12s\n", "Pass", "Wall (ms)", "CPU (ms)");
+    for(compiler_pass_t pass = 0; pass < compiler_pass_count; pass++) {
+        const pass_time_t* time = &statistics->passes[pass];
+        fprintf(stream, "%-18s %12.3f %12.3f\n", compiler_pass_to_string(pass),
+                time->wall_milliseconds, time->cpu_milliseconds);
+        total.wall_milliseconds += time->wall_milliseconds;
+        total.cpu_milliseconds += time->cpu_milliseconds;
+    }
+    fprintf(stream, "%-18s %12.3f %12.3f\n", "total", total.wall_milliseconds, total.cpu_milliseconds);
+
+    fprintf(stream, "Tokens scanned: %zu\n", statistics->tokens);
+    fprintf(stream, "AST nodes: %zu\n", statistics->ast_nodes);
+    fprintf(stream, "Symbols: %zu\n", sum_counts(statistics->symbols, SYMBOL_TYPE_COUNT));
+    for(symbol_type_t type = 0; type < SYMBOL_TYPE_COUNT; type++) {
+        if(statistics->symbols[type] > 0) {
+            fprintf(stream, "  %s: %zu\n", symbol_type_to_string(type), statistics->symbols[type]);
+        }
+    }
+    fprintf(stream, "TACs: %zu\n", sum_counts(statistics->tacs, TAC_TYPE_COUNT));
+    for(tac_type_t type = 0; type < TAC_TYPE_COUNT; type++) {
+        if(statistics->tacs[type] > 0) {
+            fprintf(stream, "  %s: %zu\n", tac_type_to_string(type), statistics->tacs[type]);
+        }
+    }
+    fprintf(stream, "Temps created: %zu\n", statistics->temps);
+    fprintf(stream, "Labels created: %zu\n", statistics->labels);
+    fprintf(stream, "Literals created: %zu\n", statistics->literals);
+    fprintf(stream, "Constants folded: %zu\n", statistics->folded_constants);
+    fprintf(stream, "Branches folded: %zu\n", statistics->folded_branches);
+    fprintf(stream, "Expressions reused: %zu\n", statistics->reused_expressions);
+    fprintf(stream, "Moves eliminated: %zu\n", statistics->eliminated_moves);
+    fprintf(stream, "Jumps threaded: %zu\n", statistics->threaded_jumps);
+    fprintf(stream, "Blocks merged: %zu\n", statistics->merged_blocks);
+    fprintf(stream, "Instructions removed: %zu\n", statistics->removed_instructions);
+    fprintf(stream, "Output bytes: %zu\n", statistics->output_bytes);
+}
+
+
+// Every key is always present, so that reports of different compilations
+// can be compared field by field
+void print_statistics_json(FILE* stream, const compiler_statistics_t* statistics) {
+    fprintf(stream, "{\"passes\":{");
+    for(compiler_pass_t pass = 0; pass < compiler_pass_count; pass++) {
+        fprintf(stream, "%s\"%s\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f}", pass > 0 ? "," : "",
+                compiler_pass_to_string(pass),
+                statistics->passes[pass].wall_milliseconds,
+                statistics->passes[pass].cpu_milliseconds);
+    }
+    fprintf(stream, "},\"tokens\":%zu,\"ast_nodes\":%zu,\"symbols\":{", statistics->tokens, statistics->ast_nodes);
+    for(symbol_type_t type = 0; type < SYMBOL_TYPE_COUNT; type++) {
+        fprintf(stream, "%s\"%s\":%zu", type > 0 ? "," : "",
+                symbol_type_to_string(type), statistics->symbols[type]);
+    }
+    fprintf(stream, "},\"tacs\":{");
+    for(tac_type_t type = 0; type < TAC_TYPE_COUNT; type++) {
+        fprintf(stream, "%s\"%s\":%zu", type > 0 ? "," : "",
+                tac_type_to_string(type), statistics->tacs[type]);
+    }
+    fprintf(stream, "},\"temps\":%zu,\"labels\":%zu,\"literals\":%zu,"
+            "\"folded_constants\":%zu,\"folded_branches\":%zu,\"reused_expressions\":%zu,"
+            "\"eliminated_moves\":%zu,\"threaded_jumps\":%zu,\"merged_blocks\":%zu,"
+            "\"removed_instructions\":%zu,\"output_bytes\":%zu}\n",
+            statistics->temps, statistics->labels, statistics->literals,
+            statistics->folded_constants, statistics->folded_branches, statistics->reused_expressions,
+            statistics->eliminated_moves, statistics->threaded_jumps, statistics->merged_blocks,
+            statistics->removed_instructions, statistics->output_bytes);
+}
@@ -0,0 +1,70 @@
+#ifndef COMPILER_STATISTICS_H
+#define COMPILER_STATISTICS_H
+
+#include <stdio.h>
+#include <time.h>
+
+#include "compiler_pass.h"
+#include "symbol.h"
+#include "tac.h"
+
+typedef enum compiler_statistics_format {
+    compiler_statistics_text,
+    // A single line holding one JSON object
+    compiler_statistics_json
+} compiler_statistics_format_t;
+
+typedef struct pass_time {
+    double wall_milliseconds;
+    // CPU time of the thread running the compilation, back end worker
+    // threads are not included
+    double cpu_milliseconds;
+} pass_time_t;
+
+typedef struct compiler_statistics {
+    pass_time_t passes[compiler_pass_count];
+    size_t tokens;
+    size_t ast_nodes;
+    size_t symbols[SYMBOL_TYPE_COUNT];
+    size_t tacs[TAC_TYPE_COUNT];
+    size_t temps;
+    size_t labels;
+    size_t literals;
+    // Instructions the optimizer computed at compile time, and conditional
+    // jumps it resolved
+    size_t folded_constants;
+    size_t folded_branches;
+    // Operations replaced by a move of the same operation computed earlier
+    size_t reused_expressions;
+    // Moves whose destination is now written directly, or whose readers
+    // now read the source
+    size_t eliminated_moves;
+    // Jumps sent past jumps to their final label, and blocks moved after
+    // the only jump to them
+    size_t threaded_jumps;
+    size_t merged_blocks;
+    // Unreachable or dead instructions, unneeded jumps and labels, and
+    // unused declarations
+    size_t removed_instructions;
+    // Zero when nothing is written or the output can't tell its position
+    size_t output_bytes;
+} compiler_statistics_t;
+
+typedef struct pass_timer {
+    compiler_pass_t pass;
+    struct timespec wall;
+    struct timespec cpu;
+} pass_timer_t;
+
+compiler_statistics_t new_compiler_statistics();
+
+// Allocations of this thread are charged to the pass until the timer stops
+pass_timer_t start_pass_timer(compiler_pass_t pass);
+
+// Adds the time since the timer started to its pass
+void stop_pass_timer(compiler_statistics_t* statistics, const pass_timer_t* timer);
+
+void print_compiler_statistics(FILE* stream, const compiler_statistics_t* statistics,
+                               compiler_statistics_format_t format);
+
+#endif
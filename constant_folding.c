@@ -0,0 +1,439 @@
+#include "constant_folding.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocation.h"
+#include "code_generator.h"
+#include "optimizer.h"
+
+typedef struct constant {
+    bool known;
+    int32_t value;
+    // Whether a block constant is in block_symbols
+    bool listed;
+} constant_t;
+
+typedef struct constant_folder {
+    compilation_context_t* context;
+    tac_buffer_t* buffer;
+    // Function being folded, which names its literals
+    symbol_t* function;
+    // Values that hold wherever the symbol is read: literals, globals
+    // nothing writes and temporaries, indexed by symbol id
+    constant_t* constants;
+    // Values moved into variables earlier in the current basic block
+    constant_t* block_constants;
+    // Symbols with a block constant, forgotten when the block ends
+    symbol_t** block_symbols;
+    size_t block_symbol_count;
+    size_t capacity;
+} constant_folder_t;
+
+void find_program_constants(constant_folder_t* folder);
+
+void fold_function_constants(constant_folder_t* folder, tac_function_range_t range);
+
+void fold_operation(constant_folder_t* folder, tac_id_t id);
+
+void fold_move(constant_folder_t* folder, tac_id_t id);
+
+void fold_jump_false(constant_folder_t* folder, tac_id_t id);
+
+void replace_known_operand(constant_folder_t* folder, tac_id_t id, tac_operand_t operand);
+
+bool evaluate_constant_operation(const tac_t* tac, int32_t first, int32_t second, int32_t* result);
+
+bool lookup_constant(const constant_folder_t* folder, const symbol_t* symbol, int32_t* value);
+
+void set_constant(constant_folder_t* folder, symbol_t* symbol, int32_t value);
+
+void forget_constant(constant_folder_t* folder, symbol_t* symbol);
+
+void forget_block_constants(constant_folder_t* folder);
+
+void forget_clobbered_constants(constant_folder_t* folder);
+
+void reserve_constants(constant_folder_t* folder);
+
+symbol_t* make_constant_literal(constant_folder_t* folder, data_type_t data_type, int32_t value);
+
+int32_t literal_constant_value(const symbol_t* literal);
+
+int32_t convert_constant(int32_t value, data_type_t from, data_type_t to);
+
+bool is_integer_data_type(data_type_t data_type);
+
+static const char* constant_type_names[] = {
+    [data_type_int] = "int",
+    [data_type_char] = "char",
+    [data_type_bool] = "bool"
+};
+
+
+void fold_constants(compilation_context_t* context, tac_buffer_t* buffer) {
+    constant_folder_t folder;
+    folder.context = context;
+    folder.buffer = buffer;
+    folder.function = NULL;
+    folder.constants = NULL;
+    folder.block_constants = NULL;
+    folder.block_symbols = NULL;
+    folder.block_symbol_count = 0;
+    folder.capacity = 0;
+    reserve_constants(&folder);
+
+    find_program_constants(&folder);
+    for(size_t i = 0; i < tac_buffer_function_count(buffer); i++) {
+        fold_function_constants(&folder, tac_buffer_function(buffer, i));
+    }
+
+    release(allocation_constant_folding, folder.constants);
+    release(allocation_constant_folding, folder.block_constants);
+    release(allocation_constant_folding, folder.block_symbols);
+}
+
+
+// Literals and globals initialized with an integer or char literal and
+// never written
+void find_program_constants(constant_folder_t* folder) {
+    tac_buffer_t* buffer = folder->buffer;
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        if(tac->type != tac_init || tac->op2 != NOP || !is_integer_data_type(tac->res->data_type)) {
+            continue;
+        }
+        if(tac->op1->type != symbol_int_literal && tac->op1->type != symbol_char_literal) {
+            continue;
+        }
+        bool is_literal = tac->res->type == symbol_label;
+        bool is_constant_global = tac->res->type == symbol_variable &&
+                                  tac_buffer_definition_count(buffer, tac->res) == 0;
+        if(is_literal || is_constant_global) {
+            data_type_t literal_type = tac->op1->type == symbol_char_literal ? data_type_char : data_type_int;
+            folder->constants[tac->res->id].known = true;
+            folder->constants[tac->res->id].value = convert_constant(literal_constant_value(tac->op1),
+                                                                     literal_type, tac->res->data_type);
+        }
+    }
+}
+
+
+// A single pass in program order: labels start a basic block, and calls
+// forget what they may clobber
+void fold_function_constants(constant_folder_t* folder, tac_function_range_t range) {
+    tac_buffer_t* buffer = folder->buffer;
+    folder->function = range.function;
+    forget_block_constants(folder);
+
+    tac_id_t next;
+    for(tac_id_t id = range.begin; id != TAC_ID_NONE && id != range.end; id = next) {
+        next = tac_buffer_next(buffer, id);
+        tac_t* tac = tac_buffer_get(buffer, id);
+        switch(tac->type) {
+            case tac_label:
+                forget_block_constants(folder);
+                break;
+            case tac_sum:
+            case tac_sub:
+            case tac_mul:
+            case tac_div:
+            case tac_eq:
+            case tac_dif:
+            case tac_gt:
+            case tac_ge:
+            case tac_lt:
+            case tac_le:
+                fold_operation(folder, id);
+                break;
+            case tac_move:
+                fold_move(folder, id);
+                break;
+            case tac_jump_false:
+                fold_jump_false(folder, id);
+                break;
+            case tac_call:
+                forget_clobbered_constants(folder);
+                forget_constant(folder, tac->res);
+                break;
+            case tac_argument:
+            case tac_print:
+            case tac_return:
+                replace_known_operand(folder, id, tac_operand_res);
+                break;
+            case tac_vector_move:
+                replace_known_operand(folder, id, tac_operand_op1);
+                replace_known_operand(folder, id, tac_operand_op2);
+                break;
+            case tac_vector_index:
+                replace_known_operand(folder, id, tac_operand_op2);
+                forget_constant(folder, tac_buffer_get(buffer, id)->res);
+                break;
+            default:
+                if(tac_operand_is_definition(tac->type, tac_operand_res)) {
+                    forget_constant(folder, tac->res);
+                }
+                break;
+        }
+    }
+}
+
+
+void fold_operation(constant_folder_t* folder, tac_id_t id) {
+    replace_known_operand(folder, id, tac_operand_op1);
+    replace_known_operand(folder, id, tac_operand_op2);
+
+    tac_t* tac = tac_buffer_get(folder->buffer, id);
+    int32_t first;
+    int32_t second;
+    int32_t result;
+    if(!lookup_constant(folder, tac->op1, &first) || !lookup_constant(folder, tac->op2, &second) ||
+       !evaluate_constant_operation(tac, first, second, &result)) {
+        forget_constant(folder, tac->res);
+        return;
+    }
+
+    symbol_t* literal = make_constant_literal(folder, tac->res->data_type, result);
+    tac = tac_buffer_get(folder->buffer, id);
+    tac->type = tac_move;
+    tac->op1 = literal;
+    tac->op2 = NOP;
+    set_constant(folder, tac->res, result);
+    folder->context->statistics.folded_constants++;
+}
+
+
+// Bools only convert to bools in the back end
+void fold_move(constant_folder_t* folder, tac_id_t id) {
+    replace_known_operand(folder, id, tac_operand_op1);
+
+    tac_t* tac = tac_buffer_get(folder->buffer, id);
+    data_type_t from = tac->op1->data_type;
+    data_type_t to = tac->res->data_type;
+    int32_t value;
+    if(lookup_constant(folder, tac->op1, &value) &&
+       (from == to || (is_integer_data_type(from) && is_integer_data_type(to)))) {
+        set_constant(folder, tac->res, convert_constant(value, from, to));
+    } else {
+        forget_constant(folder, tac->res);
+    }
+}
+
+
+void fold_jump_false(constant_folder_t* folder, tac_id_t id) {
+    tac_t* tac = tac_buffer_get(folder->buffer, id);
+    int32_t condition;
+    if(!lookup_constant(folder, tac->op1, &condition)) {
+        return;
+    }
+    if(condition == 0) {
+        tac->type = tac_jump;
+        tac->op1 = NOP;
+    } else {
+        tac_buffer_remove(folder->buffer, id);
+    }
+    folder->context->statistics.folded_branches++;
+}
+
+
+// Literals are read as they are, there is nothing to gain
+void replace_known_operand(constant_folder_t* folder, tac_id_t id, tac_operand_t operand) {
+    symbol_t* symbol = tac_get_operand(tac_buffer_get(folder->buffer, id), operand);
+    int32_t value;
+    if(symbol == NOP || symbol->type == symbol_label || !lookup_constant(folder, symbol, &value)) {
+        return;
+    }
+    symbol_t* literal = make_constant_literal(folder, symbol->data_type, value);
+    tac_set_operand(tac_buffer_get(folder->buffer, id), operand, literal);
+}
+
+
+// Operands are converted to the type of the result like the back end does,
+// and compared as ints. Divisions that would trap are left to run time.
+bool evaluate_constant_operation(const tac_t* tac, int32_t first, int32_t second, int32_t* result) {
+    bool is_comparison = tac->type >= tac_eq && tac->type <= tac_le;
+    data_type_t first_type = tac->op1->data_type;
+    data_type_t second_type = tac->op2->data_type;
+    data_type_t result_type = is_comparison ? data_type_int : tac->res->data_type;
+    if(!is_integer_data_type(first_type) || !is_integer_data_type(second_type) ||
+       !is_integer_data_type(result_type)) {
+        return false;
+    }
+    int64_t a = convert_constant(first, first_type, result_type);
+    int64_t b = convert_constant(second, second_type, result_type);
+    int64_t value;
+    switch(tac->type) {
+        case tac_sum: value = a + b; break;
+        case tac_sub: value = a - b; break;
+        case tac_mul: value = a * b; break;
+        case tac_div:
+            if(b == 0 || (a == INT32_MIN && b == -1)) {
+                return false;
+            }
+            value = a / b;
+            break;
+        case tac_eq: value = a == b; break;
+        case tac_dif: value = a != b; break;
+        case tac_gt: value = a > b; break;
+        case tac_ge: value = a >= b; break;
+        case tac_lt: value = a < b; break;
+        case tac_le: value = a <= b; break;
+        default: return false;
+    }
+    *result = is_comparison ? (int32_t)value
+                                  : convert_constant((int32_t)(uint32_t)value, data_type_int, result_type);
+    return true;
+}
+
+
+bool lookup_constant(const constant_folder_t* folder, const symbol_t* symbol, int32_t* value) {
+    if(symbol == NOP || symbol->id >= folder->capacity) {
+        return false;
+    }
+    const constant_t* constant = &folder->constants[symbol->id];
+    if(!constant->known) {
+        constant = &folder->block_constants[symbol->id];
+    }
+    if(constant->known) {
+        *value = constant->value;
+    }
+    return constant->known;
+}
+
+
+// Temporaries are written once, before any read, so their value holds
+// everywhere
+void set_constant(constant_folder_t* folder, symbol_t* symbol, int32_t value) {
+    if(is_temp(symbol) && tac_buffer_definition_count(folder->buffer, symbol) == 1) {
+        folder->constants[symbol->id].known = true;
+        folder->constants[symbol->id].value = value;
+        return;
+    }
+    constant_t* constant = &folder->block_constants[symbol->id];
+    if(!constant->listed) {
+        folder->block_symbols[folder->block_symbol_count++] = symbol;
+        constant->listed = true;
+    }
+    constant->known = true;
+    constant->value = value;
+}
+
+
+void forget_constant(constant_folder_t* folder, symbol_t* symbol) {
+    if(symbol->id < folder->capacity) {
+        folder->block_constants[symbol->id].known = false;
+    }
+}
+
+
+void forget_block_constants(constant_folder_t* folder) {
+    for(size_t i = 0; i < folder->block_symbol_count; i++) {
+        folder->block_constants[folder->block_symbols[i]->id].known = false;
+        folder->block_constants[folder->block_symbols[i]->id].listed = false;
+    }
+    folder->block_symbol_count = 0;
+}
+
+
+void forget_clobbered_constants(constant_folder_t* folder) {
+    size_t kept = 0;
+    for(size_t i = 0; i < folder->block_symbol_count; i++) {
+        symbol_t* symbol = folder->block_symbols[i];
+        if(tac_call_clobbers(symbol)) {
+            folder->block_constants[symbol->id].known = false;
+            folder->block_constants[symbol->id].listed = false;
+        } else {
+            folder->block_symbols[kept++] = symbol;
+        }
+    }
+    folder->block_symbol_count = kept;
+}
+
+
+// The arrays grow with the symbol table as literals are created
+void reserve_constants(constant_folder_t* folder) {
+    size_t symbols = symbol_table_size(folder->context->symbol_table);
+    if(symbols <= folder->capacity) {
+        return;
+    }
+    size_t capacity = folder->capacity > 0 ? folder->capacity : 64;
+    while(capacity < symbols) {
+        capacity *= 2;
+    }
+    folder->constants = reallocate(allocation_constant_folding, folder->constants,
+                                   capacity * sizeof(constant_t));
+    folder->block_constants = reallocate(allocation_constant_folding, folder->block_constants,
+                                         capacity * sizeof(constant_t));
+    folder->block_symbols = reallocate(allocation_constant_folding, folder->block_symbols,
+                                       capacity * sizeof(symbol_t*));
+    for(size_t i = folder->capacity; i < capacity; i++) {
+        folder->constants[i].known = false;
+        folder->block_constants[i].known = false;
+        folder->block_constants[i].listed = false;
+    }
+    folder->capacity = capacity;
+}
+
+
+// Named .<function>.<type>.<value>, with negative values written as
+// neg<magnitude>, and initialized once for the whole program
+symbol_t* make_constant_literal(constant_folder_t* folder, data_type_t data_type, int32_t value) {
+    symbol_table_t* st = folder->context->symbol_table;
+    const char* function = folder->function->value;
+    long long magnitude = value < 0 ? -(long long)value : value;
+    const char* sign = value < 0 ? "neg" : "";
+    int length = snprintf(NULL, 0, ".%s.%s.%s%lld", function, constant_type_names[data_type], sign, magnitude);
+    char* name = allocate(allocation_string, length + 1);
+    snprintf(name, length + 1, ".%s.%s.%s%lld", function, constant_type_names[data_type], sign, magnitude);
+
+    symbol_t* literal = symbol_table_lookup(st, name, length, SYMBOL_SCOPE_GLOBAL);
+    if(literal == NULL) {
+        literal = symbol_table_add(st, name, symbol_label, 0);
+        literal->data_type = data_type;
+
+        char text[16];
+        snprintf(text, sizeof(text), "%d", value);
+        symbol_t* constant = symbol_table_add(st, text, symbol_int_literal, 0);
+        constant->data_type = data_type_int;
+
+        tac_t init = { tac_init, literal, constant, NOP };
+        tac_buffer_insert_before(folder->buffer, tac_buffer_first(folder->buffer), init);
+        folder->context->statistics.literals++;
+
+        reserve_constants(folder);
+        folder->constants[literal->id].known = true;
+        folder->constants[literal->id].value = value;
+    }
+    release(allocation_string, name);
+    return literal;
+}
+
+
+// Integers wrap to 32 bits like in the machine
+int32_t literal_constant_value(const symbol_t* literal) {
+    if(literal->type == symbol_char_literal) {
+        return (unsigned char)literal->value[1];
+    }
+    return (int32_t)(uint32_t)strtoull(literal->value, NULL, 10);
+}
+
+
+// Chars are kept as the byte stored, and widened with their sign like the
+// back end does
+int32_t convert_constant(int32_t value, data_type_t from, data_type_t to) {
+    switch(to) {
+        case data_type_char:
+            return (uint8_t)value;
+        case data_type_bool:
+            return value != 0;
+        default:
+            return from == data_type_char ? (int8_t)value : value;
+    }
+}
+
+
+bool is_integer_data_type(data_type_t data_type) {
+    return data_type == data_type_int || data_type == data_type_char;
+}
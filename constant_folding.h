@@ -0,0 +1,21 @@
+#ifndef CONSTANT_FOLDING_H
+#define CONSTANT_FOLDING_H
+
+#include "compilation_context.h"
+#include "tac_buffer.h"
+
+/*
+ * Computes at compile time the arithmetic and comparisons whose operands
+ * are known: literals, globals initialized with a literal that nothing
+ * writes, and values moved into variables earlier in the same basic block.
+ * Folded instructions become moves of a literal, operands with a known
+ * value read a literal instead, and conditional jumps on a known condition
+ * become jumps or are removed. Values follow the conversions of the back
+ * end, with chars and ints wrapping like the machine does.
+ *
+ * The def-use chains of the buffer must be built. Literals are created as
+ * needed, named after the function and their value.
+ */
+void fold_constants(compilation_context_t* context, tac_buffer_t* buffer);
+
+#endif
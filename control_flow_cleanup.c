@@ -0,0 +1,257 @@
+#include "control_flow_cleanup.h"
+
+#include <stdlib.h>
+
+#include "control_flow_graph.h"
+
+typedef struct control_flow_cleaner {
+    compilation_context_t* context;
+    tac_buffer_t* buffer;
+    // Jumps to each label, by symbol id
+    size_t* label_references;
+} control_flow_cleaner_t;
+
+void clean_function_control_flow(control_flow_cleaner_t* cleaner, tac_function_range_t range);
+
+bool thread_jumps(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph);
+
+size_t final_jump_target(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph, size_t target);
+
+bool remove_unreachable_blocks(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph);
+
+bool remove_jumps_to_next_block(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph);
+
+bool remove_unused_block_labels(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph);
+
+bool merge_block_chains(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph);
+
+void remove_basic_block(control_flow_cleaner_t* cleaner, const basic_block_t* block);
+
+bool is_forwarding_block(control_flow_cleaner_t* cleaner, const basic_block_t* block);
+
+bool is_jump(const tac_t* tac);
+
+
+void clean_control_flow(compilation_context_t* context, tac_buffer_t* buffer) {
+    control_flow_cleaner_t cleaner;
+    cleaner.context = context;
+    cleaner.buffer = buffer;
+    cleaner.label_references = calloc(symbol_table_size(context->symbol_table), sizeof(size_t));
+    size_t size = tac_buffer_size(buffer);
+
+    for(size_t i = 0; i < tac_buffer_function_count(buffer); i++) {
+        clean_function_control_flow(&cleaner, tac_buffer_function(buffer, i));
+    }
+
+    context->statistics.removed_instructions += size - tac_buffer_size(buffer);
+    free(cleaner.label_references);
+}
+
+
+// Every step changes the edges, so the graph is built again after one
+// changes anything, until none does
+void clean_function_control_flow(control_flow_cleaner_t* cleaner, tac_function_range_t range) {
+    bool changed = true;
+    while(changed) {
+        control_flow_graph_t* graph = new_control_flow_graph(cleaner->buffer, range);
+        changed = thread_jumps(cleaner, graph) ||
+                  remove_unreachable_blocks(cleaner, graph) ||
+                  remove_jumps_to_next_block(cleaner, graph) ||
+                  remove_unused_block_labels(cleaner, graph) ||
+                  merge_block_chains(cleaner, graph);
+        delete_control_flow_graph(graph);
+    }
+}
+
+
+// Jumps go to the first label of the final block, so the other labels of
+// a block end up unused
+bool thread_jumps(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph) {
+    bool changed = false;
+    for(size_t i = 0; i < control_flow_graph_size(graph); i++) {
+        tac_t* jump = tac_buffer_get(cleaner->buffer, control_flow_graph_block(graph, i)->last);
+        if(!is_jump(jump)) {
+            continue;
+        }
+        size_t target = control_flow_graph_label_block(graph, jump->res);
+        if(target == BASIC_BLOCK_NONE) {
+            continue;
+        }
+        target = final_jump_target(cleaner, graph, target);
+        symbol_t* label = tac_buffer_get(cleaner->buffer, control_flow_graph_block(graph, target)->first)->res;
+        if(label != jump->res) {
+            jump->res = label;
+            cleaner->context->statistics.threaded_jumps++;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+
+// Stops after as many jumps as there are blocks, which only happens in a
+// loop of jumps
+size_t final_jump_target(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph, size_t target) {
+    for(size_t jumps = 0; jumps < control_flow_graph_size(graph); jumps++) {
+        const basic_block_t* block = control_flow_graph_block(graph, target);
+        if(!is_forwarding_block(cleaner, block)) {
+            break;
+        }
+        tac_t* jump = tac_buffer_get(cleaner->buffer, block->last);
+        size_t next = control_flow_graph_label_block(graph, jump->res);
+        if(next == BASIC_BLOCK_NONE) {
+            break;
+        }
+        target = next;
+    }
+    return target;
+}
+
+
+bool remove_unreachable_blocks(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph) {
+    size_t size = control_flow_graph_size(graph);
+    if(size == 0) {
+        return false;
+    }
+    bool* reachable = calloc(size, sizeof(bool));
+    size_t* work = malloc(size * sizeof(size_t));
+    size_t work_count = 0;
+    reachable[0] = true;
+    work[work_count++] = 0;
+    while(work_count > 0) {
+        const basic_block_t* block = control_flow_graph_block(graph, work[--work_count]);
+        for(size_t i = 0; i < block->successor_count; i++) {
+            if(!reachable[block->successors[i]]) {
+                reachable[block->successors[i]] = true;
+                work[work_count++] = block->successors[i];
+            }
+        }
+    }
+
+    bool changed = false;
+    for(size_t i = 0; i < size; i++) {
+        if(!reachable[i]) {
+            remove_basic_block(cleaner, control_flow_graph_block(graph, i));
+            changed = true;
+        }
+    }
+    free(reachable);
+    free(work);
+    return changed;
+}
+
+
+bool remove_jumps_to_next_block(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph) {
+    bool changed = false;
+    for(size_t i = 0; i + 1 < control_flow_graph_size(graph); i++) {
+        const basic_block_t* block = control_flow_graph_block(graph, i);
+        tac_t* jump = tac_buffer_get(cleaner->buffer, block->last);
+        if(is_jump(jump) && control_flow_graph_label_block(graph, jump->res) == i + 1) {
+            tac_buffer_remove(cleaner->buffer, block->last);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+
+// Jumps only end blocks, so they are all found at the end of one
+bool remove_unused_block_labels(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph) {
+    tac_buffer_t* buffer = cleaner->buffer;
+    size_t size = control_flow_graph_size(graph);
+    for(size_t i = 0; i < size; i++) {
+        tac_t* jump = tac_buffer_get(buffer, control_flow_graph_block(graph, i)->last);
+        if(is_jump(jump)) {
+            cleaner->label_references[jump->res->id]++;
+        }
+    }
+
+    bool changed = false;
+    for(size_t i = 0; i < size; i++) {
+        const basic_block_t* block = control_flow_graph_block(graph, i);
+        for(tac_id_t id = block->first; tac_buffer_get(buffer, id)->type == tac_label; id = tac_buffer_next(buffer, id)) {
+            if(cleaner->label_references[tac_buffer_get(buffer, id)->res->id] == 0) {
+                tac_buffer_remove(buffer, id);
+                changed = true;
+            }
+            if(id == block->last) {
+                break;
+            }
+        }
+    }
+
+    for(size_t i = 0; i < size; i++) {
+        tac_t* jump = tac_buffer_get(buffer, control_flow_graph_block(graph, i)->last);
+        if(is_jump(jump)) {
+            cleaner->label_references[jump->res->id] = 0;
+        }
+    }
+    return changed;
+}
+
+
+// The moved block ends with a jump or a return, and its only predecessor
+// is the jump, so nothing fell through into it or out of it. Its labels
+// are left for the next round to remove.
+bool merge_block_chains(control_flow_cleaner_t* cleaner, const control_flow_graph_t* graph) {
+    size_t size = control_flow_graph_size(graph);
+    bool* merged = calloc(size > 0 ? size : 1, sizeof(bool));
+    bool changed = false;
+    for(size_t i = 0; i < size; i++) {
+        const basic_block_t* block = control_flow_graph_block(graph, i);
+        tac_t* jump = tac_buffer_get(cleaner->buffer, block->last);
+        if(jump->type != tac_jump) {
+            continue;
+        }
+        size_t target = control_flow_graph_label_block(graph, jump->res);
+        if(target == BASIC_BLOCK_NONE || target == 0 || target == i || merged[i] || merged[target]) {
+            continue;
+        }
+        const basic_block_t* target_block = control_flow_graph_block(graph, target);
+        tac_type_t target_end = tac_buffer_get(cleaner->buffer, target_block->last)->type;
+        if(target_block->predecessor_count != 1 || (target_end != tac_jump && target_end != tac_return)) {
+            continue;
+        }
+
+        tac_buffer_move_after(cleaner->buffer, target_block->first, target_block->last, block->last);
+        tac_buffer_remove(cleaner->buffer, block->last);
+        merged[i] = true;
+        merged[target] = true;
+        cleaner->context->statistics.merged_blocks++;
+        changed = true;
+    }
+    free(merged);
+    return changed;
+}
+
+
+void remove_basic_block(control_flow_cleaner_t* cleaner, const basic_block_t* block) {
+    tac_id_t id = block->first;
+    while(true) {
+        tac_id_t next = tac_buffer_next(cleaner->buffer, id);
+        tac_buffer_remove(cleaner->buffer, id);
+        if(id == block->last) {
+            break;
+        }
+        id = next;
+    }
+}
+
+
+// Labels followed by a jump
+bool is_forwarding_block(control_flow_cleaner_t* cleaner, const basic_block_t* block) {
+    if(tac_buffer_get(cleaner->buffer, block->last)->type != tac_jump) {
+        return false;
+    }
+    for(tac_id_t id = block->first; id != block->last; id = tac_buffer_next(cleaner->buffer, id)) {
+        if(tac_buffer_get(cleaner->buffer, id)->type != tac_label) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool is_jump(const tac_t* tac) {
+    return tac->type == tac_jump || tac->type == tac_jump_false;
+}
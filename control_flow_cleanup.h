@@ -0,0 +1,17 @@
+#ifndef CONTROL_FLOW_CLEANUP_H
+#define CONTROL_FLOW_CLEANUP_H
+
+#include "compilation_context.h"
+#include "tac_buffer.h"
+
+/*
+ * Simplifies the control flow graph of each function. Jumps to a jump, or
+ * to a label sharing its block with others, go straight to the final
+ * label. Blocks control never reaches are removed, and so are jumps to the
+ * next block and labels nothing jumps to, which merges straight line
+ * blocks. A block reached only by a jump from another, and that does not
+ * fall through, is moved after that jump, which is removed.
+ */
+void clean_control_flow(compilation_context_t* context, tac_buffer_t* buffer);
+
+#endif
@@ -0,0 +1,159 @@
+#include "control_flow_graph.h"
+
+#include <stdlib.h>
+
+typedef struct label_block {
+    const symbol_t* label;
+    size_t block;
+} label_block_t;
+
+struct control_flow_graph {
+    basic_block_t* blocks;
+    size_t block_count;
+    // Sorted by label, for bsearch
+    label_block_t* labels;
+    size_t label_count;
+    size_t* predecessors;
+};
+
+void find_basic_blocks(control_flow_graph_t* graph, tac_buffer_t* buffer, tac_function_range_t range);
+
+void add_basic_block_edges(control_flow_graph_t* graph, tac_buffer_t* buffer);
+
+void add_basic_block_predecessors(control_flow_graph_t* graph);
+
+bool ends_basic_block(tac_type_t type);
+
+int compare_label_blocks(const void* first, const void* second);
+
+
+control_flow_graph_t* new_control_flow_graph(tac_buffer_t* buffer, tac_function_range_t range) {
+    control_flow_graph_t* graph = malloc(sizeof(control_flow_graph_t));
+    graph->blocks = NULL;
+    graph->block_count = 0;
+    graph->labels = NULL;
+    graph->label_count = 0;
+    graph->predecessors = NULL;
+
+    find_basic_blocks(graph, buffer, range);
+    qsort(graph->labels, graph->label_count, sizeof(label_block_t), &compare_label_blocks);
+    add_basic_block_edges(graph, buffer);
+    add_basic_block_predecessors(graph);
+    return graph;
+}
+
+
+void delete_control_flow_graph(control_flow_graph_t* graph) {
+    free(graph->blocks);
+    free(graph->labels);
+    free(graph->predecessors);
+    free(graph);
+}
+
+
+size_t control_flow_graph_size(const control_flow_graph_t* graph) {
+    return graph->block_count;
+}
+
+
+const basic_block_t* control_flow_graph_block(const control_flow_graph_t* graph, size_t index) {
+    return &graph->blocks[index];
+}
+
+
+size_t control_flow_graph_label_block(const control_flow_graph_t* graph, const symbol_t* label) {
+    label_block_t key = { label, BASIC_BLOCK_NONE };
+    const label_block_t* found = bsearch(&key, graph->labels, graph->label_count, sizeof(label_block_t),
+                                         &compare_label_blocks);
+    return found != NULL ? found->block : BASIC_BLOCK_NONE;
+}
+
+
+// The arrays are sized for every instruction being a block and a label
+void find_basic_blocks(control_flow_graph_t* graph, tac_buffer_t* buffer, tac_function_range_t range) {
+    size_t count = 0;
+    for(tac_id_t id = tac_buffer_next(buffer, range.begin); id != TAC_ID_NONE && id != range.end;
+        id = tac_buffer_next(buffer, id)) {
+        count++;
+    }
+    graph->blocks = malloc((count > 0 ? count : 1) * sizeof(basic_block_t));
+    graph->labels = malloc((count > 0 ? count : 1) * sizeof(label_block_t));
+
+    bool starts_block = true;
+    bool follows_label = false;
+    for(tac_id_t id = tac_buffer_next(buffer, range.begin); id != TAC_ID_NONE && id != range.end;
+        id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        if(starts_block || (tac->type == tac_label && !follows_label)) {
+            basic_block_t* block = &graph->blocks[graph->block_count++];
+            block->first = id;
+            block->successor_count = 0;
+            block->predecessors = NULL;
+            block->predecessor_count = 0;
+        }
+        graph->blocks[graph->block_count - 1].last = id;
+        if(tac->type == tac_label) {
+            label_block_t* label = &graph->labels[graph->label_count++];
+            label->label = tac->res;
+            label->block = graph->block_count - 1;
+        }
+        starts_block = ends_basic_block(tac->type);
+        follows_label = tac->type == tac_label;
+    }
+}
+
+
+// Jumps to labels outside the function have no edge
+void add_basic_block_edges(control_flow_graph_t* graph, tac_buffer_t* buffer) {
+    for(size_t i = 0; i < graph->block_count; i++) {
+        basic_block_t* block = &graph->blocks[i];
+        tac_t* last = tac_buffer_get(buffer, block->last);
+        if(last->type != tac_jump && last->type != tac_return && i + 1 < graph->block_count) {
+            block->successors[block->successor_count++] = i + 1;
+        }
+        if(last->type == tac_jump || last->type == tac_jump_false) {
+            size_t target = control_flow_graph_label_block(graph, last->res);
+            if(target != BASIC_BLOCK_NONE) {
+                block->successors[block->successor_count++] = target;
+            }
+        }
+    }
+}
+
+
+// A jump_false to the next block gives it the same predecessor twice
+void add_basic_block_predecessors(control_flow_graph_t* graph) {
+    size_t edges = 0;
+    for(size_t i = 0; i < graph->block_count; i++) {
+        for(size_t j = 0; j < graph->blocks[i].successor_count; j++) {
+            graph->blocks[graph->blocks[i].successors[j]].predecessor_count++;
+            edges++;
+        }
+    }
+    graph->predecessors = malloc((edges > 0 ? edges : 1) * sizeof(size_t));
+
+    size_t offset = 0;
+    for(size_t i = 0; i < graph->block_count; i++) {
+        graph->blocks[i].predecessors = graph->predecessors + offset;
+        offset += graph->blocks[i].predecessor_count;
+        graph->blocks[i].predecessor_count = 0;
+    }
+    for(size_t i = 0; i < graph->block_count; i++) {
+        for(size_t j = 0; j < graph->blocks[i].successor_count; j++) {
+            basic_block_t* successor = &graph->blocks[graph->blocks[i].successors[j]];
+            successor->predecessors[successor->predecessor_count++] = i;
+        }
+    }
+}
+
+
+bool ends_basic_block(tac_type_t type) {
+    return type == tac_jump || type == tac_jump_false || type == tac_return;
+}
+
+
+int compare_label_blocks(const void* first, const void* second) {
+    const symbol_t* first_label = ((const label_block_t*)first)->label;
+    const symbol_t* second_label = ((const label_block_t*)second)->label;
+    return first_label < second_label ? -1 : first_label > second_label;
+}
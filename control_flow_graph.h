@@ -0,0 +1,42 @@
+#ifndef CONTROL_FLOW_GRAPH_H
+#define CONTROL_FLOW_GRAPH_H
+
+#include "tac_buffer.h"
+
+/*
+ * Basic blocks of a function, in program order, and the edges between
+ * them. A block starts after tac_begin_function, at a label following any
+ * other instruction, and after a jump or a return, so consecutive labels
+ * start a single block. The first block is the entry of the function.
+ *
+ * The graph describes the buffer when it was built and is not updated by
+ * later changes to it.
+ */
+
+typedef struct control_flow_graph control_flow_graph_t;
+
+#define BASIC_BLOCK_NONE ((size_t)-1)
+
+typedef struct basic_block {
+    tac_id_t first;
+    tac_id_t last;
+    // The next block comes first when control may fall through to it, then
+    // the target of a jump
+    size_t successors[2];
+    size_t successor_count;
+    size_t* predecessors;
+    size_t predecessor_count;
+} basic_block_t;
+
+control_flow_graph_t* new_control_flow_graph(tac_buffer_t* buffer, tac_function_range_t range);
+
+void delete_control_flow_graph(control_flow_graph_t* graph);
+
+size_t control_flow_graph_size(const control_flow_graph_t* graph);
+
+const basic_block_t* control_flow_graph_block(const control_flow_graph_t* graph, size_t index);
+
+// BASIC_BLOCK_NONE when no label of the function has the symbol
+size_t control_flow_graph_label_block(const control_flow_graph_t* graph, const symbol_t* label);
+
+#endif
@@ -0,0 +1,267 @@
+#include "copy_propagation.h"
+
+#include <stdlib.h>
+
+#include "code_generator.h"
+#include "optimizer.h"
+
+typedef struct copy {
+    // Block the copy was made in, it is unknown in other blocks
+    size_t block;
+    // Calls made in the block before the copy
+    size_t calls;
+    symbol_t* source;
+    // Writes to the source when the copy was made
+    size_t source_version;
+} copy_t;
+
+typedef struct copy_propagator {
+    compilation_context_t* context;
+    tac_buffer_t* buffer;
+    size_t symbol_count;
+    // Indexed by symbol id
+    size_t* uses;
+    tac_id_t* definitions;
+    // Positions count the instructions of the program from 1, and tell
+    // whether one instruction comes after another
+    size_t* definition_positions;
+    size_t* last_references;
+    copy_t* copies;
+    size_t* versions;
+    size_t block;
+    size_t calls;
+} copy_propagator_t;
+
+void coalesce_function_moves(copy_propagator_t* propagator, tac_function_range_t range, size_t* position);
+
+bool coalesce_move(copy_propagator_t* propagator, tac_id_t id, size_t barrier);
+
+void forward_function_copies(copy_propagator_t* propagator, tac_function_range_t range);
+
+void forward_copy(copy_propagator_t* propagator, tac_id_t id, tac_operand_t operand);
+
+void remove_unused_copies(copy_propagator_t* propagator);
+
+void count_copy_uses(copy_propagator_t* propagator);
+
+bool writes_data_type(tac_type_t type, data_type_t data_type);
+
+bool ends_straight_line(tac_type_t type);
+
+
+void propagate_copies(compilation_context_t* context, tac_buffer_t* buffer) {
+    copy_propagator_t propagator;
+    propagator.context = context;
+    propagator.buffer = buffer;
+    propagator.symbol_count = symbol_table_size(context->symbol_table);
+    propagator.uses = malloc(propagator.symbol_count * sizeof(size_t));
+    propagator.definitions = malloc(propagator.symbol_count * sizeof(tac_id_t));
+    propagator.definition_positions = calloc(propagator.symbol_count, sizeof(size_t));
+    propagator.last_references = calloc(propagator.symbol_count, sizeof(size_t));
+    propagator.copies = calloc(propagator.symbol_count, sizeof(copy_t));
+    propagator.versions = calloc(propagator.symbol_count, sizeof(size_t));
+    propagator.block = 0;
+    propagator.calls = 0;
+    for(size_t i = 0; i < propagator.symbol_count; i++) {
+        propagator.definitions[i] = TAC_ID_NONE;
+    }
+
+    count_copy_uses(&propagator);
+    size_t position = 0;
+    for(size_t i = 0; i < tac_buffer_function_count(buffer); i++) {
+        coalesce_function_moves(&propagator, tac_buffer_function(buffer, i), &position);
+    }
+    for(size_t i = 0; i < tac_buffer_function_count(buffer); i++) {
+        forward_function_copies(&propagator, tac_buffer_function(buffer, i));
+    }
+    remove_unused_copies(&propagator);
+
+    free(propagator.uses);
+    free(propagator.definitions);
+    free(propagator.definition_positions);
+    free(propagator.last_references);
+    free(propagator.copies);
+    free(propagator.versions);
+}
+
+
+// Labels, jumps and calls end the straight line code a definition may be
+// moved across
+void coalesce_function_moves(copy_propagator_t* propagator, tac_function_range_t range, size_t* position) {
+    tac_buffer_t* buffer = propagator->buffer;
+    size_t barrier = ++*position;
+    for(tac_id_t id = range.begin; id != TAC_ID_NONE && id != range.end; id = tac_buffer_next(buffer, id)) {
+        ++*position;
+        if(coalesce_move(propagator, id, barrier)) {
+            continue;
+        }
+        tac_t* tac = tac_buffer_get(buffer, id);
+        for(tac_operand_t operand = tac_operand_res; operand <= tac_operand_op2; operand++) {
+            symbol_t* symbol = tac_get_operand(tac, operand);
+            if(symbol != NOP) {
+                propagator->last_references[symbol->id] = *position;
+            }
+        }
+        if(ends_straight_line(tac->type)) {
+            barrier = *position;
+        }
+        if(tac_operand_is_definition(tac->type, tac_operand_res) && is_temp(tac->res)) {
+            propagator->definitions[tac->res->id] = id;
+            propagator->definition_positions[tac->res->id] = *position;
+        }
+    }
+}
+
+
+// The definition writes the destination earlier than the move did, so
+// nothing in between may read or write it. A definition at the barrier is
+// the call ending the straight line code.
+bool coalesce_move(copy_propagator_t* propagator, tac_id_t id, size_t barrier) {
+    tac_t* move = tac_buffer_get(propagator->buffer, id);
+    if(move->type != tac_move || !is_temp(move->op1) || propagator->uses[move->op1->id] != 1) {
+        return false;
+    }
+    symbol_t* temp = move->op1;
+    symbol_t* destination = move->res;
+    tac_id_t definition_id = propagator->definitions[temp->id];
+    size_t definition_position = propagator->definition_positions[temp->id];
+    if(definition_id == TAC_ID_NONE || definition_position < barrier ||
+       propagator->last_references[destination->id] > definition_position) {
+        return false;
+    }
+    tac_t* definition = tac_buffer_get(propagator->buffer, definition_id);
+    if(temp->data_type != destination->data_type || !writes_data_type(definition->type, destination->data_type)) {
+        return false;
+    }
+
+    definition->res = destination;
+    tac_buffer_remove(propagator->buffer, id);
+    propagator->definitions[temp->id] = TAC_ID_NONE;
+    propagator->last_references[destination->id] = definition_position;
+    if(is_temp(destination)) {
+        propagator->definitions[destination->id] = definition_id;
+        propagator->definition_positions[destination->id] = definition_position;
+    }
+    propagator->context->statistics.eliminated_moves++;
+    return true;
+}
+
+
+void forward_function_copies(copy_propagator_t* propagator, tac_function_range_t range) {
+    tac_buffer_t* buffer = propagator->buffer;
+    propagator->block++;
+    for(tac_id_t id = range.begin; id != TAC_ID_NONE && id != range.end; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        if(tac->type == tac_label) {
+            propagator->block++;
+        } else if(tac->type == tac_call) {
+            propagator->calls++;
+        }
+        for(tac_operand_t operand = tac_operand_res; operand <= tac_operand_op2; operand++) {
+            if(tac_get_operand(tac, operand) != NOP && tac_operand_is_use(tac->type, operand)) {
+                forward_copy(propagator, id, operand);
+            }
+        }
+        if(!tac_operand_is_definition(tac->type, tac_operand_res)) {
+            continue;
+        }
+        symbol_t* destination = tac->res;
+        propagator->versions[destination->id]++;
+        propagator->copies[destination->id].block = 0;
+        if(tac->type == tac_move && destination != tac->op1 && destination->data_type == data_type_int &&
+           tac->op1->data_type == data_type_int) {
+            copy_t* copy = &propagator->copies[destination->id];
+            copy->block = propagator->block;
+            copy->calls = propagator->calls;
+            copy->source = tac->op1;
+            copy->source_version = propagator->versions[tac->op1->id];
+        }
+    }
+}
+
+
+// Only ints are forwarded: instructions reading chars or bools as words
+// would see the bytes around a different symbol. A call in between keeps
+// the copy only if it clobbers neither symbol.
+void forward_copy(copy_propagator_t* propagator, tac_id_t id, tac_operand_t operand) {
+    tac_t* tac = tac_buffer_get(propagator->buffer, id);
+    symbol_t* symbol = tac_get_operand(tac, operand);
+    const copy_t* copy = &propagator->copies[symbol->id];
+    if(copy->block != propagator->block || propagator->versions[copy->source->id] != copy->source_version) {
+        return;
+    }
+    if(copy->calls == propagator->calls || (!tac_call_clobbers(symbol) && !tac_call_clobbers(copy->source))) {
+        tac_set_operand(tac, operand, copy->source);
+    }
+}
+
+
+void remove_unused_copies(copy_propagator_t* propagator) {
+    tac_buffer_t* buffer = propagator->buffer;
+    count_copy_uses(propagator);
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        if(tac->type == tac_move && is_temp(tac->res) && propagator->uses[tac->res->id] == 0) {
+            tac_buffer_remove(buffer, id);
+            propagator->context->statistics.eliminated_moves++;
+        }
+    }
+}
+
+
+void count_copy_uses(copy_propagator_t* propagator) {
+    tac_buffer_t* buffer = propagator->buffer;
+    for(size_t i = 0; i < propagator->symbol_count; i++) {
+        propagator->uses[i] = 0;
+    }
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        for(tac_operand_t operand = tac_operand_res; operand <= tac_operand_op2; operand++) {
+            symbol_t* symbol = tac_get_operand(tac, operand);
+            if(symbol != NOP && tac_operand_is_use(tac->type, operand)) {
+                propagator->uses[symbol->id]++;
+            }
+        }
+    }
+}
+
+
+// Whether the back end stores the result of the instruction with the size
+// of the data type. Arithmetic and calls always store a word.
+bool writes_data_type(tac_type_t type, data_type_t data_type) {
+    switch(type) {
+        case tac_sum:
+        case tac_sub:
+        case tac_mul:
+        case tac_div:
+        case tac_call:
+            return data_type == data_type_int;
+        case tac_eq:
+        case tac_dif:
+        case tac_gt:
+        case tac_ge:
+        case tac_lt:
+        case tac_le:
+            return data_type == data_type_bool;
+        case tac_move:
+            return data_type == data_type_int || data_type == data_type_char || data_type == data_type_bool;
+        case tac_vector_index:
+            return data_type == data_type_int || data_type == data_type_char;
+        default:
+            return false;
+    }
+}
+
+
+bool ends_straight_line(tac_type_t type) {
+    switch(type) {
+        case tac_label:
+        case tac_jump:
+        case tac_jump_false:
+        case tac_call:
+        case tac_return:
+            return true;
+        default:
+            return false;
+    }
+}
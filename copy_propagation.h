@@ -0,0 +1,17 @@
+#ifndef COPY_PROPAGATION_H
+#define COPY_PROPAGATION_H
+
+#include "compilation_context.h"
+#include "tac_buffer.h"
+
+/*
+ * Removes moves between symbols. A temporary whose only use is a move is
+ * written directly by its definition into the destination of the move,
+ * when both are in the same basic block and nothing in between refers to
+ * the destination. Within a basic block, reads of an int copied by a move
+ * read the source instead while neither changed, and the copies left
+ * without uses are removed.
+ */
+void propagate_copies(compilation_context_t* context, tac_buffer_t* buffer);
+
+#endif
@@ -0,0 +1,206 @@
+#include "dead_code.h"
+
+#include <stdlib.h>
+
+#include "code_generator.h"
+
+typedef struct dead_code_eliminator {
+    tac_buffer_t* buffer;
+    // Operands of live instructions referring to each symbol, by symbol id
+    size_t* references;
+    // Instruction writing each temporary
+    tac_id_t* definitions;
+    size_t symbol_count;
+} dead_code_eliminator_t;
+
+bool remove_unreachable_code(dead_code_eliminator_t* eliminator);
+
+bool remove_unused_labels(dead_code_eliminator_t* eliminator);
+
+void remove_dead_definitions(dead_code_eliminator_t* eliminator);
+
+void remove_unused_declarations(dead_code_eliminator_t* eliminator);
+
+void count_uses(dead_code_eliminator_t* eliminator);
+
+bool is_removable_definition(const tac_t* tac);
+
+
+void eliminate_dead_code(compilation_context_t* context, tac_buffer_t* buffer) {
+    dead_code_eliminator_t eliminator;
+    eliminator.buffer = buffer;
+    eliminator.symbol_count = symbol_table_size(context->symbol_table);
+    eliminator.references = malloc(eliminator.symbol_count * sizeof(size_t));
+    eliminator.definitions = malloc(eliminator.symbol_count * sizeof(tac_id_t));
+    size_t size = tac_buffer_size(buffer);
+
+    // Removing a jump may leave a label unused, and removing a label may
+    // make the code after it unreachable
+    bool changed = true;
+    while(changed) {
+        changed = remove_unreachable_code(&eliminator);
+        changed = remove_unused_labels(&eliminator) || changed;
+    }
+    remove_dead_definitions(&eliminator);
+    remove_unused_declarations(&eliminator);
+
+    context->statistics.removed_instructions += size - tac_buffer_size(buffer);
+    free(eliminator.references);
+    free(eliminator.definitions);
+}
+
+
+bool remove_unreachable_code(dead_code_eliminator_t* eliminator) {
+    tac_buffer_t* buffer = eliminator->buffer;
+    bool changed = false;
+    for(size_t i = 0; i < tac_buffer_function_count(buffer); i++) {
+        tac_function_range_t range = tac_buffer_function(buffer, i);
+        bool reachable = true;
+        for(tac_id_t id = range.begin; id != TAC_ID_NONE && id != range.end; id = tac_buffer_next(buffer, id)) {
+            tac_t* tac = tac_buffer_get(buffer, id);
+            if(tac->type == tac_label) {
+                reachable = true;
+            } else if(!reachable) {
+                tac_buffer_remove(buffer, id);
+                changed = true;
+            } else if(tac->type == tac_jump || tac->type == tac_return) {
+                reachable = false;
+            }
+        }
+    }
+    return changed;
+}
+
+
+bool remove_unused_labels(dead_code_eliminator_t* eliminator) {
+    tac_buffer_t* buffer = eliminator->buffer;
+    size_t* jumps = eliminator->references;
+    for(size_t i = 0; i < eliminator->symbol_count; i++) {
+        jumps[i] = 0;
+    }
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        if(tac->type == tac_jump || tac->type == tac_jump_false) {
+            jumps[tac->res->id]++;
+        }
+    }
+
+    bool changed = false;
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        if(tac->type == tac_label && jumps[tac->res->id] == 0) {
+            tac_buffer_remove(buffer, id);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+
+// Removing a definition may leave the temporaries it read unused, they are
+// followed through a work list
+void remove_dead_definitions(dead_code_eliminator_t* eliminator) {
+    tac_buffer_t* buffer = eliminator->buffer;
+    count_uses(eliminator);
+
+    size_t dead_count = 0;
+    tac_id_t* dead = malloc(eliminator->symbol_count * sizeof(tac_id_t));
+    for(size_t i = 0; i < eliminator->symbol_count; i++) {
+        tac_id_t definition = eliminator->definitions[i];
+        if(definition != TAC_ID_NONE && eliminator->references[i] == 0) {
+            dead[dead_count++] = definition;
+        }
+    }
+
+    while(dead_count > 0) {
+        tac_id_t id = dead[--dead_count];
+        tac_t* tac = tac_buffer_get(buffer, id);
+        tac_buffer_remove(buffer, id);
+        for(tac_operand_t operand = tac_operand_op1; operand <= tac_operand_op2; operand++) {
+            symbol_t* symbol = tac_get_operand(tac, operand);
+            if(symbol == NOP || !tac_operand_is_use(tac->type, operand)) {
+                continue;
+            }
+            tac_id_t definition = eliminator->definitions[symbol->id];
+            if(--eliminator->references[symbol->id] == 0 && definition != TAC_ID_NONE) {
+                dead[dead_count++] = definition;
+            }
+        }
+    }
+    free(dead);
+}
+
+
+void remove_unused_declarations(dead_code_eliminator_t* eliminator) {
+    tac_buffer_t* buffer = eliminator->buffer;
+    size_t* references = eliminator->references;
+    for(size_t i = 0; i < eliminator->symbol_count; i++) {
+        references[i] = 0;
+    }
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        if(tac->type == tac_temp || tac->type == tac_init) {
+            continue;
+        }
+        for(tac_operand_t operand = tac_operand_res; operand <= tac_operand_op2; operand++) {
+            symbol_t* symbol = tac_get_operand(tac, operand);
+            if(symbol != NOP) {
+                references[symbol->id]++;
+            }
+        }
+    }
+
+    // Globals are kept, they are part of the program's data
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        bool is_temp_declaration = tac->type == tac_temp && is_temp(tac->res);
+        bool is_literal_declaration = tac->type == tac_init && tac->res->type == symbol_label;
+        if((is_temp_declaration || is_literal_declaration) && references[tac->res->id] == 0) {
+            tac_buffer_remove(buffer, id);
+        }
+    }
+}
+
+
+// Only the definitions that may be removed are recorded
+void count_uses(dead_code_eliminator_t* eliminator) {
+    tac_buffer_t* buffer = eliminator->buffer;
+    for(size_t i = 0; i < eliminator->symbol_count; i++) {
+        eliminator->references[i] = 0;
+        eliminator->definitions[i] = TAC_ID_NONE;
+    }
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        for(tac_operand_t operand = tac_operand_res; operand <= tac_operand_op2; operand++) {
+            symbol_t* symbol = tac_get_operand(tac, operand);
+            if(symbol != NOP && tac_operand_is_use(tac->type, operand)) {
+                eliminator->references[symbol->id]++;
+            }
+        }
+        if(is_removable_definition(tac)) {
+            eliminator->definitions[tac->res->id] = id;
+        }
+    }
+}
+
+
+// Calls and reads have effects besides their result
+bool is_removable_definition(const tac_t* tac) {
+    switch(tac->type) {
+        case tac_sum:
+        case tac_sub:
+        case tac_mul:
+        case tac_div:
+        case tac_eq:
+        case tac_dif:
+        case tac_gt:
+        case tac_ge:
+        case tac_lt:
+        case tac_le:
+        case tac_move:
+        case tac_vector_index:
+            return is_temp(tac->res);
+        default:
+            return false;
+    }
+}
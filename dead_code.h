@@ -0,0 +1,16 @@
+#ifndef DEAD_CODE_H
+#define DEAD_CODE_H
+
+#include "compilation_context.h"
+#include "tac_buffer.h"
+
+/*
+ * Removes the instructions that can never run, between a jump or return
+ * and the next label, the labels nothing jumps to, and the instructions
+ * computing temporaries that are never read. Calls, reads and prints are
+ * kept, whatever they write. Declarations of the temporaries and literals
+ * no instruction refers to anymore are removed last.
+ */
+void eliminate_dead_code(compilation_context_t* context, tac_buffer_t* buffer);
+
+#endif
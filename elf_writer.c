@@ -0,0 +1,211 @@
+#include "elf_writer.h"
+
+#include <elf.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Section header indices, the encoder's sections come first after the null one
+#define SECTION_INDEX(section) ((section) + 1)
+#define RELA_TEXT_INDEX (SECTION_INDEX(encoder_section_count))
+#define SYMTAB_INDEX (RELA_TEXT_INDEX + 1)
+#define STRTAB_INDEX (SYMTAB_INDEX + 1)
+#define SHSTRTAB_INDEX (STRTAB_INDEX + 1)
+#define NOTE_STACK_INDEX (SHSTRTAB_INDEX + 1)
+#define SECTION_COUNT (NOTE_STACK_INDEX + 1)
+
+typedef struct string_table {
+    char* data;
+    size_t size;
+    size_t capacity;
+} string_table_t;
+
+size_t string_table_add(string_table_t* table, const char* string);
+
+bool write_aligned(FILE* stream, size_t* offset, const void* data, size_t size, size_t alignment);
+
+Elf64_Word section_flags(encoder_section_t section);
+
+
+bool write_elf_object(const encoder_t* encoder, FILE* stream) {
+    string_table_t strtab = { NULL, 0, 0 };
+    string_table_t shstrtab = { NULL, 0, 0 };
+    string_table_add(&strtab, "");
+    string_table_add(&shstrtab, "");
+
+    // Local symbols must precede global ones, undefined symbols are global
+    size_t symbol_count = encoder_symbol_count(encoder);
+    Elf64_Sym* symbols = calloc(symbol_count + 1, sizeof(Elf64_Sym));
+    size_t* elf_index = malloc((symbol_count + 1) * sizeof(size_t));
+    size_t next_symbol = 1;
+    size_t first_global = 0;
+    for(int pass = 0; pass < 2; pass++) {
+        bool global_pass = pass == 1;
+        if(global_pass) {
+            first_global = next_symbol;
+        }
+        for(size_t i = 0; i < symbol_count; i++) {
+            const encoder_symbol_t* symbol = encoder_symbol(encoder, i);
+            bool undefined = symbol->section == encoder_section_undefined;
+            if((symbol->global || undefined) != global_pass) {
+                continue;
+            }
+            Elf64_Sym* elf_symbol = &symbols[next_symbol];
+            elf_symbol->st_name = string_table_add(&strtab, symbol->name);
+            elf_symbol->st_info = ELF64_ST_INFO(global_pass ? STB_GLOBAL : STB_LOCAL,
+                                                symbol->object ? STT_OBJECT : STT_NOTYPE);
+            elf_symbol->st_shndx = undefined ? SHN_UNDEF : SECTION_INDEX(symbol->section);
+            elf_symbol->st_value = undefined ? 0 : symbol->offset;
+            elf_symbol->st_size = symbol->size;
+            elf_index[i] = next_symbol++;
+        }
+    }
+
+    size_t relocation_count = encoder_relocation_count(encoder);
+    Elf64_Rela* relocations = malloc((relocation_count + 1) * sizeof(Elf64_Rela));
+    for(size_t i = 0; i < relocation_count; i++) {
+        const encoder_relocation_t* relocation = encoder_relocation(encoder, i);
+        Elf64_Word type = relocation->type == encoder_relocation_plt32 ? R_X86_64_PLT32
+                                                                       : R_X86_64_PC32;
+        relocations[i].r_offset = relocation->offset;
+        relocations[i].r_info = ELF64_R_INFO(elf_index[relocation->symbol], type);
+        relocations[i].r_addend = relocation->addend;
+    }
+
+    Elf64_Shdr headers[SECTION_COUNT];
+    memset(headers, 0, sizeof(headers));
+    for(encoder_section_t section = 0; section < encoder_section_count; section++) {
+        Elf64_Shdr* header = &headers[SECTION_INDEX(section)];
+        header->sh_name = string_table_add(&shstrtab, encoder_section_name(section));
+        header->sh_type = section == encoder_section_bss ? SHT_NOBITS : SHT_PROGBITS;
+        header->sh_flags = section_flags(section);
+        header->sh_size = encoder_section_size(encoder, section);
+        header->sh_addralign = encoder_section_alignment(encoder, section);
+    }
+    headers[RELA_TEXT_INDEX].sh_name = string_table_add(&shstrtab, ".rela.text");
+    headers[RELA_TEXT_INDEX].sh_type = SHT_RELA;
+    headers[RELA_TEXT_INDEX].sh_flags = SHF_INFO_LINK;
+    headers[RELA_TEXT_INDEX].sh_size = relocation_count * sizeof(Elf64_Rela);
+    headers[RELA_TEXT_INDEX].sh_link = SYMTAB_INDEX;
+    headers[RELA_TEXT_INDEX].sh_info = SECTION_INDEX(encoder_section_text);
+    headers[RELA_TEXT_INDEX].sh_addralign = 8;
+    headers[RELA_TEXT_INDEX].sh_entsize = sizeof(Elf64_Rela);
+    headers[SYMTAB_INDEX].sh_name = string_table_add(&shstrtab, ".symtab");
+    headers[SYMTAB_INDEX].sh_type = SHT_SYMTAB;
+    headers[SYMTAB_INDEX].sh_size = next_symbol * sizeof(Elf64_Sym);
+    headers[SYMTAB_INDEX].sh_link = STRTAB_INDEX;
+    headers[SYMTAB_INDEX].sh_info = first_global;
+    headers[SYMTAB_INDEX].sh_addralign = 8;
+    headers[SYMTAB_INDEX].sh_entsize = sizeof(Elf64_Sym);
+    headers[STRTAB_INDEX].sh_name = string_table_add(&shstrtab, ".strtab");
+    headers[STRTAB_INDEX].sh_type = SHT_STRTAB;
+    headers[STRTAB_INDEX].sh_size = strtab.size;
+    headers[STRTAB_INDEX].sh_addralign = 1;
+    // Without this note the linker assumes the object needs an executable stack
+    headers[NOTE_STACK_INDEX].sh_name = string_table_add(&shstrtab, ".note.GNU-stack");
+    headers[NOTE_STACK_INDEX].sh_type = SHT_PROGBITS;
+    headers[NOTE_STACK_INDEX].sh_addralign = 1;
+    headers[SHSTRTAB_INDEX].sh_name = string_table_add(&shstrtab, ".shstrtab");
+    headers[SHSTRTAB_INDEX].sh_type = SHT_STRTAB;
+    headers[SHSTRTAB_INDEX].sh_size = shstrtab.size;
+    headers[SHSTRTAB_INDEX].sh_addralign = 1;
+
+    // Section contents follow the ELF header in index order, then the
+    // section header table
+    size_t offset = sizeof(Elf64_Ehdr);
+    for(size_t index = 1; index < SECTION_COUNT; index++) {
+        size_t alignment = headers[index].sh_addralign;
+        offset = (offset + alignment - 1) / alignment * alignment;
+        headers[index].sh_offset = offset;
+        if(headers[index].sh_type != SHT_NOBITS) {
+            offset += headers[index].sh_size;
+        }
+    }
+    size_t headers_offset = (offset + 7) / 8 * 8;
+
+    Elf64_Ehdr elf_header;
+    memset(&elf_header, 0, sizeof(elf_header));
+    memcpy(elf_header.e_ident, ELFMAG, SELFMAG);
+    elf_header.e_ident[EI_CLASS] = ELFCLASS64;
+    elf_header.e_ident[EI_DATA] = ELFDATA2LSB;
+    elf_header.e_ident[EI_VERSION] = EV_CURRENT;
+    elf_header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    elf_header.e_type = ET_REL;
+    elf_header.e_machine = EM_X86_64;
+    elf_header.e_version = EV_CURRENT;
+    elf_header.e_shoff = headers_offset;
+    elf_header.e_ehsize = sizeof(Elf64_Ehdr);
+    elf_header.e_shentsize = sizeof(Elf64_Shdr);
+    elf_header.e_shnum = SECTION_COUNT;
+    elf_header.e_shstrndx = SHSTRTAB_INDEX;
+
+    const void* contents[SECTION_COUNT] = { NULL };
+    for(encoder_section_t section = 0; section < encoder_section_count; section++) {
+        contents[SECTION_INDEX(section)] = encoder_section_bytes(encoder, section);
+    }
+    contents[RELA_TEXT_INDEX] = relocations;
+    contents[SYMTAB_INDEX] = symbols;
+    contents[STRTAB_INDEX] = strtab.data;
+    contents[SHSTRTAB_INDEX] = shstrtab.data;
+
+    size_t written = 0;
+    bool success = write_aligned(stream, &written, &elf_header, sizeof(elf_header), 1);
+    for(size_t index = 1; index < SECTION_COUNT && success; index++) {
+        size_t size = headers[index].sh_type == SHT_NOBITS ? 0 : headers[index].sh_size;
+        success = write_aligned(stream, &written, contents[index], size, headers[index].sh_addralign);
+    }
+    success = success && write_aligned(stream, &written, headers, sizeof(headers), 8);
+
+    free(symbols);
+    free(elf_index);
+    free(relocations);
+    free(strtab.data);
+    free(shstrtab.data);
+    return success;
+}
+
+
+size_t string_table_add(string_table_t* table, const char* string) {
+    size_t length = strlen(string) + 1;
+    if(table->size + length > table->capacity) {
+        table->capacity = 2 * (table->size + length);
+        table->data = realloc(table->data, table->capacity);
+    }
+    size_t offset = table->size;
+    memcpy(table->data + offset, string, length);
+    table->size += length;
+    return offset;
+}
+
+
+bool write_aligned(FILE* stream, size_t* offset, const void* data, size_t size, size_t alignment) {
+    static const char zeros[16] = { 0 };
+    size_t padding = alignment > 1 ? (alignment - *offset % alignment) % alignment : 0;
+    while(padding > 0) {
+        size_t chunk = padding < sizeof(zeros) ? padding : sizeof(zeros);
+        if(fwrite(zeros, 1, chunk, stream) != chunk) {
+            return false;
+        }
+        padding -= chunk;
+        *offset += chunk;
+    }
+    if(size > 0 && fwrite(data, 1, size, stream) != size) {
+        return false;
+    }
+    *offset += size;
+    return true;
+}
+
+
+Elf64_Word section_flags(encoder_section_t section) {
+    switch(section) {
+        case encoder_section_text:
+            return SHF_ALLOC | SHF_EXECINSTR;
+        case encoder_section_data:
+        case encoder_section_bss:
+            return SHF_ALLOC | SHF_WRITE;
+        case encoder_section_rodata:
+            return SHF_ALLOC;
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef ELF_WRITER_H
+#define ELF_WRITER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "encoder.h"
+
+/*
+ * Writes the sections, symbols and relocations of a finished encoder as an
+ * x86-64 ELF relocatable object, ready for the system linker.
+ */
+
+// Returns false if writing to the stream failed
+bool write_elf_object(const encoder_t* encoder, FILE* stream);
+
+#endif
@@ -0,0 +1,622 @@
+#include "emitter.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "allocation.h"
+#include "encoder.h"
+
+#define TABLE_ENTRY(text) { text, sizeof(text) - 1 }
+
+typedef struct emitter_text {
+    const char* text;
+    size_t length;
+} emitter_text_t;
+
+struct emitter {
+    FILE* stream;
+    int descriptor;
+    char* buffer;
+    size_t used;
+    size_t capacity;
+    // Set for object emitters, which have no stream
+    encoder_t* encoder;
+    // Set once a write fails, nothing is written after it
+    bool failed;
+};
+
+static const emitter_text_t register_names[] = {
+    [x86_no_register] = TABLE_ENTRY(""),
+    [x86_eax] = TABLE_ENTRY("%eax"),
+    [x86_ecx] = TABLE_ENTRY("%ecx"),
+    [x86_edx] = TABLE_ENTRY("%edx"),
+    [x86_esi] = TABLE_ENTRY("%esi"),
+    [x86_edi] = TABLE_ENTRY("%edi"),
+    [x86_rax] = TABLE_ENTRY("%rax"),
+    [x86_rcx] = TABLE_ENTRY("%rcx"),
+    [x86_rdx] = TABLE_ENTRY("%rdx"),
+    [x86_rsp] = TABLE_ENTRY("%rsp"),
+    [x86_rbp] = TABLE_ENTRY("%rbp"),
+    [x86_rdi] = TABLE_ENTRY("%rdi"),
+    [x86_al] = TABLE_ENTRY("%al"),
+    [x86_cl] = TABLE_ENTRY("%cl"),
+    [x86_xmm0] = TABLE_ENTRY("%xmm0")
+};
+
+static const emitter_text_t mnemonic_names[] = {
+    [x86_movl] = TABLE_ENTRY("movl"),
+    [x86_movq] = TABLE_ENTRY("movq"),
+    [x86_movb] = TABLE_ENTRY("movb"),
+    [x86_movzbl] = TABLE_ENTRY("movzbl"),
+    [x86_movsbl] = TABLE_ENTRY("movsbl"),
+    [x86_movslq] = TABLE_ENTRY("movslq"),
+    [x86_movss] = TABLE_ENTRY("movss"),
+    [x86_pushq] = TABLE_ENTRY("pushq"),
+    [x86_popq] = TABLE_ENTRY("popq"),
+    [x86_leaq] = TABLE_ENTRY("leaq"),
+    [x86_addl] = TABLE_ENTRY("addl"),
+    [x86_subl] = TABLE_ENTRY("subl"),
+    [x86_imull] = TABLE_ENTRY("imull"),
+    [x86_idivl] = TABLE_ENTRY("idivl"),
+    [x86_cltd] = TABLE_ENTRY("cltd"),
+    [x86_cltq] = TABLE_ENTRY("cltq"),
+    [x86_cmpl] = TABLE_ENTRY("cmpl"),
+    [x86_testb] = TABLE_ENTRY("testb"),
+    [x86_sete] = TABLE_ENTRY("sete"),
+    [x86_setne] = TABLE_ENTRY("setne"),
+    [x86_setg] = TABLE_ENTRY("setg"),
+    [x86_setge] = TABLE_ENTRY("setge"),
+    [x86_setl] = TABLE_ENTRY("setl"),
+    [x86_setle] = TABLE_ENTRY("setle"),
+    [x86_seta] = TABLE_ENTRY("seta"),
+    [x86_setnb] = TABLE_ENTRY("setnb"),
+    [x86_cmovne] = TABLE_ENTRY("cmovne"),
+    [x86_addss] = TABLE_ENTRY("addss"),
+    [x86_subss] = TABLE_ENTRY("subss"),
+    [x86_mulss] = TABLE_ENTRY("mulss"),
+    [x86_divss] = TABLE_ENTRY("divss"),
+    [x86_cvtsi2ss] = TABLE_ENTRY("cvtsi2ss"),
+    [x86_cvtss2sd] = TABLE_ENTRY("cvtss2sd"),
+    [x86_call] = TABLE_ENTRY("call"),
+    [x86_jmp] = TABLE_ENTRY("jmp"),
+    [x86_je] = TABLE_ENTRY("je"),
+    [x86_ret] = TABLE_ENTRY("ret")
+};
+
+static const emitter_text_t section_names[] = {
+    [x86_section_text] = TABLE_ENTRY("\t.text\n"),
+    [x86_section_data] = TABLE_ENTRY("\t.data\n"),
+    [x86_section_rodata] = TABLE_ENTRY("\t.section\t.rodata\n")
+};
+
+static const encoder_section_t encoder_sections[] = {
+    [x86_section_text] = encoder_section_text,
+    [x86_section_data] = encoder_section_data,
+    [x86_section_rodata] = encoder_section_rodata
+};
+
+static const size_t data_sizes[] = {
+    [x86_data_byte] = 1,
+    [x86_data_long] = 4
+};
+
+static const emitter_text_t data_directives[] = {
+    [x86_data_byte] = TABLE_ENTRY("\t.byte "),
+    [x86_data_long] = TABLE_ENTRY("\t.long "),
+    [x86_data_string] = TABLE_ENTRY("\t.string ")
+};
+
+void emitter_append_text(emitter_t* emitter, emitter_text_t text);
+
+bool emitter_write(emitter_t* emitter, const char* data, size_t size);
+
+void emitter_make_room(emitter_t* emitter, size_t length);
+
+
+emitter_t* new_emitter(FILE* stream) {
+    emitter_t* emitter = allocate(allocation_emitter, sizeof(emitter_t));
+    emitter->stream = stream;
+    // Anything already buffered by stdio must reach the file before our
+    // own writes do. Streams without a descriptor are written with fwrite.
+    fflush(stream);
+    emitter->descriptor = fileno(stream);
+    emitter->buffer = allocate(allocation_assembly, EMITTER_BUFFER_SIZE);
+    emitter->used = 0;
+    emitter->capacity = EMITTER_BUFFER_SIZE;
+    emitter->encoder = NULL;
+    emitter->failed = false;
+    return emitter;
+}
+
+
+emitter_t* new_buffer_emitter() {
+    emitter_t* emitter = allocate(allocation_emitter, sizeof(emitter_t));
+    emitter->stream = NULL;
+    emitter->descriptor = -1;
+    emitter->buffer = allocate(allocation_assembly, EMITTER_INITIAL_TEXT_SIZE);
+    emitter->used = 0;
+    emitter->capacity = EMITTER_INITIAL_TEXT_SIZE;
+    emitter->encoder = NULL;
+    emitter->failed = false;
+    return emitter;
+}
+
+
+emitter_t* new_object_emitter(encoder_t* encoder) {
+    emitter_t* emitter = allocate(allocation_emitter, sizeof(emitter_t));
+    emitter->stream = NULL;
+    emitter->descriptor = -1;
+    emitter->buffer = NULL;
+    emitter->used = 0;
+    emitter->capacity = 0;
+    emitter->encoder = encoder;
+    emitter->failed = false;
+    return emitter;
+}
+
+
+void delete_emitter(emitter_t* emitter) {
+    if(emitter == NULL) {
+        return;
+    }
+    emitter_flush(emitter);
+    release(allocation_assembly, emitter->buffer);
+    release(allocation_emitter, emitter);
+}
+
+
+bool emitter_flush(emitter_t* emitter) {
+    if(emitter->stream == NULL) {
+        return true;
+    }
+    emitter_write(emitter, emitter->buffer, emitter->used);
+    emitter->used = 0;
+    return !emitter->failed;
+}
+
+
+char* emitter_take_text(emitter_t* emitter, size_t* size) {
+    char* text = emitter->buffer;
+    *size = emitter->used;
+    emitter->buffer = NULL;
+    emitter->used = 0;
+    emitter->capacity = 0;
+    return text;
+}
+
+
+void emitter_append(emitter_t* emitter, const char* text, size_t length) {
+    if(emitter->used + length > emitter->capacity) {
+        if(emitter->stream == NULL) {
+            emitter_make_room(emitter, length);
+        } else {
+            emitter_flush(emitter);
+            if(length > emitter->capacity) {
+                emitter_write(emitter, text, length);
+                return;
+            }
+        }
+    }
+    memcpy(emitter->buffer + emitter->used, text, length);
+    emitter->used += length;
+}
+
+
+void emitter_append_string(emitter_t* emitter, const char* text) {
+    emitter_append(emitter, text, strlen(text));
+}
+
+
+void emitter_append_char(emitter_t* emitter, char c) {
+    if(emitter->used == emitter->capacity) {
+        if(emitter->stream == NULL) {
+            emitter_make_room(emitter, 1);
+        } else {
+            emitter_flush(emitter);
+        }
+    }
+    emitter->buffer[emitter->used++] = c;
+}
+
+
+void emitter_append_integer(emitter_t* emitter, long value) {
+    char digits[24];
+    size_t length = 0;
+    unsigned long magnitude = value < 0 ? -(unsigned long)value : (unsigned long)value;
+    do {
+        digits[sizeof(digits) - 1 - length++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while(magnitude > 0);
+    if(value < 0) {
+        digits[sizeof(digits) - 1 - length++] = '-';
+    }
+    emitter_append(emitter, digits + sizeof(digits) - length, length);
+}
+
+
+void emitter_append_mnemonic(emitter_t* emitter, x86_mnemonic_t mnemonic) {
+    emitter_append_text(emitter, mnemonic_names[mnemonic]);
+}
+
+
+void emitter_append_register(emitter_t* emitter, x86_register_t reg) {
+    emitter_append_text(emitter, register_names[reg]);
+}
+
+
+void emitter_append_operand(emitter_t* emitter, x86_operand_t operand) {
+    switch(operand.type) {
+        case x86_operand_register:
+            emitter_append_register(emitter, operand.reg);
+            break;
+        case x86_operand_immediate:
+            emitter_append_char(emitter, '$');
+            emitter_append_integer(emitter, operand.value);
+            break;
+        case x86_operand_memory:
+            if(operand.symbol != NULL) {
+                emitter_append_string(emitter, operand.symbol);
+                emitter_append(emitter, "(%rip)", 6);
+                break;
+            }
+            if(operand.value != 0 || operand.reg == x86_no_register) {
+                emitter_append_integer(emitter, operand.value);
+            }
+            emitter_append_char(emitter, '(');
+            emitter_append_register(emitter, operand.reg);
+            if(operand.index != x86_no_register) {
+                emitter_append_char(emitter, ',');
+                emitter_append_register(emitter, operand.index);
+                if(operand.scale != 1) {
+                    emitter_append_char(emitter, ',');
+                    emitter_append_integer(emitter, operand.scale);
+                }
+            }
+            emitter_append_char(emitter, ')');
+            break;
+        case x86_operand_target:
+            if(operand.target_type == x86_target_function_end) {
+                emitter_append_char(emitter, '.');
+                emitter_append_string(emitter, operand.symbol);
+                emitter_append(emitter, "_end", 4);
+            } else {
+                emitter_append_string(emitter, operand.symbol);
+                if(operand.target_type == x86_target_plt) {
+                    emitter_append(emitter, "@PLT", 4);
+                }
+            }
+            break;
+    }
+}
+
+
+x86_operand_t x86_reg(x86_register_t reg) {
+    x86_operand_t operand = { x86_operand_register, reg, 0, x86_no_register, 1, NULL, x86_target_local };
+    return operand;
+}
+
+
+x86_operand_t x86_imm(long value) {
+    x86_operand_t operand = { x86_operand_immediate, x86_no_register, value, x86_no_register, 1, NULL, x86_target_local };
+    return operand;
+}
+
+
+x86_operand_t x86_mem(x86_register_t base, long displacement) {
+    return x86_mem_index(base, x86_no_register, 1, displacement);
+}
+
+
+x86_operand_t x86_mem_index(x86_register_t base, x86_register_t index, int scale, long displacement) {
+    x86_operand_t operand = { x86_operand_memory, base, displacement, index, scale, NULL, x86_target_local };
+    return operand;
+}
+
+
+x86_operand_t x86_rip(const char* symbol) {
+    x86_operand_t operand = { x86_operand_memory, x86_no_register, 0, x86_no_register, 1, symbol, x86_target_local };
+    return operand;
+}
+
+
+x86_operand_t x86_target(const char* symbol, x86_target_type_t type) {
+    x86_operand_t operand = { x86_operand_target, x86_no_register, 0, x86_no_register, 1, symbol, type };
+    return operand;
+}
+
+
+void emit_instruction0(emitter_t* emitter, x86_mnemonic_t mnemonic) {
+    if(emitter->encoder != NULL) {
+        encoder_instruction(emitter->encoder, mnemonic, 0, NULL);
+        return;
+    }
+    emitter_append_char(emitter, '\t');
+    emitter_append_mnemonic(emitter, mnemonic);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_instruction1(emitter_t* emitter, x86_mnemonic_t mnemonic, x86_operand_t operand) {
+    if(emitter->encoder != NULL) {
+        encoder_instruction(emitter->encoder, mnemonic, 1, &operand);
+        return;
+    }
+    emitter_append_char(emitter, '\t');
+    emitter_append_mnemonic(emitter, mnemonic);
+    emitter_append_char(emitter, '\t');
+    emitter_append_operand(emitter, operand);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_instruction2(emitter_t* emitter, x86_mnemonic_t mnemonic,
+                       x86_operand_t source, x86_operand_t destination) {
+    if(emitter->encoder != NULL) {
+        x86_operand_t operands[] = { source, destination };
+        encoder_instruction(emitter->encoder, mnemonic, 2, operands);
+        return;
+    }
+    emitter_append_char(emitter, '\t');
+    emitter_append_mnemonic(emitter, mnemonic);
+    emitter_append_char(emitter, '\t');
+    emitter_append_operand(emitter, source);
+    emitter_append(emitter, ", ", 2);
+    emitter_append_operand(emitter, destination);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_section(emitter_t* emitter, x86_section_t section) {
+    if(emitter->encoder != NULL) {
+        encoder_switch_section(emitter->encoder, encoder_sections[section]);
+        return;
+    }
+    emitter_append_text(emitter, section_names[section]);
+}
+
+
+void emit_global(emitter_t* emitter, const char* symbol) {
+    if(emitter->encoder != NULL) {
+        encoder_set_global(emitter->encoder, symbol);
+        return;
+    }
+    emitter_append(emitter, "\t.globl ", 8);
+    emitter_append_string(emitter, symbol);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_label(emitter_t* emitter, const char* symbol) {
+    if(emitter->encoder != NULL) {
+        encoder_define_label(emitter->encoder, symbol);
+        return;
+    }
+    emitter_append_string(emitter, symbol);
+    emitter_append(emitter, ":\n", 2);
+}
+
+
+void emit_function_end_label(emitter_t* emitter, const char* function) {
+    if(emitter->encoder != NULL) {
+        size_t length = strlen(function);
+        char* name = allocate(allocation_string, length + 6);
+        name[0] = '.';
+        memcpy(name + 1, function, length);
+        memcpy(name + 1 + length, "_end", 5);
+        encoder_define_label(emitter->encoder, name);
+        release(allocation_string, name);
+        return;
+    }
+    emitter_append_char(emitter, '.');
+    emitter_append_string(emitter, function);
+    emitter_append(emitter, "_end:\n", 6);
+}
+
+
+void emit_align(emitter_t* emitter, long alignment) {
+    if(emitter->encoder != NULL) {
+        encoder_align(emitter->encoder, alignment);
+        return;
+    }
+    emitter_append(emitter, "\t.align ", 8);
+    emitter_append_integer(emitter, alignment);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_object_type(emitter_t* emitter, const char* symbol) {
+    if(emitter->encoder != NULL) {
+        encoder_set_object(emitter->encoder, symbol);
+        return;
+    }
+    emitter_append(emitter, "\t.type\t", 7);
+    emitter_append_string(emitter, symbol);
+    emitter_append(emitter, ", @object\n", 10);
+}
+
+
+void emit_size(emitter_t* emitter, const char* symbol, long size) {
+    if(emitter->encoder != NULL) {
+        encoder_set_size(emitter->encoder, symbol, size);
+        return;
+    }
+    emitter_append(emitter, "\t.size\t", 7);
+    emitter_append_string(emitter, symbol);
+    emitter_append(emitter, ", ", 2);
+    emitter_append_integer(emitter, size);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_common(emitter_t* emitter, const char* symbol, long size, long alignment) {
+    if(emitter->encoder != NULL) {
+        encoder_reserve(emitter->encoder, symbol, size, alignment);
+        return;
+    }
+    emitter_append(emitter, "\t.comm\t", 7);
+    emitter_append_string(emitter, symbol);
+    emitter_append_char(emitter, ',');
+    emitter_append_integer(emitter, size);
+    emitter_append_char(emitter, ',');
+    emitter_append_integer(emitter, alignment);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_common_unaligned(emitter_t* emitter, const char* symbol, long size) {
+    if(emitter->encoder != NULL) {
+        // Natural alignment of the size, as the assembler picks for .comm
+        long alignment = 1;
+        while(alignment < 16 && alignment * 2 <= size) {
+            alignment *= 2;
+        }
+        encoder_reserve(emitter->encoder, symbol, size, alignment);
+        return;
+    }
+    emitter_append(emitter, "\t.comm ", 7);
+    emitter_append_string(emitter, symbol);
+    emitter_append_char(emitter, ' ');
+    emitter_append_integer(emitter, size);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_data_text(emitter_t* emitter, x86_data_type_t type, const char* value) {
+    if(emitter->encoder != NULL) {
+        if(type == x86_data_string) {
+            encoder_append_string_literal(emitter->encoder, value);
+        } else {
+            encoder_append_integer(emitter->encoder, encoder_parse_integer(value), data_sizes[type]);
+        }
+        return;
+    }
+    emitter_append_text(emitter, data_directives[type]);
+    emitter_append_string(emitter, value);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_data_integer(emitter_t* emitter, x86_data_type_t type, long value) {
+    if(emitter->encoder != NULL) {
+        encoder_append_integer(emitter->encoder, value, data_sizes[type]);
+        return;
+    }
+    emitter_append_text(emitter, data_directives[type]);
+    emitter_append_integer(emitter, value);
+    emitter_append_char(emitter, '\n');
+}
+
+
+// Written as the bits of the float, so the assembler does not round the
+// value again and both back ends store the same bytes
+void emit_data_float(emitter_t* emitter, double value) {
+    float single = value;
+    if(emitter->encoder != NULL) {
+        encoder_append_bytes(emitter->encoder, &single, sizeof(single));
+        return;
+    }
+    uint32_t bits;
+    memcpy(&bits, &single, sizeof(bits));
+    emit_data_integer(emitter, x86_data_long, bits);
+}
+
+
+void emit_cfi_startproc(emitter_t* emitter) {
+    if(emitter->encoder != NULL) {
+        return;
+    }
+    emitter_append(emitter, "\t.cfi_startproc\n", 16);
+}
+
+
+void emit_cfi_endproc(emitter_t* emitter) {
+    if(emitter->encoder != NULL) {
+        return;
+    }
+    emitter_append(emitter, "\t.cfi_endproc\n", 14);
+}
+
+
+void emit_cfi_def_cfa(emitter_t* emitter, int reg, int offset) {
+    if(emitter->encoder != NULL) {
+        return;
+    }
+    emitter_append(emitter, "\t.cfi_def_cfa\t", 14);
+    emitter_append_integer(emitter, reg);
+    emitter_append(emitter, ", ", 2);
+    emitter_append_integer(emitter, offset);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_cfi_def_cfa_offset(emitter_t* emitter, int offset) {
+    if(emitter->encoder != NULL) {
+        return;
+    }
+    emitter_append(emitter, "\t.cfi_def_cfa_offset\t", 21);
+    emitter_append_integer(emitter, offset);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_cfi_def_cfa_register(emitter_t* emitter, int reg) {
+    if(emitter->encoder != NULL) {
+        return;
+    }
+    emitter_append(emitter, "\t.cfi_def_cfa_register\t", 23);
+    emitter_append_integer(emitter, reg);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emit_cfi_offset(emitter_t* emitter, int reg, int offset) {
+    if(emitter->encoder != NULL) {
+        return;
+    }
+    emitter_append(emitter, "\t.cfi_offset\t", 13);
+    emitter_append_integer(emitter, reg);
+    emitter_append(emitter, ", ", 2);
+    emitter_append_integer(emitter, offset);
+    emitter_append_char(emitter, '\n');
+}
+
+
+void emitter_append_text(emitter_t* emitter, emitter_text_t text) {
+    emitter_append(emitter, text.text, text.length);
+}
+
+
+bool emitter_write(emitter_t* emitter, const char* data, size_t size) {
+    if(emitter->failed) {
+        return false;
+    }
+    if(emitter->descriptor < 0) {
+        emitter->failed = fwrite(data, 1, size, emitter->stream) != size;
+        return !emitter->failed;
+    }
+    while(size > 0) {
+        ssize_t written = write(emitter->descriptor, data, size);
+        if(written < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            emitter->failed = true;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+
+void emitter_make_room(emitter_t* emitter, size_t length) {
+    size_t capacity = emitter->capacity == 0 ? EMITTER_INITIAL_TEXT_SIZE : emitter->capacity;
+    while(capacity < emitter->used + length) {
+        capacity *= 2;
+    }
+    emitter->buffer = reallocate(allocation_assembly, emitter->buffer, capacity);
+    emitter->capacity = capacity;
+}
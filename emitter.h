@@ -0,0 +1,212 @@
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Buffered writer for AT&T syntax x86-64 assembly. Text is appended to a
+ * large buffer from tables of mnemonics and registers, without going
+ * through printf, and is flushed to the stream's file descriptor with
+ * bulk writes. An object emitter takes the same calls and hands them to
+ * an encoder as machine code instead.
+ */
+
+typedef struct emitter emitter_t;
+
+typedef enum x86_register {
+    x86_no_register,
+    x86_eax,
+    x86_ecx,
+    x86_edx,
+    x86_esi,
+    x86_edi,
+    x86_rax,
+    x86_rcx,
+    x86_rdx,
+    x86_rsp,
+    x86_rbp,
+    x86_rdi,
+    x86_al,
+    x86_cl,
+    x86_xmm0
+} x86_register_t;
+
+typedef enum x86_mnemonic {
+    x86_movl,
+    x86_movq,
+    x86_movb,
+    x86_movzbl,
+    x86_movsbl,
+    x86_movslq,
+    x86_movss,
+    x86_pushq,
+    x86_popq,
+    x86_leaq,
+    x86_addl,
+    x86_subl,
+    x86_imull,
+    x86_idivl,
+    x86_cltd,
+    x86_cltq,
+    x86_cmpl,
+    x86_testb,
+    x86_sete,
+    x86_setne,
+    x86_setg,
+    x86_setge,
+    x86_setl,
+    x86_setle,
+    x86_seta,
+    x86_setnb,
+    x86_cmovne,
+    x86_addss,
+    x86_subss,
+    x86_mulss,
+    x86_divss,
+    x86_cvtsi2ss,
+    x86_cvtss2sd,
+    x86_call,
+    x86_jmp,
+    x86_je,
+    x86_ret
+} x86_mnemonic_t;
+
+typedef enum x86_operand_type {
+    x86_operand_register,
+    x86_operand_immediate,
+    x86_operand_memory,
+    x86_operand_target
+} x86_operand_type_t;
+
+typedef enum x86_target_type {
+    // Label or function of this file
+    x86_target_local,
+    // Function from a shared library, called through the PLT
+    x86_target_plt,
+    // Epilogue of the named function
+    x86_target_function_end
+} x86_target_type_t;
+
+/*
+ * Memory operands address displacement(base,index,scale), or symbol(%rip)
+ * when symbol is set.
+ */
+typedef struct x86_operand {
+    x86_operand_type_t type;
+    x86_register_t reg;
+    long value;
+    x86_register_t index;
+    int scale;
+    const char* symbol;
+    x86_target_type_t target_type;
+} x86_operand_t;
+
+typedef enum x86_section {
+    x86_section_text,
+    x86_section_data,
+    x86_section_rodata
+} x86_section_t;
+
+typedef enum x86_data_type {
+    x86_data_byte,
+    x86_data_long,
+    x86_data_string
+} x86_data_type_t;
+
+#define EMITTER_BUFFER_SIZE (256 * 1024)
+#define EMITTER_INITIAL_TEXT_SIZE 4096
+
+struct encoder;
+
+emitter_t* new_emitter(FILE* stream);
+
+// Debug information directives are dropped when encoding
+emitter_t* new_object_emitter(struct encoder* encoder);
+
+// Keeps all of its text in a growing buffer, see emitter_take_text
+emitter_t* new_buffer_emitter();
+
+// Flushes what is left in the buffer
+void delete_emitter(emitter_t* emitter);
+
+// Returns false if any write to the stream has failed so far. The text
+// appended after a failed write is dropped.
+bool emitter_flush(emitter_t* emitter);
+
+// Hands the text of a buffer emitter over to the caller, who must release
+// it as allocation_assembly
+char* emitter_take_text(emitter_t* emitter, size_t* size);
+
+void emitter_append(emitter_t* emitter, const char* text, size_t length);
+
+void emitter_append_string(emitter_t* emitter, const char* text);
+
+void emitter_append_char(emitter_t* emitter, char c);
+
+void emitter_append_integer(emitter_t* emitter, long value);
+
+void emitter_append_mnemonic(emitter_t* emitter, x86_mnemonic_t mnemonic);
+
+void emitter_append_register(emitter_t* emitter, x86_register_t reg);
+
+void emitter_append_operand(emitter_t* emitter, x86_operand_t operand);
+
+x86_operand_t x86_reg(x86_register_t reg);
+
+x86_operand_t x86_imm(long value);
+
+x86_operand_t x86_mem(x86_register_t base, long displacement);
+
+x86_operand_t x86_mem_index(x86_register_t base, x86_register_t index, int scale, long displacement);
+
+x86_operand_t x86_rip(const char* symbol);
+
+x86_operand_t x86_target(const char* symbol, x86_target_type_t type);
+
+void emit_instruction0(emitter_t* emitter, x86_mnemonic_t mnemonic);
+
+void emit_instruction1(emitter_t* emitter, x86_mnemonic_t mnemonic, x86_operand_t operand);
+
+void emit_instruction2(emitter_t* emitter, x86_mnemonic_t mnemonic,
+                       x86_operand_t source, x86_operand_t destination);
+
+void emit_section(emitter_t* emitter, x86_section_t section);
+
+void emit_global(emitter_t* emitter, const char* symbol);
+
+void emit_label(emitter_t* emitter, const char* symbol);
+
+void emit_function_end_label(emitter_t* emitter, const char* function);
+
+void emit_align(emitter_t* emitter, long alignment);
+
+void emit_object_type(emitter_t* emitter, const char* symbol);
+
+void emit_size(emitter_t* emitter, const char* symbol, long size);
+
+void emit_common(emitter_t* emitter, const char* symbol, long size, long alignment);
+
+void emit_common_unaligned(emitter_t* emitter, const char* symbol, long size);
+
+// Data written as it appears in the source, e.g. a literal's text
+void emit_data_text(emitter_t* emitter, x86_data_type_t type, const char* value);
+
+void emit_data_integer(emitter_t* emitter, x86_data_type_t type, long value);
+
+void emit_data_float(emitter_t* emitter, double value);
+
+void emit_cfi_startproc(emitter_t* emitter);
+
+void emit_cfi_endproc(emitter_t* emitter);
+
+void emit_cfi_def_cfa(emitter_t* emitter, int reg, int offset);
+
+void emit_cfi_def_cfa_offset(emitter_t* emitter, int offset);
+
+void emit_cfi_def_cfa_register(emitter_t* emitter, int reg);
+
+void emit_cfi_offset(emitter_t* emitter, int reg, int offset);
+
+#endif
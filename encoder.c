@@ -0,0 +1,626 @@
+#include "encoder.h"
+
+#include <string.h>
+
+#include "symbol_table.h"
+
+#define INITIAL_BUFFER_CAPACITY 4096
+#define INITIAL_SYMBOLS_CAPACITY 256
+#define EMPTY_SLOT SIZE_MAX
+#define NOP_BYTE 0x90
+#define REX_W 0x48
+#define MODRM_DIRECT 0xC0
+#define MODRM_RIP_RELATIVE 0x05
+#define MODRM_SIB 0x04
+#define SIB_NO_INDEX 0x04
+#define SIB_NO_BASE 0x05
+#define STACK_POINTER_CODE 4
+#define FRAME_POINTER_CODE 5
+
+typedef enum encoding_form {
+    // Opcode alone
+    encoding_form_none,
+    // Register field holds the source and r/m the destination
+    encoding_form_source_in_reg,
+    // Register field holds the destination and r/m the source
+    encoding_form_destination_in_reg,
+    // Single r/m operand, the register field extends the opcode
+    encoding_form_extension,
+    // Register added to the last opcode byte
+    encoding_form_register_in_opcode,
+    // 32 bit displacement to a label
+    encoding_form_relative
+} encoding_form_t;
+
+typedef struct instruction_encoding {
+    encoding_form_t form;
+    uint8_t prefix;
+    bool rex_w;
+    uint8_t opcode[2];
+    uint8_t opcode_length;
+    // Last opcode byte of the source_in_reg form when the source is in memory
+    uint8_t load_opcode;
+    uint8_t extension;
+    // Opcode of the form taking an immediate source, 0 if there is none
+    uint8_t immediate_opcode;
+    uint8_t immediate_extension;
+    uint8_t immediate_size;
+} instruction_encoding_t;
+
+static const instruction_encoding_t encodings[] = {
+    [x86_movl] = { encoding_form_source_in_reg, 0, false, {0x89}, 1, 0x8B, 0, 0xC7, 0, 4 },
+    [x86_movq] = { encoding_form_source_in_reg, 0, true, {0x89}, 1, 0x8B, 0, 0xC7, 0, 4 },
+    [x86_movb] = { encoding_form_source_in_reg, 0, false, {0x88}, 1, 0x8A, 0, 0xC6, 0, 1 },
+    [x86_movzbl] = { encoding_form_destination_in_reg, 0, false, {0x0F, 0xB6}, 2 },
+    [x86_movsbl] = { encoding_form_destination_in_reg, 0, false, {0x0F, 0xBE}, 2 },
+    [x86_movslq] = { encoding_form_destination_in_reg, 0, true, {0x63}, 1 },
+    [x86_movss] = { encoding_form_source_in_reg, 0xF3, false, {0x0F, 0x11}, 2, 0x10 },
+    [x86_pushq] = { encoding_form_register_in_opcode, 0, false, {0x50}, 1 },
+    [x86_popq] = { encoding_form_register_in_opcode, 0, false, {0x58}, 1 },
+    [x86_leaq] = { encoding_form_destination_in_reg, 0, true, {0x8D}, 1 },
+    [x86_addl] = { encoding_form_source_in_reg, 0, false, {0x01}, 1, 0x03, 0, 0x81, 0, 4 },
+    [x86_subl] = { encoding_form_source_in_reg, 0, false, {0x29}, 1, 0x2B, 0, 0x81, 5, 4 },
+    [x86_imull] = { encoding_form_destination_in_reg, 0, false, {0x0F, 0xAF}, 2 },
+    [x86_idivl] = { encoding_form_extension, 0, false, {0xF7}, 1, 0, 7 },
+    [x86_cltd] = { encoding_form_none, 0, false, {0x99}, 1 },
+    [x86_cltq] = { encoding_form_none, 0, true, {0x98}, 1 },
+    [x86_cmpl] = { encoding_form_source_in_reg, 0, false, {0x39}, 1, 0x3B, 0, 0x81, 7, 4 },
+    [x86_testb] = { encoding_form_source_in_reg, 0, false, {0x84}, 1, 0x84 },
+    [x86_sete] = { encoding_form_extension, 0, false, {0x0F, 0x94}, 2 },
+    [x86_setne] = { encoding_form_extension, 0, false, {0x0F, 0x95}, 2 },
+    [x86_setg] = { encoding_form_extension, 0, false, {0x0F, 0x9F}, 2 },
+    [x86_setge] = { encoding_form_extension, 0, false, {0x0F, 0x9D}, 2 },
+    [x86_setl] = { encoding_form_extension, 0, false, {0x0F, 0x9C}, 2 },
+    [x86_setle] = { encoding_form_extension, 0, false, {0x0F, 0x9E}, 2 },
+    [x86_seta] = { encoding_form_extension, 0, false, {0x0F, 0x97}, 2 },
+    [x86_setnb] = { encoding_form_extension, 0, false, {0x0F, 0x93}, 2 },
+    [x86_cmovne] = { encoding_form_destination_in_reg, 0, false, {0x0F, 0x45}, 2 },
+    [x86_addss] = { encoding_form_destination_in_reg, 0xF3, false, {0x0F, 0x58}, 2 },
+    [x86_subss] = { encoding_form_destination_in_reg, 0xF3, false, {0x0F, 0x5C}, 2 },
+    [x86_mulss] = { encoding_form_destination_in_reg, 0xF3, false, {0x0F, 0x59}, 2 },
+    [x86_divss] = { encoding_form_destination_in_reg, 0xF3, false, {0x0F, 0x5E}, 2 },
+    [x86_cvtsi2ss] = { encoding_form_destination_in_reg, 0xF3, false, {0x0F, 0x2A}, 2 },
+    [x86_cvtss2sd] = { encoding_form_destination_in_reg, 0xF3, false, {0x0F, 0x5A}, 2 },
+    [x86_call] = { encoding_form_relative, 0, false, {0xE8}, 1 },
+    [x86_jmp] = { encoding_form_relative, 0, false, {0xE9}, 1 },
+    [x86_je] = { encoding_form_relative, 0, false, {0x0F, 0x84}, 2 },
+    [x86_ret] = { encoding_form_none, 0, false, {0xC3}, 1 }
+};
+
+static const uint8_t register_codes[] = {
+    [x86_no_register] = 0,
+    [x86_eax] = 0,
+    [x86_ecx] = 1,
+    [x86_edx] = 2,
+    [x86_esi] = 6,
+    [x86_edi] = 7,
+    [x86_rax] = 0,
+    [x86_rcx] = 1,
+    [x86_rdx] = 2,
+    [x86_rsp] = 4,
+    [x86_rbp] = 5,
+    [x86_rdi] = 7,
+    [x86_al] = 0,
+    [x86_cl] = 1,
+    [x86_xmm0] = 0
+};
+
+static const char* section_names[] = {
+    [encoder_section_text] = ".text",
+    [encoder_section_data] = ".data",
+    [encoder_section_bss] = ".bss",
+    [encoder_section_rodata] = ".rodata"
+};
+
+typedef struct encoder_buffer {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    size_t alignment;
+} encoder_buffer_t;
+
+/*
+ * References from .text to a symbol, patched in place by encoder_finish
+ * when the symbol ends up in .text and turned into relocations otherwise.
+ */
+typedef struct encoder_fixup {
+    encoder_relocation_type_t type;
+    size_t offset;
+    size_t symbol;
+    int64_t addend;
+} encoder_fixup_t;
+
+struct encoder {
+    encoder_buffer_t sections[encoder_section_count];
+    encoder_section_t current_section;
+    encoder_symbol_t* symbols;
+    size_t symbol_count;
+    size_t symbols_capacity;
+    // Open addressing index from symbol names to the symbols array
+    size_t* slots;
+    size_t slots_capacity;
+    encoder_fixup_t* fixups;
+    size_t fixup_count;
+    size_t fixups_capacity;
+    encoder_relocation_t* relocations;
+    size_t relocation_count;
+};
+
+size_t encoder_find_symbol(encoder_t* encoder, const char* name);
+
+void encoder_grow_symbols(encoder_t* encoder);
+
+void encoder_reserve_bytes(encoder_buffer_t* buffer, size_t size);
+
+void encoder_append_byte(encoder_t* encoder, uint8_t byte);
+
+void encoder_add_fixup(encoder_t* encoder, encoder_relocation_type_t type,
+                       const char* symbol, int64_t addend);
+
+void encoder_prefix_and_opcode(encoder_t* encoder, const instruction_encoding_t* encoding,
+                               uint8_t last_opcode_byte);
+
+void encoder_modrm(encoder_t* encoder, uint8_t reg_field, x86_operand_t operand,
+                   size_t trailing_size);
+
+void encoder_relative(encoder_t* encoder, const instruction_encoding_t* encoding,
+                      x86_operand_t target);
+
+uint8_t scale_bits(int scale);
+
+
+encoder_t* new_encoder() {
+    encoder_t* encoder = calloc(1, sizeof(encoder_t));
+    for(size_t i = 0; i < encoder_section_count; i++) {
+        encoder->sections[i].alignment = 1;
+    }
+    encoder->current_section = encoder_section_text;
+    encoder->symbols_capacity = INITIAL_SYMBOLS_CAPACITY;
+    encoder->symbols = malloc(encoder->symbols_capacity * sizeof(encoder_symbol_t));
+    encoder->slots_capacity = 2 * INITIAL_SYMBOLS_CAPACITY;
+    encoder->slots = malloc(encoder->slots_capacity * sizeof(size_t));
+    for(size_t i = 0; i < encoder->slots_capacity; i++) {
+        encoder->slots[i] = EMPTY_SLOT;
+    }
+    return encoder;
+}
+
+
+void delete_encoder(encoder_t* encoder) {
+    if(encoder == NULL) {
+        return;
+    }
+    for(size_t i = 0; i < encoder_section_count; i++) {
+        free(encoder->sections[i].data);
+    }
+    for(size_t i = 0; i < encoder->symbol_count; i++) {
+        free(encoder->symbols[i].name);
+    }
+    free(encoder->symbols);
+    free(encoder->slots);
+    free(encoder->fixups);
+    free(encoder->relocations);
+    free(encoder);
+}
+
+
+void encoder_switch_section(encoder_t* encoder, encoder_section_t section) {
+    encoder->current_section = section;
+}
+
+
+void encoder_define_label(encoder_t* encoder, const char* name) {
+    // Looked up first, since adding the symbol may move the array
+    size_t index = encoder_find_symbol(encoder, name);
+    encoder_symbol_t* symbol = &encoder->symbols[index];
+    symbol->section = encoder->current_section;
+    symbol->offset = encoder->sections[encoder->current_section].size;
+}
+
+
+void encoder_set_global(encoder_t* encoder, const char* name) {
+    size_t index = encoder_find_symbol(encoder, name);
+    encoder->symbols[index].global = true;
+}
+
+
+void encoder_set_object(encoder_t* encoder, const char* name) {
+    size_t index = encoder_find_symbol(encoder, name);
+    encoder->symbols[index].object = true;
+}
+
+
+void encoder_set_size(encoder_t* encoder, const char* name, size_t size) {
+    size_t index = encoder_find_symbol(encoder, name);
+    encoder->symbols[index].size = size;
+}
+
+
+void encoder_align(encoder_t* encoder, size_t alignment) {
+    if(alignment <= 1) {
+        return;
+    }
+    encoder_buffer_t* buffer = &encoder->sections[encoder->current_section];
+    if(alignment > buffer->alignment) {
+        buffer->alignment = alignment;
+    }
+    size_t padding = (alignment - buffer->size % alignment) % alignment;
+    if(encoder->current_section == encoder_section_bss) {
+        buffer->size += padding;
+        return;
+    }
+    uint8_t fill = encoder->current_section == encoder_section_text ? NOP_BYTE : 0;
+    encoder_reserve_bytes(buffer, padding);
+    memset(buffer->data + buffer->size, fill, padding);
+    buffer->size += padding;
+}
+
+
+void encoder_append_bytes(encoder_t* encoder, const void* bytes, size_t size) {
+    encoder_buffer_t* buffer = &encoder->sections[encoder->current_section];
+    encoder_reserve_bytes(buffer, size);
+    memcpy(buffer->data + buffer->size, bytes, size);
+    buffer->size += size;
+}
+
+
+void encoder_append_integer(encoder_t* encoder, int64_t value, size_t size) {
+    uint8_t bytes[8];
+    for(size_t i = 0; i < size; i++) {
+        bytes[i] = (uint64_t)value >> (8 * i);
+    }
+    encoder_append_bytes(encoder, bytes, size);
+}
+
+
+void encoder_append_string_literal(encoder_t* encoder, const char* text) {
+    const char* c = text[0] == '"' ? text + 1 : text;
+    while(*c != '\0' && *c != '"') {
+        if(*c != '\\') {
+            encoder_append_byte(encoder, *c++);
+            continue;
+        }
+        c++;
+        switch(*c) {
+            case 'b': encoder_append_byte(encoder, '\b'); c++; break;
+            case 'f': encoder_append_byte(encoder, '\f'); c++; break;
+            case 'n': encoder_append_byte(encoder, '\n'); c++; break;
+            case 'r': encoder_append_byte(encoder, '\r'); c++; break;
+            case 't': encoder_append_byte(encoder, '\t'); c++; break;
+            case 'x': {
+                uint8_t value = 0;
+                for(c++; *c != '\0' && strchr("0123456789abcdefABCDEF", *c) != NULL; c++) {
+                    value = value * 16 + (*c <= '9' ? *c - '0' : (*c | 0x20) - 'a' + 10);
+                }
+                encoder_append_byte(encoder, value);
+                break;
+            }
+            case '0': case '1': case '2': case '3':
+            case '4': case '5': case '6': case '7': {
+                uint8_t value = 0;
+                for(int digits = 0; digits < 3 && *c >= '0' && *c <= '7'; digits++, c++) {
+                    value = value * 8 + (*c - '0');
+                }
+                encoder_append_byte(encoder, value);
+                break;
+            }
+            case '\0':
+                break;
+            default:
+                encoder_append_byte(encoder, *c++);
+                break;
+        }
+    }
+    encoder_append_byte(encoder, '\0');
+}
+
+
+void encoder_reserve(encoder_t* encoder, const char* name, size_t size, size_t alignment) {
+    encoder_section_t previous_section = encoder->current_section;
+    encoder_switch_section(encoder, encoder_section_bss);
+    encoder_align(encoder, alignment);
+    encoder_define_label(encoder, name);
+    encoder_set_object(encoder, name);
+    encoder_set_size(encoder, name, size);
+    encoder->sections[encoder_section_bss].size += size;
+    encoder_switch_section(encoder, previous_section);
+}
+
+
+void encoder_instruction(encoder_t* encoder, x86_mnemonic_t mnemonic,
+                         size_t operand_count, const x86_operand_t* operands) {
+    const instruction_encoding_t* encoding = &encodings[mnemonic];
+    uint8_t last_opcode_byte = encoding->opcode[encoding->opcode_length - 1];
+
+    switch(encoding->form) {
+        case encoding_form_none:
+            encoder_prefix_and_opcode(encoder, encoding, last_opcode_byte);
+            break;
+        case encoding_form_source_in_reg: {
+            x86_operand_t source = operands[0];
+            x86_operand_t destination = operands[1];
+            if(source.type == x86_operand_immediate) {
+                encoder_prefix_and_opcode(encoder, encoding, encoding->immediate_opcode);
+                encoder_modrm(encoder, encoding->immediate_extension, destination,
+                              encoding->immediate_size);
+                encoder_append_integer(encoder, source.value, encoding->immediate_size);
+            } else if(source.type == x86_operand_memory) {
+                encoder_prefix_and_opcode(encoder, encoding, encoding->load_opcode);
+                encoder_modrm(encoder, register_codes[destination.reg], source, 0);
+            } else {
+                encoder_prefix_and_opcode(encoder, encoding, last_opcode_byte);
+                encoder_modrm(encoder, register_codes[source.reg], destination, 0);
+            }
+            break;
+        }
+        case encoding_form_destination_in_reg:
+            encoder_prefix_and_opcode(encoder, encoding, last_opcode_byte);
+            encoder_modrm(encoder, register_codes[operands[1].reg], operands[0], 0);
+            break;
+        case encoding_form_extension:
+            encoder_prefix_and_opcode(encoder, encoding, last_opcode_byte);
+            encoder_modrm(encoder, encoding->extension, operands[0], 0);
+            break;
+        case encoding_form_register_in_opcode:
+            encoder_prefix_and_opcode(encoder, encoding,
+                                      last_opcode_byte + register_codes[operands[0].reg]);
+            break;
+        case encoding_form_relative:
+            encoder_relative(encoder, encoding, operands[0]);
+            break;
+    }
+}
+
+
+void encoder_finish(encoder_t* encoder) {
+    encoder->relocations = malloc(encoder->fixup_count * sizeof(encoder_relocation_t));
+    encoder->relocation_count = 0;
+    uint8_t* text = encoder->sections[encoder_section_text].data;
+
+    for(size_t i = 0; i < encoder->fixup_count; i++) {
+        encoder_fixup_t* fixup = &encoder->fixups[i];
+        encoder_symbol_t* symbol = &encoder->symbols[fixup->symbol];
+        if(symbol->section == encoder_section_text) {
+            int64_t displacement = symbol->offset + fixup->addend - fixup->offset;
+            for(size_t byte = 0; byte < 4; byte++) {
+                text[fixup->offset + byte] = (uint64_t)displacement >> (8 * byte);
+            }
+            continue;
+        }
+        encoder_relocation_t* relocation = &encoder->relocations[encoder->relocation_count++];
+        relocation->type = fixup->type;
+        relocation->offset = fixup->offset;
+        relocation->symbol = fixup->symbol;
+        relocation->addend = fixup->addend;
+    }
+}
+
+
+const uint8_t* encoder_section_bytes(const encoder_t* encoder, encoder_section_t section) {
+    return encoder->sections[section].data;
+}
+
+
+size_t encoder_section_size(const encoder_t* encoder, encoder_section_t section) {
+    return encoder->sections[section].size;
+}
+
+
+size_t encoder_section_alignment(const encoder_t* encoder, encoder_section_t section) {
+    return encoder->sections[section].alignment;
+}
+
+
+const char* encoder_section_name(encoder_section_t section) {
+    return section_names[section];
+}
+
+
+size_t encoder_symbol_count(const encoder_t* encoder) {
+    return encoder->symbol_count;
+}
+
+
+const encoder_symbol_t* encoder_symbol(const encoder_t* encoder, size_t index) {
+    return &encoder->symbols[index];
+}
+
+
+size_t encoder_relocation_count(const encoder_t* encoder) {
+    return encoder->relocation_count;
+}
+
+
+const encoder_relocation_t* encoder_relocation(const encoder_t* encoder, size_t index) {
+    return &encoder->relocations[index];
+}
+
+
+int64_t encoder_parse_integer(const char* text) {
+    if(text[0] == '\'') {
+        return (unsigned char)text[1];
+    }
+    // Base 0 reads a leading zero as octal, like the assembler does
+    return strtoll(text, NULL, 0);
+}
+
+
+size_t encoder_find_symbol(encoder_t* encoder, const char* name) {
+    size_t mask = encoder->slots_capacity - 1;
+    size_t slot = symbol_table_hash(name, strlen(name)) & mask;
+    while(encoder->slots[slot] != EMPTY_SLOT) {
+        if(strcmp(encoder->symbols[encoder->slots[slot]].name, name) == 0) {
+            return encoder->slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if(encoder->symbol_count == encoder->symbols_capacity) {
+        encoder_grow_symbols(encoder);
+        return encoder_find_symbol(encoder, name);
+    }
+    size_t index = encoder->symbol_count++;
+    encoder_symbol_t* symbol = &encoder->symbols[index];
+    symbol->name = strdup(name);
+    symbol->section = encoder_section_undefined;
+    symbol->offset = 0;
+    symbol->size = 0;
+    symbol->global = false;
+    symbol->object = false;
+    encoder->slots[slot] = index;
+    return index;
+}
+
+
+void encoder_grow_symbols(encoder_t* encoder) {
+    encoder->symbols_capacity *= 2;
+    encoder->symbols = realloc(encoder->symbols, encoder->symbols_capacity * sizeof(encoder_symbol_t));
+
+    // Keeping twice as many slots as symbols bounds the load factor to 1/2
+    encoder->slots_capacity = 2 * encoder->symbols_capacity;
+    encoder->slots = realloc(encoder->slots, encoder->slots_capacity * sizeof(size_t));
+    size_t mask = encoder->slots_capacity - 1;
+    for(size_t i = 0; i < encoder->slots_capacity; i++) {
+        encoder->slots[i] = EMPTY_SLOT;
+    }
+    for(size_t i = 0; i < encoder->symbol_count; i++) {
+        const char* name = encoder->symbols[i].name;
+        size_t slot = symbol_table_hash(name, strlen(name)) & mask;
+        while(encoder->slots[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+        encoder->slots[slot] = i;
+    }
+}
+
+
+void encoder_reserve_bytes(encoder_buffer_t* buffer, size_t size) {
+    if(buffer->size + size <= buffer->capacity) {
+        return;
+    }
+    size_t capacity = buffer->capacity == 0 ? INITIAL_BUFFER_CAPACITY : buffer->capacity;
+    while(capacity < buffer->size + size) {
+        capacity *= 2;
+    }
+    buffer->data = realloc(buffer->data, capacity);
+    buffer->capacity = capacity;
+}
+
+
+void encoder_append_byte(encoder_t* encoder, uint8_t byte) {
+    encoder_append_bytes(encoder, &byte, 1);
+}
+
+
+void encoder_add_fixup(encoder_t* encoder, encoder_relocation_type_t type,
+                       const char* symbol, int64_t addend) {
+    if(encoder->fixup_count == encoder->fixups_capacity) {
+        encoder->fixups_capacity = encoder->fixups_capacity == 0 ? INITIAL_SYMBOLS_CAPACITY
+                                                                 : 2 * encoder->fixups_capacity;
+        encoder->fixups = realloc(encoder->fixups, encoder->fixups_capacity * sizeof(encoder_fixup_t));
+    }
+    encoder_fixup_t* fixup = &encoder->fixups[encoder->fixup_count++];
+    fixup->type = type;
+    fixup->offset = encoder->sections[encoder_section_text].size;
+    fixup->symbol = encoder_find_symbol(encoder, symbol);
+    fixup->addend = addend;
+    encoder_append_integer(encoder, 0, 4);
+}
+
+
+void encoder_prefix_and_opcode(encoder_t* encoder, const instruction_encoding_t* encoding,
+                               uint8_t last_opcode_byte) {
+    if(encoding->prefix != 0) {
+        encoder_append_byte(encoder, encoding->prefix);
+    }
+    if(encoding->rex_w) {
+        encoder_append_byte(encoder, REX_W);
+    }
+    if(encoding->opcode_length == 2) {
+        encoder_append_byte(encoder, encoding->opcode[0]);
+    }
+    encoder_append_byte(encoder, last_opcode_byte);
+}
+
+
+void encoder_modrm(encoder_t* encoder, uint8_t reg_field, x86_operand_t operand,
+                   size_t trailing_size) {
+    uint8_t reg_bits = reg_field << 3;
+
+    if(operand.type == x86_operand_register) {
+        encoder_append_byte(encoder, MODRM_DIRECT | reg_bits | register_codes[operand.reg]);
+        return;
+    }
+
+    if(operand.symbol != NULL) {
+        // The displacement is relative to the end of the instruction, which
+        // may still have an immediate after the displacement field
+        encoder_append_byte(encoder, MODRM_RIP_RELATIVE | reg_bits);
+        encoder_add_fixup(encoder, encoder_relocation_pc32, operand.symbol,
+                          -4 - (int64_t)trailing_size);
+        return;
+    }
+
+    if(operand.reg == x86_no_register) {
+        uint8_t index = operand.index == x86_no_register ? SIB_NO_INDEX : register_codes[operand.index];
+        encoder_append_byte(encoder, MODRM_SIB | reg_bits);
+        encoder_append_byte(encoder, scale_bits(operand.scale) << 6 | index << 3 | SIB_NO_BASE);
+        encoder_append_integer(encoder, operand.value, 4);
+        return;
+    }
+
+    uint8_t base = register_codes[operand.reg];
+    uint8_t mod;
+    if(operand.value == 0 && base != FRAME_POINTER_CODE) {
+        mod = 0x00;
+    } else if(operand.value >= INT8_MIN && operand.value <= INT8_MAX) {
+        mod = 0x40;
+    } else {
+        mod = 0x80;
+    }
+
+    if(operand.index != x86_no_register || base == STACK_POINTER_CODE) {
+        uint8_t index = operand.index == x86_no_register ? SIB_NO_INDEX : register_codes[operand.index];
+        encoder_append_byte(encoder, mod | reg_bits | MODRM_SIB);
+        encoder_append_byte(encoder, scale_bits(operand.scale) << 6 | index << 3 | base);
+    } else {
+        encoder_append_byte(encoder, mod | reg_bits | base);
+    }
+
+    if(mod == 0x40) {
+        encoder_append_integer(encoder, operand.value, 1);
+    } else if(mod == 0x80) {
+        encoder_append_integer(encoder, operand.value, 4);
+    }
+}
+
+
+void encoder_relative(encoder_t* encoder, const instruction_encoding_t* encoding,
+                      x86_operand_t target) {
+    encoder_prefix_and_opcode(encoder, encoding, encoding->opcode[encoding->opcode_length - 1]);
+    if(target.target_type != x86_target_function_end) {
+        encoder_add_fixup(encoder, encoder_relocation_plt32, target.symbol, -4);
+        return;
+    }
+    size_t length = strlen(target.symbol);
+    char* name = malloc(length + 6);
+    name[0] = '.';
+    memcpy(name + 1, target.symbol, length);
+    memcpy(name + 1 + length, "_end", 5);
+    encoder_add_fixup(encoder, encoder_relocation_plt32, name, -4);
+    free(name);
+}
+
+
+uint8_t scale_bits(int scale) {
+    switch(scale) {
+        case 2:
+            return 1;
+        case 4:
+            return 2;
+        case 8:
+            return 3;
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "emitter.h"
+
+/*
+ * Assembles the emitter's instructions and directives into x86-64 machine
+ * code. Code and data are kept per section together with a symbol table and
+ * the relocations left for the linker, ready to be written as a relocatable
+ * object or loaded in memory.
+ */
+
+typedef struct encoder encoder_t;
+
+typedef enum encoder_section {
+    encoder_section_text,
+    encoder_section_data,
+    encoder_section_bss,
+    encoder_section_rodata,
+    encoder_section_count,
+    // Symbols that are referenced but not defined in this file
+    encoder_section_undefined = encoder_section_count
+} encoder_section_t;
+
+typedef enum encoder_relocation_type {
+    // 32 bit displacement from the end of the field to a symbol
+    encoder_relocation_pc32,
+    // Same, for calls that may go through the procedure linkage table
+    encoder_relocation_plt32
+} encoder_relocation_type_t;
+
+typedef struct encoder_symbol {
+    char* name;
+    encoder_section_t section;
+    size_t offset;
+    size_t size;
+    bool global;
+    bool object;
+} encoder_symbol_t;
+
+// Relocations are always applied to .text
+typedef struct encoder_relocation {
+    encoder_relocation_type_t type;
+    size_t offset;
+    size_t symbol;
+    int64_t addend;
+} encoder_relocation_t;
+
+encoder_t* new_encoder();
+
+void delete_encoder(encoder_t* encoder);
+
+void encoder_switch_section(encoder_t* encoder, encoder_section_t section);
+
+void encoder_define_label(encoder_t* encoder, const char* name);
+
+void encoder_set_global(encoder_t* encoder, const char* name);
+
+void encoder_set_object(encoder_t* encoder, const char* name);
+
+void encoder_set_size(encoder_t* encoder, const char* name, size_t size);
+
+void encoder_align(encoder_t* encoder, size_t alignment);
+
+void encoder_append_bytes(encoder_t* encoder, const void* bytes, size_t size);
+
+void encoder_append_integer(encoder_t* encoder, int64_t value, size_t size);
+
+// Appends the bytes of an assembler string, quotes included, and a terminator
+void encoder_append_string_literal(encoder_t* encoder, const char* text);
+
+// Allocates zero filled storage for the symbol in .bss
+void encoder_reserve(encoder_t* encoder, const char* name, size_t size, size_t alignment);
+
+void encoder_instruction(encoder_t* encoder, x86_mnemonic_t mnemonic,
+                         size_t operand_count, const x86_operand_t* operands);
+
+// Resolves branches between labels of .text. Must be called once, after the
+// last instruction and before the sections are read.
+void encoder_finish(encoder_t* encoder);
+
+const uint8_t* encoder_section_bytes(const encoder_t* encoder, encoder_section_t section);
+
+size_t encoder_section_size(const encoder_t* encoder, encoder_section_t section);
+
+size_t encoder_section_alignment(const encoder_t* encoder, encoder_section_t section);
+
+const char* encoder_section_name(encoder_section_t section);
+
+size_t encoder_symbol_count(const encoder_t* encoder);
+
+const encoder_symbol_t* encoder_symbol(const encoder_t* encoder, size_t index);
+
+size_t encoder_relocation_count(const encoder_t* encoder);
+
+const encoder_relocation_t* encoder_relocation(const encoder_t* encoder, size_t index);
+
+// Value of an integer or character constant as the assembler reads it
+int64_t encoder_parse_integer(const char* text);
+
+#endif
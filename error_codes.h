@@ -5,5 +5,7 @@
 #define FILE_OPEN_ERROR 2
 #define SYNTAX_ERROR 3
 #define SEMANTIC_ERROR 4
+#define BATCH_ERROR 5
+#define OUTPUT_ERROR 6
 
 #endif
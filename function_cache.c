@@ -0,0 +1,353 @@
+#include "function_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "allocation.h"
+
+// Changing the code generators must change this, or stale entries would
+// be reused
+#define FUNCTION_CACHE_FORMAT "etapa6 function cache 3"
+#define FUNCTION_CACHE_KEY_LENGTH 32
+#define FNV_PRIME 0x100000001B3ULL
+
+typedef struct function_key {
+    char* function;
+    char key[FUNCTION_CACHE_KEY_LENGTH + 1];
+} function_key_t;
+
+// Two FNV-1a lanes started from different offsets, 128 bits in all
+typedef struct function_hash {
+    uint64_t lanes[2];
+} function_hash_t;
+
+// Global variable initialized with a literal
+typedef struct global_value {
+    symbol_t* variable;
+    symbol_t* value;
+    bool assigned;
+} global_value_t;
+
+struct function_cache {
+    char* directory;
+    bool optimized;
+    function_key_t* keys;
+    size_t key_count;
+    size_t key_capacity;
+    // Sorted by variable
+    global_value_t* globals;
+    size_t global_count;
+    size_t global_capacity;
+};
+
+void function_cache_add_globals(function_cache_t* cache, ast_node_t* node);
+
+void function_cache_mark_assignments(function_cache_t* cache, ast_node_t* node);
+
+global_value_t* function_cache_find_global(const function_cache_t* cache, symbol_t* variable);
+
+void function_cache_add_functions(function_cache_t* cache, ast_node_t* node);
+
+void function_hash_node(const function_cache_t* cache, function_hash_t* hash, ast_node_t* node);
+
+void function_hash_symbol(const function_cache_t* cache, function_hash_t* hash, symbol_t* symbol);
+
+void function_hash_bytes(function_hash_t* hash, const void* data, size_t size);
+
+void function_hash_integer(function_hash_t* hash, uint64_t value);
+
+void function_hash_string(function_hash_t* hash, const char* string);
+
+const function_key_t* function_cache_find(const function_cache_t* cache, const char* function);
+
+char* function_cache_path(const function_cache_t* cache, const function_key_t* key, const char* suffix);
+
+int compare_function_keys(const void* first, const void* second);
+
+int compare_global_values(const void* first, const void* second);
+
+
+function_cache_t* new_function_cache(const char* directory, ast_t* ast, bool optimized) {
+    if(mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        return NULL;
+    }
+
+    function_cache_t* cache = allocate(allocation_function_cache, sizeof(function_cache_t));
+    cache->directory = allocate_string(directory);
+    cache->optimized = optimized;
+    cache->keys = NULL;
+    cache->key_count = 0;
+    cache->key_capacity = 0;
+    cache->globals = NULL;
+    cache->global_count = 0;
+    cache->global_capacity = 0;
+    if(optimized) {
+        function_cache_add_globals(cache, ast_get_root(ast));
+        qsort(cache->globals, cache->global_count, sizeof(global_value_t), &compare_global_values);
+        function_cache_mark_assignments(cache, ast_get_root(ast));
+    }
+    function_cache_add_functions(cache, ast_get_root(ast));
+    qsort(cache->keys, cache->key_count, sizeof(function_key_t), &compare_function_keys);
+    return cache;
+}
+
+
+void delete_function_cache(function_cache_t* cache) {
+    if(cache == NULL) {
+        return;
+    }
+    for(size_t i = 0; i < cache->key_count; i++) {
+        release(allocation_string, cache->keys[i].function);
+    }
+    release(allocation_function_cache, cache->keys);
+    release(allocation_function_cache, cache->globals);
+    release(allocation_string, cache->directory);
+    release(allocation_function_cache, cache);
+}
+
+
+char* function_cache_load(const function_cache_t* cache, const char* function, size_t* size) {
+    const function_key_t* key = function_cache_find(cache, function);
+    if(key == NULL) {
+        return NULL;
+    }
+    char* path = function_cache_path(cache, key, NULL);
+    int descriptor = open(path, O_RDONLY);
+    release(allocation_string, path);
+    if(descriptor == -1) {
+        return NULL;
+    }
+
+    struct stat status;
+    char* text = NULL;
+    if(fstat(descriptor, &status) == 0) {
+        text = allocate(allocation_assembly, status.st_size + 1);
+        size_t read_size = 0;
+        while(read_size < (size_t)status.st_size) {
+            ssize_t result = read(descriptor, text + read_size, status.st_size - read_size);
+            if(result <= 0) {
+                break;
+            }
+            read_size += result;
+        }
+        if(read_size != (size_t)status.st_size) {
+            release(allocation_assembly, text);
+            text = NULL;
+        }
+        *size = read_size;
+    }
+    close(descriptor);
+    return text;
+}
+
+
+void function_cache_store(const function_cache_t* cache, const char* function,
+                          const char* text, size_t size) {
+    const function_key_t* key = function_cache_find(cache, function);
+    if(key == NULL) {
+        return;
+    }
+    // Readers only ever see complete entries: the text is written to a
+    // unique temporary file first and then renamed over the entry
+    char* temporary_path = function_cache_path(cache, key, ".XXXXXX");
+    int descriptor = mkstemp(temporary_path);
+    if(descriptor == -1) {
+        release(allocation_string, temporary_path);
+        return;
+    }
+    size_t written = 0;
+    while(written < size) {
+        ssize_t result = write(descriptor, text + written, size - written);
+        if(result <= 0) {
+            break;
+        }
+        written += result;
+    }
+    close(descriptor);
+
+    char* path = function_cache_path(cache, key, NULL);
+    if(written != size || rename(temporary_path, path) == -1) {
+        unlink(temporary_path);
+    }
+    release(allocation_string, path);
+    release(allocation_string, temporary_path);
+}
+
+
+void function_cache_add_functions(function_cache_t* cache, ast_node_t* node) {
+    if(node == NULL) {
+        return;
+    }
+    if(ast_node_get_type(node) != ast_func_decl) {
+        ast_list_t* children = ast_node_get_children(node);
+        for(list_iterator_t it = list_begin(children); list_current(it) != NULL; list_next(&it)) {
+            function_cache_add_functions(cache, list_current(it));
+        }
+        return;
+    }
+
+    function_hash_t hash = { { 0xCBF29CE484222325ULL, 0x84222325CBF29CE4ULL } };
+    function_hash_string(&hash, FUNCTION_CACHE_FORMAT);
+    function_hash_integer(&hash, cache->optimized);
+    function_hash_node(cache, &hash, node);
+
+    if(cache->key_count == cache->key_capacity) {
+        cache->key_capacity = cache->key_capacity > 0 ? 2 * cache->key_capacity : 16;
+        cache->keys = reallocate(allocation_function_cache, cache->keys,
+                                 cache->key_capacity * sizeof(function_key_t));
+    }
+    function_key_t* key = &cache->keys[cache->key_count++];
+    // The function's scope is the function itself
+    key->function = allocate_string(ast_node_get_scope(node)->value);
+    snprintf(key->key, sizeof(key->key), "%016llx%016llx",
+             (unsigned long long)hash.lanes[0], (unsigned long long)hash.lanes[1]);
+}
+
+
+void function_cache_add_globals(function_cache_t* cache, ast_node_t* node) {
+    if(node == NULL || ast_node_get_type(node) == ast_func_decl) {
+        return;
+    }
+    ast_list_t* children = ast_node_get_children(node);
+    if(ast_node_get_type(node) == ast_int_decl || ast_node_get_type(node) == ast_char_decl) {
+        if(cache->global_count == cache->global_capacity) {
+            cache->global_capacity = cache->global_capacity > 0 ? 2 * cache->global_capacity : 16;
+            cache->globals = reallocate(allocation_function_cache, cache->globals,
+                                        cache->global_capacity * sizeof(global_value_t));
+        }
+        list_iterator_t it = list_begin(children);
+        global_value_t* global = &cache->globals[cache->global_count++];
+        global->variable = ast_node_get_symbol(list_current(it));
+        global->value = ast_node_get_symbol(list_current(list_next(&it)));
+        global->assigned = false;
+        return;
+    }
+    for(list_iterator_t it = list_begin(children); list_current(it) != NULL; list_next(&it)) {
+        function_cache_add_globals(cache, list_current(it));
+    }
+}
+
+
+void function_cache_mark_assignments(function_cache_t* cache, ast_node_t* node) {
+    if(node == NULL) {
+        return;
+    }
+    ast_list_t* children = ast_node_get_children(node);
+    if(ast_node_get_type(node) == ast_assign) {
+        global_value_t* global = function_cache_find_global(cache, ast_node_get_symbol(list_front(children)));
+        if(global != NULL) {
+            global->assigned = true;
+        }
+    }
+    for(list_iterator_t it = list_begin(children); list_current(it) != NULL; list_next(&it)) {
+        function_cache_mark_assignments(cache, list_current(it));
+    }
+}
+
+
+global_value_t* function_cache_find_global(const function_cache_t* cache, symbol_t* variable) {
+    global_value_t wanted;
+    wanted.variable = variable;
+    return bsearch(&wanted, cache->globals, cache->global_count, sizeof(global_value_t),
+                   &compare_global_values);
+}
+
+
+void function_hash_node(const function_cache_t* cache, function_hash_t* hash, ast_node_t* node) {
+    if(node == NULL) {
+        function_hash_integer(hash, UINT64_MAX);
+        return;
+    }
+    ast_list_t* children = ast_node_get_children(node);
+    function_hash_integer(hash, ast_node_get_type(node));
+    function_hash_integer(hash, ast_node_get_evaluated_data_type(node));
+    function_hash_integer(hash, list_size(children));
+    if(ast_node_get_type(node) == ast_symbol) {
+        function_hash_symbol(cache, hash, ast_node_get_symbol(node));
+    }
+    for(list_iterator_t it = list_begin(children); list_current(it) != NULL; list_next(&it)) {
+        function_hash_node(cache, hash, list_current(it));
+    }
+}
+
+
+// Globals contribute their signature, so that the callers of a function
+// whose parameters change are generated again, and their value when the
+// optimizer may fold it
+void function_hash_symbol(const function_cache_t* cache, function_hash_t* hash, symbol_t* symbol) {
+    function_hash_string(hash, symbol->value);
+    function_hash_integer(hash, symbol->type);
+    function_hash_integer(hash, symbol->data_type);
+    if(symbol->scope == SYMBOL_SCOPE_GLOBAL && symbol->type == symbol_variable && cache->global_count > 0) {
+        const global_value_t* global = function_cache_find_global(cache, symbol);
+        if(global != NULL && !global->assigned) {
+            function_hash_string(hash, global->value->value);
+        }
+    }
+    if(symbol->scope != SYMBOL_SCOPE_GLOBAL || symbol->parameters == NULL) {
+        return;
+    }
+    function_hash_integer(hash, list_size(symbol->parameters));
+    for(list_iterator_t it = list_begin(symbol->parameters); list_current(it) != NULL; list_next(&it)) {
+        symbol_t* parameter = list_current(it);
+        function_hash_string(hash, parameter->value);
+        function_hash_integer(hash, parameter->data_type);
+    }
+}
+
+
+void function_hash_bytes(function_hash_t* hash, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    for(size_t i = 0; i < size; i++) {
+        hash->lanes[0] = (hash->lanes[0] ^ bytes[i]) * FNV_PRIME;
+        hash->lanes[1] = (hash->lanes[1] ^ bytes[size - i - 1]) * FNV_PRIME;
+    }
+}
+
+
+void function_hash_integer(function_hash_t* hash, uint64_t value) {
+    function_hash_bytes(hash, &value, sizeof(value));
+}
+
+
+// Strings are hashed with their terminator, so that consecutive strings
+// can't run into each other
+void function_hash_string(function_hash_t* hash, const char* string) {
+    function_hash_bytes(hash, string, strlen(string) + 1);
+}
+
+
+const function_key_t* function_cache_find(const function_cache_t* cache, const char* function) {
+    function_key_t wanted;
+    wanted.function = (char*)function;
+    return bsearch(&wanted, cache->keys, cache->key_count, sizeof(function_key_t),
+                   &compare_function_keys);
+}
+
+
+char* function_cache_path(const function_cache_t* cache, const function_key_t* key, const char* suffix) {
+    if(suffix == NULL) {
+        suffix = ".s";
+    }
+    size_t length = strlen(cache->directory) + 1 + FUNCTION_CACHE_KEY_LENGTH + strlen(suffix);
+    char* path = allocate(allocation_string, length + 1);
+    snprintf(path, length + 1, "%s/%s%s", cache->directory, key->key, suffix);
+    return path;
+}
+
+
+int compare_function_keys(const void* first, const void* second) {
+    return strcmp(((const function_key_t*)first)->function, ((const function_key_t*)second)->function);
+}
+
+
+int compare_global_values(const void* first, const void* second) {
+    uintptr_t first_variable = (uintptr_t)((const global_value_t*)first)->variable;
+    uintptr_t second_variable = (uintptr_t)((const global_value_t*)second)->variable;
+    return first_variable < second_variable ? -1 : first_variable > second_variable;
+}
@@ -0,0 +1,37 @@
+#ifndef FUNCTION_CACHE_H
+#define FUNCTION_CACHE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "syntax_tree.h"
+
+/*
+ * On-disk cache of the assembly generated for each function. A function's
+ * key hashes its checked syntax tree together with the type and parameters
+ * of every global it references, which is all its code depends on now that
+ * temps, labels and literals are numbered per function. The optimizer
+ * folds globals that are initialized with a literal and never assigned, so
+ * with it their values are hashed too. Entries are files
+ * named after the key, written atomically so that concurrent compilations
+ * may share a directory.
+ */
+typedef struct function_cache function_cache_t;
+
+// Keys every function of the tree, which must have passed the semantic
+// checks, for code that is optimized or not. Returns NULL and sets errno if
+// the directory can't be created.
+function_cache_t* new_function_cache(const char* directory, ast_t* ast, bool optimized);
+
+void delete_function_cache(function_cache_t* cache);
+
+// Assembly stored for the function, to be released by the caller as
+// allocation_assembly, or NULL
+char* function_cache_load(const function_cache_t* cache, const char* function, size_t* size);
+
+// Failing to store an entry is not an error, the function is generated
+// again next time
+void function_cache_store(const function_cache_t* cache, const char* function,
+                          const char* text, size_t size);
+
+#endif
@@ -0,0 +1,175 @@
+#include "jit.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define ENTRY_POINT "main"
+// jmp *0(%rip) followed by the absolute address it jumps to
+#define STUB_SIZE 16
+#define NO_STUB SIZE_MAX
+
+typedef struct host_function {
+    const char* name;
+    void* address;
+} host_function_t;
+
+static const host_function_t host_functions[] = {
+    { "printf", (void*)&printf },
+    { "putchar", (void*)&putchar },
+    { "getchar", (void*)&getchar }
+};
+
+struct jit_program {
+    uint8_t* mapping;
+    size_t mapping_size;
+    int (*entry)(void);
+};
+
+void* find_host_function(const char* name);
+
+size_t round_up(size_t size, size_t alignment);
+
+
+jit_program_t* new_jit_program(compilation_context_t* context, const encoder_t* encoder) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t symbol_count = encoder_symbol_count(encoder);
+
+    // Every library function the program calls gets a stub after the code
+    size_t* stubs = malloc((symbol_count + 1) * sizeof(size_t));
+    size_t stub_count = 0;
+    for(size_t i = 0; i < symbol_count; i++) {
+        const encoder_symbol_t* symbol = encoder_symbol(encoder, i);
+        if(symbol->section != encoder_section_undefined) {
+            stubs[i] = NO_STUB;
+            continue;
+        }
+        if(find_host_function(symbol->name) == NULL) {
+            compilation_error(context, compilation_phase_code_generation, 0,
+                              "Undefined symbol %s", symbol->name);
+            free(stubs);
+            return NULL;
+        }
+        stubs[i] = stub_count++;
+    }
+
+    // Code and stubs, read only data and writable data each start on their
+    // own page, so that every part gets its own protection
+    size_t section_offsets[encoder_section_count];
+    size_t text_size = encoder_section_size(encoder, encoder_section_text);
+    size_t stubs_offset = round_up(text_size, STUB_SIZE);
+    size_t code_end = stubs_offset + stub_count * STUB_SIZE;
+    section_offsets[encoder_section_text] = 0;
+    section_offsets[encoder_section_rodata] = round_up(code_end, page_size);
+    size_t rodata_end = section_offsets[encoder_section_rodata] +
+                        encoder_section_size(encoder, encoder_section_rodata);
+    section_offsets[encoder_section_data] = round_up(rodata_end, page_size);
+    size_t data_end = section_offsets[encoder_section_data] +
+                      encoder_section_size(encoder, encoder_section_data);
+    section_offsets[encoder_section_bss] = round_up(data_end,
+                                                    encoder_section_alignment(encoder, encoder_section_bss));
+    size_t mapping_size = round_up(section_offsets[encoder_section_bss] +
+                                   encoder_section_size(encoder, encoder_section_bss) + 1, page_size);
+
+    uint8_t* mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mapping == MAP_FAILED) {
+        compilation_error(context, compilation_phase_code_generation, 0,
+                          "Could not map memory for the program");
+        free(stubs);
+        return NULL;
+    }
+
+    for(encoder_section_t section = 0; section < encoder_section_count; section++) {
+        if(section != encoder_section_bss && encoder_section_size(encoder, section) > 0) {
+            memcpy(mapping + section_offsets[section], encoder_section_bytes(encoder, section),
+                   encoder_section_size(encoder, section));
+        }
+    }
+
+    for(size_t i = 0; i < symbol_count; i++) {
+        if(stubs[i] == NO_STUB) {
+            continue;
+        }
+        uint8_t* stub = mapping + stubs_offset + stubs[i] * STUB_SIZE;
+        uint64_t address = (uintptr_t)find_host_function(encoder_symbol(encoder, i)->name);
+        static const uint8_t indirect_jump[] = { 0xFF, 0x25, 0x00, 0x00, 0x00, 0x00 };
+        memcpy(stub, indirect_jump, sizeof(indirect_jump));
+        memcpy(stub + sizeof(indirect_jump), &address, sizeof(address));
+    }
+
+    // Everything lives in one mapping, so every displacement fits 32 bits
+    for(size_t i = 0; i < encoder_relocation_count(encoder); i++) {
+        const encoder_relocation_t* relocation = encoder_relocation(encoder, i);
+        const encoder_symbol_t* symbol = encoder_symbol(encoder, relocation->symbol);
+        size_t target = stubs[relocation->symbol] != NO_STUB
+                        ? stubs_offset + stubs[relocation->symbol] * STUB_SIZE
+                        : section_offsets[symbol->section] + symbol->offset;
+        int32_t displacement = (int64_t)target + relocation->addend - (int64_t)relocation->offset;
+        memcpy(mapping + relocation->offset, &displacement, sizeof(displacement));
+    }
+    free(stubs);
+
+    if(mprotect(mapping, section_offsets[encoder_section_rodata], PROT_READ | PROT_EXEC) != 0 ||
+       mprotect(mapping + section_offsets[encoder_section_rodata],
+                section_offsets[encoder_section_data] - section_offsets[encoder_section_rodata],
+                PROT_READ) != 0) {
+        compilation_error(context, compilation_phase_code_generation, 0,
+                          "Could not protect the program: %s", strerror(errno));
+        munmap(mapping, mapping_size);
+        return NULL;
+    }
+
+    jit_program_t* program = malloc(sizeof(jit_program_t));
+    program->mapping = mapping;
+    program->mapping_size = mapping_size;
+    program->entry = NULL;
+    for(size_t i = 0; i < symbol_count; i++) {
+        const encoder_symbol_t* symbol = encoder_symbol(encoder, i);
+        if(symbol->section == encoder_section_text && strcmp(symbol->name, ENTRY_POINT) == 0) {
+            program->entry = (int (*)(void))(mapping + symbol->offset);
+        }
+    }
+    if(program->entry == NULL) {
+        compilation_error(context, compilation_phase_code_generation, 0,
+                          "The program has no %s function", ENTRY_POINT);
+        delete_jit_program(program);
+        return NULL;
+    }
+    return program;
+}
+
+
+void delete_jit_program(jit_program_t* program) {
+    if(program == NULL) {
+        return;
+    }
+    munmap(program->mapping, program->mapping_size);
+    free(program);
+}
+
+
+int jit_program_run(jit_program_t* program) {
+    int status = program->entry();
+    fflush(stdout);
+    return status;
+}
+
+
+void* find_host_function(const char* name) {
+    for(size_t i = 0; i < sizeof(host_functions) / sizeof(host_functions[0]); i++) {
+        if(strcmp(host_functions[i].name, name) == 0) {
+            return host_functions[i].address;
+        }
+    }
+    return NULL;
+}
+
+
+size_t round_up(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
@@ -0,0 +1,24 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "compilation_context.h"
+#include "encoder.h"
+
+/*
+ * Program loaded into this process from a finished encoder. Code, read only
+ * data and globals are copied to one private mapping, relocations are
+ * applied against it and calls to the C library go through small stubs to
+ * the host's printf, putchar and getchar.
+ */
+typedef struct jit_program jit_program_t;
+
+// Returns NULL after reporting a code generation diagnostic if the program
+// can't be loaded
+jit_program_t* new_jit_program(compilation_context_t* context, const encoder_t* encoder);
+
+void delete_jit_program(jit_program_t* program);
+
+// Calls the program's main and returns its result once stdout is flushed
+int jit_program_run(jit_program_t* program);
+
+#endif
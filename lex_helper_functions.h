@@ -2,14 +2,28 @@
 #define LEX_HELPER_FUNCTIONS_H
 
 #include <stdbool.h>
+#include <stdio.h>
 
-#include "symbol_table.h"
+#include "compilation_context.h"
 
-int getLineNumber(void);
+int getLineNumber(compilation_context_t* context);
 
-bool isRunning(void);
+bool isRunning(compilation_context_t* context);
 
-void lex_init(symbol_table_t* table, int print_parser_steps, 
+void lex_init(compilation_context_t* context, int print_parser_steps, 
               int print_scanner_steps);
 
+void lex_set_input(compilation_context_t* context, FILE* stream);
+
+// The source is copied, so it does not need to outlive the call
+void lex_set_input_buffer(compilation_context_t* context, const char* source, size_t length);
+
+/*
+ * Scans the buffer without copying it. Its last two bytes must be NUL and
+ * belong to size; the scanner writes into it while running.
+ */
+void lex_set_input_in_place(compilation_context_t* context, char* buffer, size_t size);
+
+void lex_destroy(compilation_context_t* context);
+
 #endif
@@ -2,9 +2,12 @@
 
 #include <stdlib.h>
 
+#include "allocation.h"
+
 
 struct list {
     size_t size;
+    arena_t* arena;
     list_node_t* first;
     list_node_t* last;
 };
@@ -15,12 +18,29 @@ struct list_node {
     list_node_t* next;
 };
 
+list_node_t* list_allocate_node(list_t* list);
+
+void list_free_node(list_t* list, list_node_t* node);
+
+void list_clear_nodes(list_t* list);
+
 
 list_t* new_list() {
-    list_t* new_list = malloc(sizeof(list_t));
+    list_t* new_list = allocate(allocation_list, sizeof(list_t));
+    new_list->first = NULL;
+    new_list->last = NULL;
+    new_list->size = 0;
+    new_list->arena = NULL;
+    return new_list;
+}
+
+
+list_t* new_list_in_arena(arena_t* arena) {
+    list_t* new_list = arena_allocate(arena, sizeof(list_t));
     new_list->first = NULL;
     new_list->last = NULL;
     new_list->size = 0;
+    new_list->arena = arena;
     return new_list;
 }
 
@@ -36,12 +56,14 @@ void delete_list(list_t* list, void (*element_destructor)(list_element_t*)) {
         }
         list_pop_front(list);
     }
-    free(list);
+    if(list->arena == NULL) {
+        release(allocation_list, list);
+    }
 }
 
 
 void list_push_front(list_t* list, list_element_t* element) {
-    list_node_t* new_node = malloc(sizeof(list_node_t));
+    list_node_t* new_node = list_allocate_node(list);
     new_node->element = element;
     new_node->next = list->first;
     if(list->first != NULL) {
@@ -57,7 +79,7 @@ void list_push_front(list_t* list, list_element_t* element) {
 
 
 void list_push_back(list_t* list, list_element_t* element) {
-    list_node_t* new_node = malloc(sizeof(list_node_t));
+    list_node_t* new_node = list_allocate_node(list);
     new_node->element = element;
     new_node->next = NULL;
     if(list->last != NULL) {
@@ -75,47 +97,89 @@ void list_push_back(list_t* list, list_element_t* element) {
 void list_pop_front(list_t* list) {
     list_node_t* node_to_pop = list->first;
     if(list_size(list) <= 1) {
-        list->first=NULL;
+        list->first = NULL;
+        list->last = NULL;
     } else {
         list->first = list->first->next;
         list->first->previous = NULL;
     }
     list->size -= list->size < 1 ? 0 : 1;
-    free(node_to_pop);
+    list_free_node(list, node_to_pop);
 }
 
 
 void list_pop_back(list_t* list) {
     list_node_t* node_to_pop = list->last;
     if(list_size(list) <= 1) {
-        list->last=NULL;
+        list->first = NULL;
+        list->last = NULL;
     } else {
         list->last = list->last->previous;
         list->last->next = NULL;
     }
     list->size -= list->size < 1 ? 0 : 1;
-    free(node_to_pop);
+    list_free_node(list, node_to_pop);
 }
 
 
 void list_merge(list_t* dest, list_t* other) {
-    while(list_size(other) > 0) {
-        list_push_back(dest, list_front(other));
-        list_pop_front(other);
-    }
+    list_splice_back(dest, other);
     delete_list(other, NULL);
 }
 
 
 void list_merge_at_beginning(list_t* dest, list_t* other) {
-    while(list_size(other) > 0) {
-        list_push_front(dest, list_back(other));
-        list_pop_back(other);
-    }
+    list_splice_front(dest, other);
     delete_list(other, NULL);
 }
 
 
+void list_splice_back(list_t* dest, list_t* other) {
+    if(list_is_empty(other)) {
+        return;
+    }
+    if(dest->arena != other->arena) {
+        while(list_size(other) > 0) {
+            list_push_back(dest, list_front(other));
+            list_pop_front(other);
+        }
+        return;
+    }
+    if(list_is_empty(dest)) {
+        dest->first = other->first;
+    } else {
+        dest->last->next = other->first;
+        other->first->previous = dest->last;
+    }
+    dest->last = other->last;
+    dest->size += other->size;
+    list_clear_nodes(other);
+}
+
+
+void list_splice_front(list_t* dest, list_t* other) {
+    if(list_is_empty(other)) {
+        return;
+    }
+    if(dest->arena != other->arena) {
+        while(list_size(other) > 0) {
+            list_push_front(dest, list_back(other));
+            list_pop_back(other);
+        }
+        return;
+    }
+    if(list_is_empty(dest)) {
+        dest->last = other->last;
+    } else {
+        dest->first->previous = other->last;
+        other->last->next = dest->first;
+    }
+    dest->first = other->first;
+    dest->size += other->size;
+    list_clear_nodes(other);
+}
+
+
 list_element_t* list_front(list_t* list) {
     if(list == NULL || list->last == NULL) {
         return NULL;
@@ -194,4 +258,28 @@ void list_print(list_t* list, void (*printer)(list_element_t*)) {
             printer(list_current(it));
         }
     }
+}
+
+
+list_node_t* list_allocate_node(list_t* list) {
+    if(list->arena != NULL) {
+        return arena_allocate(list->arena, sizeof(list_node_t));
+    }
+    return allocate(allocation_list_node, sizeof(list_node_t));
+}
+
+
+void list_free_node(list_t* list, list_node_t* node) {
+    // Nodes of arena backed lists are released together with the arena
+    if(list->arena == NULL) {
+        release(allocation_list_node, node);
+    }
+}
+
+
+void list_clear_nodes(list_t* list) {
+    // The nodes now belong to another list, only the header is reset
+    list->first = NULL;
+    list->last = NULL;
+    list->size = 0;
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include "arena.h"
+
 typedef struct list list_t;
 
 typedef struct list_node list_node_t;
@@ -14,6 +16,8 @@ typedef void list_element_t;
 
 list_t* new_list();
 
+list_t* new_list_in_arena(arena_t* arena);
+
 void delete_list(list_t* list, void (*element_destructor)(list_element_t*));
 
 void list_push_front(list_t* list, list_element_t* element);
@@ -28,6 +32,15 @@ void list_merge(list_t* dest, list_t* other);
 
 void list_merge_at_beginning(list_t* dest, list_t* other);
 
+/*
+ * Moves all nodes of other to the end (or beginning) of dest in constant
+ * time, leaving other empty. Lists allocating from different arenas can't
+ * share nodes, so those fall back to moving the elements one by one.
+ */
+void list_splice_back(list_t* dest, list_t* other);
+
+void list_splice_front(list_t* dest, list_t* other);
+
 list_element_t* list_front(list_t* list);
 
 list_element_t* list_back(list_t* list);
@@ -1,90 +1,205 @@
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#include "syntax_tree.h"
-#include "parser.h"
-#include "scanner.h"
-#include "lex_helper_functions.h"
-#include "yacc_helper_functions.h"
+#include "allocation.h"
+#include "compiler.h"
 #include "error_codes.h"
 #include "argparse.h"
-#include "semantic.h"
-#include "code_generator.h"
-#include "assembly_generator.h"
-#include "tac.h"
+#include "mapped_source.h"
+#include "thread_pool.h"
+
+typedef struct compilation_job {
+    const char* source_file;
+    const char* output_file;
+    const arguments_t* args;
+    char* log;
+    size_t log_size;
+    int status;
+} compilation_job_t;
+
+int compile_file(const char* source_path, const char* output_path,
+                 const arguments_t* args, FILE* log);
+
+void compile_job(void* argument);
+
+size_t compile_batch(const arguments_t* args);
+
+const char* exit_status_to_string(int status);
 
 int main(int argc, char** argv){
-    FILE* source_file;
-    FILE* out_file;
     arguments_t args;
 
     if(parse_arguments(argc, argv, &args) != argparse_success) {
         exit(ARGUMENTS_ERROR);
     }
+    if(args.print_allocations) {
+        set_allocator(&tracking_allocator);
+    }
 
-    source_file = fopen(args.source_file, "r");
-    if (source_file == NULL) {
-        perror("Error openning source file");
-        exit(FILE_OPEN_ERROR);
+    if(args.file_count > 1 || args.manifest_file != NULL) {
+        size_t failures = compile_batch(&args);
+        delete_arguments(&args);
+        print_allocation_statistics(stderr);
+        exit(failures > 0 ? BATCH_ERROR : EXIT_SUCCESS);
     }
 
+    int status = compile_file(args.source_files[0], args.output_files[0], &args, stderr);
+    delete_arguments(&args);
+    print_allocation_statistics(stderr);
+    exit(status);
+}
+
 
-    out_file = fopen(args.output_file, "w");
-    if (out_file == NULL) {
-        perror("Error writing to output file");
-        exit(FILE_OPEN_ERROR);
+int compile_file(const char* source_path, const char* output_path,
+                 const arguments_t* args, FILE* log) {
+    FILE* source_file = NULL;
+    mapped_source_t* mapped_source = NULL;
+    // TAC files are mapped by compile_tac_file itself
+    if(args->map_source_files && !args->load_tac) {
+        mapped_source = new_mapped_source(source_path);
+    } else if(!args->load_tac) {
+        source_file = fopen(source_path, "r");
+    }
+    if (source_file == NULL && mapped_source == NULL && !args->load_tac) {
+        fprintf(log, "Error openning source file: %s\n", strerror(errno));
+        return FILE_OPEN_ERROR;
     }
-    
-    symbol_table_t* symbol_table = new_symbol_table();
-    ast_t* ast = new_ast();
 
-    lex_init(symbol_table, args.print_parser_steps, args.print_scanner_steps);
-    yyset_in(source_file);
-    yacc_init(ast);
-    yyparse();
-    if(syntax_error_occured()) {
-        exit(SYNTAX_ERROR);
+    // There is no output file when the program is run in memory
+    FILE* out_file = NULL;
+    if(output_path != NULL) {
+        out_file = fopen(output_path, "w");
+    }
+    if (out_file == NULL && output_path != NULL) {
+        fprintf(log, "Error writing to output file: %s\n", strerror(errno));
+        if(source_file != NULL) {
+            fclose(source_file);
+        }
+        delete_mapped_source(mapped_source);
+        return FILE_OPEN_ERROR;
     }
 
-    int semantic_errors = check_semantic_errors(ast, symbol_table);
-    if(args.print_symbol_table) {
-        symbol_table_print(stderr, symbol_table);
+    compiler_options_t options = compiler_default_options();
+    options.print_parser_steps = args->print_parser_steps;
+    options.print_scanner_steps = args->print_scanner_steps;
+    options.print_symbol_table = args->print_symbol_table;
+    options.print_syntax_table = args->print_syntax_table;
+    options.print_tacs_list = args->print_tacs_list;
+    options.print_ast_memory_stats = args->print_ast_memory_stats;
+    options.print_function_times = args->print_function_times;
+    options.optimize = !args->no_optimize;
+    // Files of a batch are already compiled in parallel
+    options.backend_threads = args->file_count == 1 ? args->jobs : 1;
+    options.cache_directory = args->cache_directory;
+    options.output_format = args->emit_object ? compiler_output_object : compiler_output_assembly;
+    if(args->emit_tac) {
+        options.output_format = compiler_output_tac;
+    } else if(args->dump_tac) {
+        options.output_format = compiler_output_tac_text;
+    }
+    if(args->run_program) {
+        options.output_format = compiler_output_execute;
+    }
+    options.log = log;
+
+    compile_result_t* result;
+    if(args->load_tac) {
+        result = compile_tac_file(source_path, out_file, &options);
+    } else if(mapped_source != NULL) {
+        result = compile_in_place(mapped_source_buffer(mapped_source),
+                                  mapped_source_buffer_size(mapped_source),
+                                  out_file, &options);
+    } else {
+        result = compile_stream(source_file, out_file, &options);
+    }
+    if(args->print_statistics) {
+        print_compiler_statistics(log, &result->statistics,
+                                  args->statistics_json ? compiler_statistics_json : compiler_statistics_text);
     }
+    int status = result->status;
+    if(status == compile_semantic_error || status == compile_output_error) {
+        fprintf(log, "Compilation failed.\n");
+    } else if(status == compile_success && args->run_program) {
+        status = result->exit_status;
+    } else if(status == compile_success) {
+        fprintf(log, "File %s created successfully!\n", output_path);
+    }
+    delete_compile_result(result);
 
-    if(args.print_syntax_table) {
-        ast_print(stderr, ast);
+    if(source_file != NULL) {
+        fclose(source_file);
+    }
+    delete_mapped_source(mapped_source);
+    if(out_file != NULL) {
+        fclose(out_file);
     }
 
-    if(semantic_errors > 0) {
-        fprintf(stderr, "Compilation failed.\n");
-        exit(SEMANTIC_ERROR);
-    } else {
+    return status;
+}
 
-        list_t* code = generate_code(ast, symbol_table);
 
-        if(args.print_symbol_table) {
-            symbol_table_print(stderr, symbol_table);
-        }
+void compile_job(void* argument) {
+    compilation_job_t* job = argument;
+    // Each compilation logs into its own buffer so that the output of
+    // concurrent jobs is not interleaved
+    FILE* log = open_memstream(&job->log, &job->log_size);
+    job->status = compile_file(job->source_file, job->output_file, job->args, log);
+    fclose(log);
+}
 
-        if(args.print_syntax_table) {
-            ast_print(stderr, ast);
-        }
-        
-        if(args.print_tacs_list) {
-            print_code(code);
-        }
 
-        generate_assembly(out_file, code);
-        fprintf(stderr, "File %s created successfully!\n", args.output_file);
-        delete_list(code, (void (*)(list_element_t *))&delete_tac);
+size_t compile_batch(const arguments_t* args) {
+    compilation_job_t* jobs = malloc(args->file_count * sizeof(compilation_job_t));
+    size_t threads = args->jobs > 0 ? args->jobs : thread_pool_default_size();
+    thread_pool_t* pool = new_thread_pool(threads < args->file_count ? threads : args->file_count);
+
+    for(size_t i = 0; i < args->file_count; i++) {
+        jobs[i].source_file = args->source_files[i];
+        jobs[i].output_file = args->output_files[i];
+        jobs[i].args = args;
+        jobs[i].log = NULL;
+        jobs[i].log_size = 0;
+        jobs[i].status = EXIT_SUCCESS;
+        thread_pool_submit(pool, &compile_job, &jobs[i]);
     }
+    thread_pool_wait(pool);
 
-    delete_symbol_table(symbol_table);
-    delete_ast(ast);
+    size_t failures = 0;
+    for(size_t i = 0; i < args->file_count; i++) {
+        fwrite(jobs[i].log, 1, jobs[i].log_size, stderr);
+        free(jobs[i].log);
+    }
+    for(size_t i = 0; i < args->file_count; i++) {
+        fprintf(stderr, "%s -> %s: %s (%d)\n",
+                jobs[i].source_file,
+                jobs[i].output_file,
+                exit_status_to_string(jobs[i].status),
+                jobs[i].status);
+        if(jobs[i].status != EXIT_SUCCESS) {
+            failures++;
+        }
+    }
+    fprintf(stderr, "%zu files compiled on %zu threads: %zu succeeded, %zu failed.\n",
+            args->file_count,
+            thread_pool_size(pool),
+            args->file_count - failures,
+            failures);
+
+    delete_thread_pool(pool);
+    free(jobs);
+    return failures;
+}
 
-    fclose(source_file);
-    fclose(out_file);
 
-    exit(EXIT_SUCCESS);
+const char* exit_status_to_string(int status) {
+    switch(status) {
+        case EXIT_SUCCESS: return "ok";
+        case FILE_OPEN_ERROR: return "file error";
+        case SYNTAX_ERROR: return "syntax error";
+        case SEMANTIC_ERROR: return "semantic error";
+        case OUTPUT_ERROR: return "output error";
+        default: return "failed";
+    }
 }
-
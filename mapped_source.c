@@ -0,0 +1,89 @@
+#include "mapped_source.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAPPED_SOURCE_SENTINELS 2
+
+struct mapped_source {
+    char* mapping;
+    size_t mapping_size;
+    size_t file_size;
+};
+
+size_t round_to_pages(size_t size);
+
+
+mapped_source_t* new_mapped_source(const char* path) {
+    int descriptor = open(path, O_RDONLY);
+    if(descriptor == -1) {
+        return NULL;
+    }
+
+    struct stat status;
+    if(fstat(descriptor, &status) == -1) {
+        int error = errno;
+        close(descriptor);
+        errno = error;
+        return NULL;
+    }
+
+    size_t file_size = status.st_size;
+    size_t mapping_size = round_to_pages(file_size + MAPPED_SOURCE_SENTINELS);
+
+    // Anonymous pages are zero filled, so reserving them first guarantees
+    // the sentinels even when the file ends right at a page boundary. The
+    // file is then mapped over the beginning of the reservation.
+    char* mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mapping == MAP_FAILED) {
+        int error = errno;
+        close(descriptor);
+        errno = error;
+        return NULL;
+    }
+    if(file_size > 0 &&
+       mmap(mapping, file_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_FIXED, descriptor, 0) == MAP_FAILED) {
+        int error = errno;
+        munmap(mapping, mapping_size);
+        close(descriptor);
+        errno = error;
+        return NULL;
+    }
+    close(descriptor);
+
+    mapped_source_t* source = malloc(sizeof(mapped_source_t));
+    source->mapping = mapping;
+    source->mapping_size = mapping_size;
+    source->file_size = file_size;
+    return source;
+}
+
+
+void delete_mapped_source(mapped_source_t* source) {
+    if(source == NULL) {
+        return;
+    }
+    munmap(source->mapping, source->mapping_size);
+    free(source);
+}
+
+
+char* mapped_source_buffer(mapped_source_t* source) {
+    return source->mapping;
+}
+
+
+size_t mapped_source_buffer_size(const mapped_source_t* source) {
+    return source->file_size + MAPPED_SOURCE_SENTINELS;
+}
+
+
+size_t round_to_pages(size_t size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    return (size + page_size - 1) / page_size * page_size;
+}
@@ -0,0 +1,23 @@
+#ifndef MAPPED_SOURCE_H
+#define MAPPED_SOURCE_H
+
+#include <stdlib.h>
+
+/*
+ * Source file mapped privately into memory and followed by the two NUL
+ * bytes flex expects at the end of a buffer it scans in place. The scanner
+ * may write into the mapping, but those writes never reach the file.
+ */
+typedef struct mapped_source mapped_source_t;
+
+// Returns NULL and sets errno if the file can't be opened or mapped
+mapped_source_t* new_mapped_source(const char* path);
+
+void delete_mapped_source(mapped_source_t* source);
+
+char* mapped_source_buffer(mapped_source_t* source);
+
+// Size of the buffer, including the two sentinel bytes
+size_t mapped_source_buffer_size(const mapped_source_t* source);
+
+#endif
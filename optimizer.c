@@ -0,0 +1,39 @@
+#include "optimizer.h"
+
+#include "constant_folding.h"
+#include "control_flow_cleanup.h"
+#include "copy_propagation.h"
+#include "dead_code.h"
+#include "tac_buffer.h"
+#include "value_numbering.h"
+
+
+tac_list_t* optimize_code(compilation_context_t* context, tac_list_t* code) {
+    tac_buffer_t* buffer = new_tac_buffer_from_list(code, context->symbol_table);
+    delete_list(code, (void (*)(list_element_t *))&delete_tac);
+
+    tac_buffer_build_chains(buffer);
+    fold_constants(context, buffer);
+    number_values(context, buffer);
+    propagate_copies(context, buffer);
+    clean_control_flow(context, buffer);
+    eliminate_dead_code(context, buffer);
+
+    tac_list_t* optimized = tac_buffer_to_list(buffer);
+    delete_tac_buffer(buffer);
+    return optimized;
+}
+
+
+bool tac_call_clobbers(const symbol_t* symbol) {
+    switch(symbol->type) {
+        case symbol_int_literal:
+        case symbol_char_literal:
+        case symbol_string_literal:
+        case symbol_label:
+        case symbol_function:
+            return false;
+        default:
+            return true;
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "compilation_context.h"
+#include "tac.h"
+
+/*
+ * Machine independent optimizations of the TAC program, run between code
+ * generation and the back end. The passes work on a tac_buffer holding
+ * the whole program and may create literals in the symbol table.
+ */
+
+// Takes the code and its TACs, and returns the optimized program as a new
+// list
+tac_list_t* optimize_code(compilation_context_t* context, tac_list_t* code);
+
+/*
+ * Whether a call may change the value of the symbol. Parameters and
+ * temporaries are stored statically and the callee may be the caller
+ * itself, so a call may write any global, parameter or temporary of the
+ * caller. Only literals, labels and functions keep their value.
+ */
+bool tac_call_clobbers(const symbol_t* symbol);
+
+#endif
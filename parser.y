@@ -1,13 +1,22 @@
-%{
+%code requires {
+#include "compilation_context.h"
+}
+
+%code {
 #include "lex.yy.h"
 #include "symbol_table.h"
 #include "syntax_tree.h"
 
-int yyerror(const char*);
-int yylex(void);
+int yyerror(void* scanner, compilation_context_t* context, const char* error_message);
+
+// Every token the parser reads goes through count_token
+int count_token(compilation_context_t* context, int token);
+#define yylex(value, scanner) count_token(context, yylex(value, scanner))
+}
 
-ast_t* ast = NULL;
-%}
+%define api.pure full
+%parse-param {void* scanner} {compilation_context_t* context}
+%lex-param {void* scanner}
 
 %union {
     symbol_t* symbol;
@@ -78,13 +87,13 @@ ast_t* ast = NULL;
 
 program: decl_list  
        { 
-           ast_set_root(ast, new_ast_node(ast_program, 1, $1)); 
+           ast_set_root(context->ast, new_ast_node(context->ast, ast_program, 1, $1)); 
        }
        ;
 
 decl_list: decl decl_list_rest
          { 
-             $$ = new_ast_node(ast_decl, 2, $1, $2); 
+             $$ = new_ast_node(context->ast, ast_decl, 2, $1, $2); 
          }
          |                  
          { 
@@ -94,7 +103,7 @@ decl_list: decl decl_list_rest
 
 decl_list_rest: decl decl_list_rest 
               { 
-                  $$ = new_ast_node(ast_decl, 2, $1, $2); 
+                  $$ = new_ast_node(context->ast, ast_decl, 2, $1, $2); 
               }
               |                     
               { 
@@ -104,47 +113,47 @@ decl_list_rest: decl decl_list_rest
 
 decl: KW_INT identifier ':' integer_literal ';'  
     { 
-        $$ = new_ast_node(ast_int_decl, 2, $2, $4); 
+        $$ = new_ast_node(context->ast, ast_int_decl, 2, $2, $4); 
     }
     | KW_CHAR identifier ':' integer_literal ';' 
     { 
-        $$ = new_ast_node(ast_char_decl, 2, $2, $4); 
+        $$ = new_ast_node(context->ast, ast_char_decl, 2, $2, $4); 
     }
     | KW_FLOAT identifier ':' int_literal '/' int_literal ';'    
     { 
-        $$ = new_ast_node(ast_float_decl, 3, $2, $4, $6); 
+        $$ = new_ast_node(context->ast, ast_float_decl, 3, $2, $4, $6); 
     }
     | identifier_def '[' int_literal ']' ';'
     { 
-        $$ = new_ast_node(ast_vector_decl, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_vector_decl, 2, $1, $3); 
     }
     | identifier_def '[' int_literal ']' ':' integer_list ';'
     { 
-        $$ = new_ast_node(ast_vector_init_decl, 3, $1, $3, $6); 
+        $$ = new_ast_node(context->ast, ast_vector_init_decl, 3, $1, $3, $6); 
     }
     | identifier_def '(' parameter_list ')' cmd
     { 
-        $$ = new_ast_node(ast_func_decl, 3, $1, $3, $5); 
+        $$ = new_ast_node(context->ast, ast_func_decl, 3, $1, $3, $5); 
     }
     ;
 
 identifier_def: KW_INT identifier    
               { 
-                  $$ = new_ast_node(ast_int_id_def, 1, $2); 
+                  $$ = new_ast_node(context->ast, ast_int_id_def, 1, $2); 
               }
               | KW_CHAR identifier
               { 
-                  $$ = new_ast_node(ast_char_id_def, 1, $2); 
+                  $$ = new_ast_node(context->ast, ast_char_id_def, 1, $2); 
               }
               | KW_FLOAT identifier
               { 
-                  $$ = new_ast_node(ast_float_id_def, 1, $2); 
+                  $$ = new_ast_node(context->ast, ast_float_id_def, 1, $2); 
               }
               ;
 
 integer_list: integer_literal integer_list_rest
             {
-                $$ = new_ast_node(ast_vector_init_value, 2, $1, $2);
+                $$ = new_ast_node(context->ast, ast_vector_init_value, 2, $1, $2);
             }
             | 
             {
@@ -154,7 +163,7 @@ integer_list: integer_literal integer_list_rest
 
 integer_list_rest: integer_literal integer_list_rest
                  {
-                     $$ = new_ast_node(ast_vector_init_value, 2, $1, $2);
+                     $$ = new_ast_node(context->ast, ast_vector_init_value, 2, $1, $2);
                  }
                  | 
                  {
@@ -168,21 +177,21 @@ integer_literal: char_literal       { $$ = $1; }
 
 parameter_list: identifier_def parameter_list_rest
               {
-                  $$ = new_ast_node(ast_func_param, 2, $1, $2);
+                  $$ = new_ast_node(context->ast, ast_func_param, 2, $1, $2);
               }
               | 
               {
-                  $$ = new_ast_node(ast_func_param, 0);
+                  $$ = new_ast_node(context->ast, ast_func_param, 0);
               }
               ;
 
 parameter_list_rest: ',' identifier_def parameter_list_rest
                    {
-                       $$ = new_ast_node(ast_func_param, 2, $2, $3);
+                       $$ = new_ast_node(context->ast, ast_func_param, 2, $2, $3);
                    }
                    | 
                    {
-                       $$ = new_ast_node(ast_func_param, 0);
+                       $$ = new_ast_node(context->ast, ast_func_param, 0);
                    }
                    ;
 
@@ -200,31 +209,31 @@ cmd: cmd_block
    }
    | KW_PRINT printable_list
    {
-       $$ = new_ast_node(ast_print_type, 1, $2);
+       $$ = new_ast_node(context->ast, ast_print_type, 1, $2);
    }
    | KW_RETURN expr
    {
-       $$ = new_ast_node(ast_return, 1, $2);
+       $$ = new_ast_node(context->ast, ast_return, 1, $2);
    }
    |
    {
-       $$ = new_ast_node(ast_cmd, 0);
+       $$ = new_ast_node(context->ast, ast_cmd, 0);
    }
    ;
 
 cmd_block: '{' cmd_list '}'
          {
-             $$ = new_ast_node(ast_cmd_block, 1, $2);
+             $$ = new_ast_node(context->ast, ast_cmd_block, 1, $2);
          }
          ;
 
 cmd_list: cmd ';' cmd_list
         {
-            $$ = new_ast_node(ast_cmd, 2, $1, $3);
+            $$ = new_ast_node(context->ast, ast_cmd, 2, $1, $3);
         }
         | identifier ':' cmd_list
         {
-            $$ = new_ast_node(ast_label, 2, $1, $3);
+            $$ = new_ast_node(context->ast, ast_label, 2, $1, $3);
         }
         |
         {
@@ -234,32 +243,32 @@ cmd_list: cmd ';' cmd_list
 
 attribution: identifier '=' expr                 
            {
-               $$ = new_ast_node(ast_assign, 2, $1, $3);
+               $$ = new_ast_node(context->ast, ast_assign, 2, $1, $3);
            }
            | identifier '[' expr ']' '=' expr
            {
-               $$ = new_ast_node(ast_vector_assign, 3, $1, $3, $6);
+               $$ = new_ast_node(context->ast, ast_vector_assign, 3, $1, $3, $6);
            }
            ;
 
 
 printable_list: string_literal printable_list_rest
               {
-                  $$ = new_ast_node(ast_print_arg, 2, $1, $2);
+                  $$ = new_ast_node(context->ast, ast_print_arg, 2, $1, $2);
               }
               | expr printable_list_rest
               {
-                  $$ = new_ast_node(ast_print_arg, 2, $1, $2);
+                  $$ = new_ast_node(context->ast, ast_print_arg, 2, $1, $2);
               }
               ;
 
 printable_list_rest: ',' string_literal printable_list_rest
                    {
-                       $$ = new_ast_node(ast_print_arg, 2, $2, $3);
+                       $$ = new_ast_node(context->ast, ast_print_arg, 2, $2, $3);
                    }
                    | ',' expr printable_list_rest
                    {
-                       $$ = new_ast_node(ast_print_arg, 2, $2, $3);
+                       $$ = new_ast_node(context->ast, ast_print_arg, 2, $2, $3);
                    }
                    |
                    {
@@ -269,19 +278,19 @@ printable_list_rest: ',' string_literal printable_list_rest
 
 flux_control: KW_IF expr KW_THEN cmd %prec REDUCE
             {
-                $$ = new_ast_node(ast_if, 2, $2, $4);
+                $$ = new_ast_node(context->ast, ast_if, 2, $2, $4);
             }
                 | KW_IF expr KW_THEN cmd KW_ELSE cmd
             {
-                $$ = new_ast_node(ast_if_else, 3, $2, $4, $6);
+                $$ = new_ast_node(context->ast, ast_if_else, 3, $2, $4, $6);
             }
                 | KW_WHILE expr cmd
             {
-                $$ = new_ast_node(ast_while, 2, $2, $3);
+                $$ = new_ast_node(context->ast, ast_while, 2, $2, $3);
             }
                 | KW_GOTO identifier
             {
-                $$ = new_ast_node(ast_goto, 1, $2);
+                $$ = new_ast_node(context->ast, ast_goto, 1, $2);
             }
             ;
 
@@ -291,7 +300,7 @@ expr: identifier
     }
     | identifier '[' expr ']'        
     { 
-        $$ = new_ast_node(ast_vector_index, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_vector_index, 2, $1, $3); 
     }
     | int_literal                       
     { 
@@ -307,57 +316,57 @@ expr: identifier
     }
     | expr '+' expr                     
     { 
-        $$ = new_ast_node(ast_sum, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_sum, 2, $1, $3); 
     }
     | expr '-' expr                     
     { 
-        $$ = new_ast_node(ast_sub, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_sub, 2, $1, $3); 
     }
     | expr '*' expr                     
     { 
-        $$ = new_ast_node(ast_mul, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_mul, 2, $1, $3); 
     }
     | expr '/' expr                     
     { 
-        $$ = new_ast_node(ast_div, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_div, 2, $1, $3); 
     }
     | expr '<' expr                    
     { 
-        $$ = new_ast_node(ast_lt, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_lt, 2, $1, $3); 
     }
     | expr '>' expr                     
     { 
-        $$ = new_ast_node(ast_gt, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_gt, 2, $1, $3); 
     }
     | expr OPERATOR_LE expr             
     { 
-        $$ = new_ast_node(ast_le, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_le, 2, $1, $3); 
     }
     | expr OPERATOR_GE expr             
     { 
-        $$ = new_ast_node(ast_ge, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_ge, 2, $1, $3); 
     }
     | expr OPERATOR_EQ expr             
     { 
-        $$ = new_ast_node(ast_eq, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_eq, 2, $1, $3); 
     }
     | expr OPERATOR_DIF expr            
     { 
-        $$ = new_ast_node(ast_dif, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_dif, 2, $1, $3); 
     }
     | identifier '(' args_list ')'   
     { 
-        $$ = new_ast_node(ast_func_call, 2, $1, $3); 
+        $$ = new_ast_node(context->ast, ast_func_call, 2, $1, $3); 
     }
     | KW_READ                           
     { 
-        $$ = new_ast_node(ast_read, 0);
+        $$ = new_ast_node(context->ast, ast_read, 0);
     }
     ;
 
 args_list: expr args_list_rest          
          { 
-             $$ = new_ast_node(ast_func_arg, 2, $1, $2); 
+             $$ = new_ast_node(context->ast, ast_func_arg, 2, $1, $2); 
          }
          |                              
          { 
@@ -367,7 +376,7 @@ args_list: expr args_list_rest
 
 args_list_rest: ',' expr args_list_rest 
               { 
-                  $$ = new_ast_node(ast_func_arg, 2, $2, $3); 
+                  $$ = new_ast_node(context->ast, ast_func_arg, 2, $2, $3); 
               }
               |                         
               { 
@@ -377,25 +386,25 @@ args_list_rest: ',' expr args_list_rest
 
 identifier: TK_IDENTIFIER
           {
-              $$ = new_ast_symbol_node($1);
+              $$ = new_ast_symbol_node(context->ast, $1);
           }
           ;
 
 int_literal: LIT_INTEGER
            {
-               $$ = new_ast_symbol_node($1);
+               $$ = new_ast_symbol_node(context->ast, $1);
            }
            ;
 
 char_literal: LIT_CHAR
             {
-                $$ = new_ast_symbol_node($1);
+                $$ = new_ast_symbol_node(context->ast, $1);
             }
             ;
 
 string_literal: LIT_STRING
               {
-                  $$ = new_ast_symbol_node($1);
+                  $$ = new_ast_symbol_node(context->ast, $1);
               }
               ;
 
@@ -406,18 +415,27 @@ string_literal: LIT_STRING
 #include "yacc_helper_functions.h"
 #include "error_codes.h"
 
-bool has_syntax_error = false;
+void yacc_init(compilation_context_t* context) {
+    context->has_syntax_error = false;
+}
 
-void yacc_init(ast_t* syntax_tree) {
-    ast = syntax_tree;
+int yacc_parse(compilation_context_t* context) {
+    return yyparse(context->scanner, context);
 }
 
-bool syntax_error_occured() {
-    return has_syntax_error;
+int count_token(compilation_context_t* context, int token) {
+    if(token > 0) {
+        context->statistics.tokens++;
+    }
+    return token;
 }
 
-int yyerror(const char* error_message) {
-    has_syntax_error = true;
-    return fprintf(stderr, "Line %d: %s\n", getLineNumber(), error_message);
+bool syntax_error_occured(compilation_context_t* context) {
+    return context->has_syntax_error;
 }
 
+int yyerror(void* scanner, compilation_context_t* context, const char* error_message) {
+    context->has_syntax_error = true;
+    compilation_error(context, compilation_phase_syntax, getLineNumber(context), "%s", error_message);
+    return 0;
+}
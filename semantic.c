@@ -3,56 +3,57 @@
 #include <stdbool.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include "list.h"
 
 
 void set_literal_type(ast_node_t* node);
 
-int check_definitions(ast_node_t* node, symbol_table_t* st);
+int check_definitions(ast_node_t* node, compilation_context_t* context);
 
-int check_implementations(ast_node_t* node, symbol_table_t* st);
+int check_implementations(ast_node_t* node, compilation_context_t* context);
 
-int check_variable_declaration(ast_node_t* declaration_node, symbol_table_t* st, data_type_t data_type);
+int check_variable_declaration(ast_node_t* declaration_node, compilation_context_t* context, data_type_t data_type);
 
-int check_vector_declaration(ast_node_t* declaration_node, symbol_table_t* st);
+int check_vector_declaration(ast_node_t* declaration_node, compilation_context_t* context);
 
-int check_initialization_list_size(ast_node_t* list_node, ast_node_t* size_node);
+int check_initialization_list_size(ast_node_t* list_node, ast_node_t* size_node, compilation_context_t* context);
 
-int check_function_declaration(ast_node_t* declaration_node, symbol_table_t* st);
+int check_function_declaration(ast_node_t* declaration_node, compilation_context_t* context);
 
-int check_function_implementation(ast_node_t* declaration_node, symbol_table_t* st);
+int check_function_implementation(ast_node_t* declaration_node, compilation_context_t* context);
 
-int check_function_call(ast_node_t* function_node, symbol_table_t* st, symbol_t* scope);
+int check_function_call(ast_node_t* function_node, compilation_context_t* context, symbol_t* scope);
 
-int check_parameter_list(ast_node_t* parameter_list_node, symbol_table_t* st, symbol_t* function);
+int check_parameter_list(ast_node_t* parameter_list_node, compilation_context_t* context, symbol_t* function);
 
-int check_expression_type(ast_node_t* expression_node, data_type_t expected_data_type, symbol_table_t* st, symbol_t* scope);
+int check_expression_type(ast_node_t* expression_node, data_type_t expected_data_type, compilation_context_t* context, symbol_t* scope);
 
-int check_identifiers_in_expression(ast_node_t* expression_node, symbol_table_t* st, symbol_t* scope);
+int check_identifiers_in_expression(ast_node_t* expression_node, compilation_context_t* context, symbol_t* scope);
 
-int check_identifier(ast_node_t* identifier_node, symbol_table_t* st, symbol_type_t type, data_type_t data_type, symbol_t* scope);
+int check_identifier(ast_node_t* identifier_node, compilation_context_t* context, symbol_type_t type, data_type_t data_type, symbol_t* scope);
 
-int check_identifier_definition(ast_node_t* definition_node, symbol_table_t* st, symbol_type_t type, symbol_t* scope);
+int check_identifier_definition(ast_node_t* definition_node, compilation_context_t* context, symbol_type_t type, symbol_t* scope);
 
-int check_command(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope);
+int check_command(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope);
 
-int check_assignment(ast_node_t* assignment_node, symbol_table_t* st, symbol_t* scope);
+int check_assignment(ast_node_t* assignment_node, compilation_context_t* context, symbol_t* scope);
 
-int check_vector_assignment(ast_node_t* assignment_node, symbol_table_t* st, symbol_t* scope);
+int check_vector_assignment(ast_node_t* assignment_node, compilation_context_t* context, symbol_t* scope);
 
-int check_vector_index_type(ast_node_t* index_node, symbol_table_t* st, symbol_t* scope);
+int check_vector_index_type(ast_node_t* index_node, compilation_context_t* context, symbol_t* scope);
 
-int check_command_block(ast_node_t* command_block_node, symbol_table_t* st, symbol_t* scope);
+int check_command_block(ast_node_t* command_block_node, compilation_context_t* context, symbol_t* scope);
 
-int check_command_list(ast_node_t* command_list_node, symbol_table_t* st, symbol_t* scope);
+int check_command_list(ast_node_t* command_list_node, compilation_context_t* context, symbol_t* scope);
 
-int check_if_else(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope);
+int check_if_else(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope);
 
-int check_print(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope);
+int check_print(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope);
 
-int check_return(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope);
+int check_return(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope);
 
-int check_goto(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope);
+int check_goto(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope);
 
 data_type_t evaluate_expression_data_type(ast_node_t* expression_node, symbol_table_t* st, symbol_t* scope);
 
@@ -84,26 +85,24 @@ bool is_valid_expression_node_type(ast_node_t* expression_node);
 
 bool is_identifier_valid_in_scope(symbol_table_t* st, symbol_t* identifier, symbol_t* scope);
 
-const char* symbol_type_to_string(symbol_type_t type);
-
 const char* data_type_to_string(data_type_t type);
 
 
-int check_semantic_errors(ast_t* ast, symbol_table_t* st) {
+int check_semantic_errors(compilation_context_t* context) {
     int semantic_errors = 0;
-    semantic_errors = check_definitions(ast_get_root(ast), st);
-    semantic_errors = check_implementations(ast_get_root(ast), st);
+    semantic_errors = check_definitions(ast_get_root(context->ast), context);
+    semantic_errors = check_implementations(ast_get_root(context->ast), context);
     return semantic_errors;
 }
 
 
-int check_implementations(ast_node_t* node, symbol_table_t* st) {
+int check_implementations(ast_node_t* node, compilation_context_t* context) {
     int semantic_errors = 0;
 
     if(node != NULL) {
         switch(ast_node_get_type(node)) {
         case ast_func_decl:
-            semantic_errors += check_function_implementation(node, st);
+            semantic_errors += check_function_implementation(node, context);
             break;
         default:
             break;
@@ -111,7 +110,7 @@ int check_implementations(ast_node_t* node, symbol_table_t* st) {
         
         list_iterator_t it = list_begin(ast_node_get_children(node));
         for(; list_current(it) != NULL; list_next(&it)){
-            semantic_errors += check_implementations(list_current(it), st);
+            semantic_errors += check_implementations(list_current(it), context);
         }        
     }
 
@@ -119,7 +118,7 @@ int check_implementations(ast_node_t* node, symbol_table_t* st) {
 }
 
 
-int check_definitions(ast_node_t* node, symbol_table_t* st) {
+int check_definitions(ast_node_t* node, compilation_context_t* context) {
     int semantic_errors = 0;
 
     if(node != NULL) {
@@ -128,20 +127,20 @@ int check_definitions(ast_node_t* node, symbol_table_t* st) {
             set_literal_type(node);
             break;
         case ast_char_decl: ;
-            semantic_errors += check_variable_declaration(node, st, data_type_char);
+            semantic_errors += check_variable_declaration(node, context, data_type_char);
             break;
         case ast_int_decl:
-            semantic_errors += check_variable_declaration(node, st, data_type_int);
+            semantic_errors += check_variable_declaration(node, context, data_type_int);
             break;
         case ast_float_decl:
-            semantic_errors += check_variable_declaration(node, st, data_type_float);
+            semantic_errors += check_variable_declaration(node, context, data_type_float);
             break;
         case ast_vector_decl:
         case ast_vector_init_decl:
-            semantic_errors += check_vector_declaration(node, st);
+            semantic_errors += check_vector_declaration(node, context);
             break;
         case ast_func_decl:
-            semantic_errors += check_function_declaration(node, st);
+            semantic_errors += check_function_declaration(node, context);
             break;
         default:
             break;
@@ -149,7 +148,7 @@ int check_definitions(ast_node_t* node, symbol_table_t* st) {
         
         list_iterator_t it = list_begin(ast_node_get_children(node));
         for(; list_current(it) != NULL; list_next(&it)){
-            semantic_errors += check_definitions(list_current(it), st);
+            semantic_errors += check_definitions(list_current(it), context);
         }        
     }
 
@@ -175,7 +174,7 @@ void set_literal_type(ast_node_t* node) {
 }
 
 
-int check_variable_declaration(ast_node_t* declaration_node, symbol_table_t* st, data_type_t data_type) {
+int check_variable_declaration(ast_node_t* declaration_node, compilation_context_t* context, data_type_t data_type) {
     assert(declaration_node != NULL);
     assert(ast_node_get_type(declaration_node) == ast_int_decl ||
            ast_node_get_type(declaration_node) == ast_char_decl ||
@@ -185,13 +184,13 @@ int check_variable_declaration(ast_node_t* declaration_node, symbol_table_t* st,
     list_t* children = ast_node_get_children(declaration_node);
     ast_node_t* identifier_node = list_current(list_begin(children));
     
-    semantic_errors += check_identifier(identifier_node, st, symbol_variable, data_type, SYMBOL_SCOPE_GLOBAL);
+    semantic_errors += check_identifier(identifier_node, context, symbol_variable, data_type, SYMBOL_SCOPE_GLOBAL);
 
     return semantic_errors;
 }
 
 
-int check_identifier(ast_node_t* identifier_node, symbol_table_t* st, symbol_type_t type, data_type_t data_type, symbol_t* scope) {
+int check_identifier(ast_node_t* identifier_node, compilation_context_t* context, symbol_type_t type, data_type_t data_type, symbol_t* scope) {
     assert(identifier_node != NULL);
     assert(ast_node_get_type(identifier_node) == ast_symbol);
 
@@ -200,19 +199,22 @@ int check_identifier(ast_node_t* identifier_node, symbol_table_t* st, symbol_typ
     
 
 
-    if(!identifier_already_declared(st, identifier, scope)) {
+    if(!identifier_already_declared(context->symbol_table, identifier, scope)) {
         // Case already in symbol table
         /*if(scope == SYMBOL_SCOPE_GLOBAL) {
             identifier->type = type;
             identifier->data_type = data_type;
             identifier->scope = scope;
         // Case in scope of function, but already declared in any other scope
-        } else*/ if(identifier_declared_in_any_other_scope(st, identifier, scope)){
-            symbol_t* new_identifier = symbol_table_add_with_scope(st, identifier->value, type, identifier->first_define_at_line, scope);
+        } else*/ if(identifier_declared_in_any_other_scope(context->symbol_table, identifier, scope)){
+            symbol_t* new_identifier = symbol_table_add_with_scope(context->symbol_table, identifier->value, type, identifier->first_define_at_line, scope);
             new_identifier->data_type = data_type;
             new_identifier->scope = scope;
             if(scope != SYMBOL_SCOPE_GLOBAL){
                 new_identifier->first_define_at_line = scope->first_define_at_line;
+            }
+            // Labels are scoped to the function too, but are not parameters
+            if(type == symbol_parameter){
                 list_push_back(scope->parameters, new_identifier);
             }
             ast_node_set_symbol(identifier_node, new_identifier);
@@ -223,11 +225,13 @@ int check_identifier(ast_node_t* identifier_node, symbol_table_t* st, symbol_typ
             identifier->scope = scope;
             if(scope != SYMBOL_SCOPE_GLOBAL){
                 identifier->first_define_at_line = scope->first_define_at_line;
+            }
+            if(type == symbol_parameter){
                 list_push_back(scope->parameters, identifier);
             }
         }
     } else {
-        fprintf(stderr, "%s: redeclared identifier '%s'. First declared on line %d as %s of type %s.\n",
+        compilation_error(context, compilation_phase_semantic, 0, "%s: redeclared identifier '%s'. First declared on line %d as %s of type %s.",
             scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : 
                 scope->value,
             identifier->value,
@@ -239,7 +243,7 @@ int check_identifier(ast_node_t* identifier_node, symbol_table_t* st, symbol_typ
     return semantic_errors;
 }
 
-int check_vector_declaration(ast_node_t* declaration_node, symbol_table_t* st) {
+int check_vector_declaration(ast_node_t* declaration_node, compilation_context_t* context) {
     assert(declaration_node != NULL);
     assert(ast_node_get_type(declaration_node) == ast_vector_decl ||
            ast_node_get_type(declaration_node) == ast_vector_init_decl);
@@ -251,17 +255,17 @@ int check_vector_declaration(ast_node_t* declaration_node, symbol_table_t* st) {
     ast_node_t* vector_size_node = list_current(list_next(&it));
     ast_node_t* initialization_list_node = list_current(list_next(&it));
     
-    semantic_errors += check_identifier_definition(identifier_definition_node, st, symbol_vector, SYMBOL_SCOPE_GLOBAL);
+    semantic_errors += check_identifier_definition(identifier_definition_node, context, symbol_vector, SYMBOL_SCOPE_GLOBAL);
 
     if(initialization_list_node != NULL) {
-        semantic_errors += check_initialization_list_size(initialization_list_node, vector_size_node);
+        semantic_errors += check_initialization_list_size(initialization_list_node, vector_size_node, context);
     }
 
     return semantic_errors;
 }
 
 
-int check_initialization_list_size(ast_node_t* list_node, ast_node_t* size_node) {
+int check_initialization_list_size(ast_node_t* list_node, ast_node_t* size_node, compilation_context_t* context) {
     int semantic_errors = 0;
 
     int declared_size = atoi(ast_node_get_symbol(size_node)->value);
@@ -278,15 +282,15 @@ int check_initialization_list_size(ast_node_t* list_node, ast_node_t* size_node)
     
     if(declared_size != actual_list_size) {
         semantic_errors++;
-        fprintf(stderr, "GLOBAL: number of elements in initialization list does not match "
-            "declared vector length of %d\n", declared_size);
+        compilation_error(context, compilation_phase_semantic, 0, "GLOBAL: number of elements in initialization list does not match "
+            "declared vector length of %d", declared_size);
     }
 
     return semantic_errors;
 }
 
 
-int check_identifier_definition(ast_node_t* definition_node, symbol_table_t* st, symbol_type_t type, symbol_t* scope) {
+int check_identifier_definition(ast_node_t* definition_node, compilation_context_t* context, symbol_type_t type, symbol_t* scope) {
     assert(definition_node != NULL);
     assert(ast_node_get_type(definition_node) == ast_int_id_def ||
            ast_node_get_type(definition_node) == ast_char_id_def ||
@@ -298,12 +302,12 @@ int check_identifier_definition(ast_node_t* definition_node, symbol_table_t* st,
 
     data_type_t data_type = evaluate_identifier_definition_data_type(definition_node);
     ast_node_set_evaluated_data_type(definition_node, data_type);
-    semantic_errors += check_identifier(identifier_node, st, type, data_type, scope);
+    semantic_errors += check_identifier(identifier_node, context, type, data_type, scope);
     return semantic_errors;
 }
 
 
-int check_function_declaration(ast_node_t* declaration_node, symbol_table_t* st) {
+int check_function_declaration(ast_node_t* declaration_node, compilation_context_t* context) {
     assert(declaration_node != NULL);
     assert(ast_node_get_type(declaration_node) == ast_func_decl);
 
@@ -314,16 +318,16 @@ int check_function_declaration(ast_node_t* declaration_node, symbol_table_t* st)
     ast_node_t* parameter_list_node = list_current(list_next(&it));
     symbol_t* scope = get_identifier_definition_symbol(identifier_definition_node);
 
-    semantic_errors += check_identifier_definition(identifier_definition_node, st, symbol_function, SYMBOL_SCOPE_GLOBAL);
+    semantic_errors += check_identifier_definition(identifier_definition_node, context, symbol_function, SYMBOL_SCOPE_GLOBAL);
 
     scope->parameters = new_list();
-    semantic_errors += check_parameter_list(parameter_list_node, st, scope);
+    semantic_errors += check_parameter_list(parameter_list_node, context, scope);
 
     return semantic_errors;
 }
 
 
-int check_function_implementation(ast_node_t* declaration_node, symbol_table_t* st) {
+int check_function_implementation(ast_node_t* declaration_node, compilation_context_t* context) {
     assert(declaration_node != NULL);
     assert(ast_node_get_type(declaration_node) == ast_func_decl);
 
@@ -336,14 +340,14 @@ int check_function_implementation(ast_node_t* declaration_node, symbol_table_t*
     symbol_t* scope = get_identifier_definition_symbol(identifier_definition_node);
 
     if(command_node != NULL) {
-        semantic_errors += check_command(command_node, st, scope);
+        semantic_errors += check_command(command_node, context, scope);
     }
 
     return semantic_errors;
 }
 
 
-int check_parameter_list(ast_node_t* parameter_list_node, symbol_table_t* st, symbol_t* function) {
+int check_parameter_list(ast_node_t* parameter_list_node, compilation_context_t* context, symbol_t* function) {
     assert(parameter_list_node != NULL);
     assert(ast_node_get_type(parameter_list_node) == ast_func_param);
 
@@ -354,11 +358,11 @@ int check_parameter_list(ast_node_t* parameter_list_node, symbol_table_t* st, sy
     ast_node_t* parameter_list_rest = list_current(list_next(&it));
 
     if(identifier_definition_node != NULL) {
-        semantic_errors += check_identifier_definition(identifier_definition_node, st, symbol_parameter, function);
+        semantic_errors += check_identifier_definition(identifier_definition_node, context, symbol_parameter, function);
     }
 
     if(parameter_list_rest != NULL) {
-        semantic_errors += check_parameter_list(parameter_list_rest, st, function);
+        semantic_errors += check_parameter_list(parameter_list_rest, context, function);
     }
     
 
@@ -366,33 +370,33 @@ int check_parameter_list(ast_node_t* parameter_list_node, symbol_table_t* st, sy
 }
 
 
-int check_command(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope) {
+int check_command(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope) {
     assert(command_node != NULL);
 
     int semantic_errors = 0;
     switch(ast_node_get_type(command_node)) {
         case ast_cmd_block:
-            semantic_errors += check_command_block(command_node, st, scope);
+            semantic_errors += check_command_block(command_node, context, scope);
             break;
         case ast_assign:
-            semantic_errors += check_assignment(command_node, st, scope);
+            semantic_errors += check_assignment(command_node, context, scope);
             break;
         case ast_vector_assign:
-            semantic_errors += check_vector_assignment(command_node, st, scope);
+            semantic_errors += check_vector_assignment(command_node, context, scope);
             break;
         case ast_if:
         case ast_if_else:
         case ast_while:
-            semantic_errors += check_if_else(command_node, st, scope);
+            semantic_errors += check_if_else(command_node, context, scope);
             break;
         case ast_print_type:
-            semantic_errors += check_print(command_node, st, scope);
+            semantic_errors += check_print(command_node, context, scope);
             break;
         case ast_return:
-            semantic_errors += check_return(command_node, st, scope);
+            semantic_errors += check_return(command_node, context, scope);
             break;
         case ast_goto:
-            semantic_errors += check_goto(command_node, st, scope);
+            semantic_errors += check_goto(command_node, context, scope);
             break;
         default:
             break;
@@ -401,7 +405,7 @@ int check_command(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope)
 }
 
 
-int check_if_else(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope) {
+int check_if_else(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope) {
     int semantic_errors = 0;
     list_t* children = ast_node_get_children(command_node);
     list_iterator_t it = list_begin(children);
@@ -409,19 +413,19 @@ int check_if_else(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope)
     ast_node_t* then_expression = list_current(list_next(&it));
     ast_node_t* else_expression = list_current(list_next(&it));
 
-    semantic_errors += check_expression_type(if_condition, data_type_bool, st, scope);
+    semantic_errors += check_expression_type(if_condition, data_type_bool, context, scope);
 
-    semantic_errors += check_command(then_expression, st, scope);
+    semantic_errors += check_command(then_expression, context, scope);
 
     if(else_expression != NULL) {
-        semantic_errors += check_command(else_expression, st, scope);
+        semantic_errors += check_command(else_expression, context, scope);
     }
 
     return semantic_errors;
 }
 
 
-int check_print(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope) {
+int check_print(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope) {
     int semantic_errors = 0;
     
     ast_node_t* print_list = list_current(list_begin(ast_node_get_children(command_node)));
@@ -431,9 +435,9 @@ int check_print(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope) {
         ast_node_t* printable = list_current(list_begin(ast_node_get_children(print_list)));
         if(!(ast_node_get_type(printable) == ast_symbol && 
              ast_node_get_symbol(printable)->type == symbol_string_literal)) {
-            semantic_errors += check_identifiers_in_expression(printable, st, scope);
+            semantic_errors += check_identifiers_in_expression(printable, context, scope);
         }
-        evaluate_expression_data_type(printable, st, scope);
+        evaluate_expression_data_type(printable, context->symbol_table, scope);
         list_iterator_t it = list_begin(ast_node_get_children(print_list));
         print_list = list_current(list_next(&it));
     }
@@ -442,21 +446,21 @@ int check_print(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope) {
 }
 
 
-int check_return(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope) {
+int check_return(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope) {
     int semantic_errors = 0;
     ast_node_t* return_value = list_current(list_begin(ast_node_get_children(command_node)));
-    semantic_errors += check_expression_type(return_value, scope->data_type, st, scope);
+    semantic_errors += check_expression_type(return_value, scope->data_type, context, scope);
     return semantic_errors;
 }
 
 
-int check_goto(ast_node_t* command_node, symbol_table_t* st, symbol_t* scope) {
+int check_goto(ast_node_t* command_node, compilation_context_t* context, symbol_t* scope) {
     int semantic_errors = 0;
     return semantic_errors;
 }
 
 
-int check_command_block(ast_node_t* command_block_node, symbol_table_t* st, symbol_t* scope) {
+int check_command_block(ast_node_t* command_block_node, compilation_context_t* context, symbol_t* scope) {
     assert(command_block_node != NULL);
     assert(ast_node_get_type(command_block_node) == ast_cmd_block);
 
@@ -466,13 +470,13 @@ int check_command_block(ast_node_t* command_block_node, symbol_table_t* st, symb
     ast_node_t* command_list = list_current(it);
 
     if(command_list != NULL) {
-        semantic_errors += check_command_list(command_list, st, scope);
+        semantic_errors += check_command_list(command_list, context, scope);
     }
 
     return semantic_errors;
 }
 
-int check_command_list(ast_node_t* command_list_node, symbol_table_t* st, symbol_t* scope) {
+int check_command_list(ast_node_t* command_list_node, compilation_context_t* context, symbol_t* scope) {
     assert(command_list_node != NULL);
     assert(ast_node_get_type(command_list_node) == ast_cmd ||
            ast_node_get_type(command_list_node) == ast_label);
@@ -485,19 +489,19 @@ int check_command_list(ast_node_t* command_list_node, symbol_table_t* st, symbol
 
     if(command_or_label != NULL) {
         if(ast_node_get_type(command_list_node) == ast_cmd) {
-            semantic_errors += check_command(command_or_label, st, scope);
+            semantic_errors += check_command(command_or_label, context, scope);
         } else {
-            semantic_errors += check_identifier(command_or_label, st, symbol_label, data_type_undefined, scope);
+            semantic_errors += check_identifier(command_or_label, context, symbol_label, data_type_undefined, scope);
         }
     }
 
     if(command_list_rest != NULL) {
-        semantic_errors += check_command_list(command_list_rest, st, scope);
+        semantic_errors += check_command_list(command_list_rest, context, scope);
     }
     return semantic_errors;
 }
 
-int check_assignment(ast_node_t* assignment_node, symbol_table_t* st, symbol_t* scope) {
+int check_assignment(ast_node_t* assignment_node, compilation_context_t* context, symbol_t* scope) {
     assert(assignment_node != NULL);
     assert(ast_node_get_type(assignment_node) == ast_assign);
 
@@ -508,15 +512,19 @@ int check_assignment(ast_node_t* assignment_node, symbol_table_t* st, symbol_t*
     ast_node_t* expression_node = list_current(list_next(&it));
     symbol_t* identifier = ast_node_get_symbol(identifier_node);
 
-    if(!is_identifier_valid_in_scope(st, identifier, scope)) {
+    if(!is_identifier_valid_in_scope(context->symbol_table, identifier, scope)) {
         semantic_errors++;
-        fprintf(stderr, "%s: %s not declared in this scope\n", 
+        compilation_error(context, compilation_phase_semantic, 0, "%s: %s not declared in this scope", 
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : 
                     scope->value, 
                 identifier->value);
     } else {
-        symbol_t* identifier_in_global_scope = symbol_table_get(st, identifier->value, SYMBOL_SCOPE_GLOBAL);
-        symbol_t* identifier_in_function_scope = symbol_table_get(st, identifier->value, scope);
+        size_t length = strlen(identifier->value);
+        size_t identifier_hash = symbol_table_hash(identifier->value, length);
+        symbol_t* identifier_in_global_scope = symbol_table_lookup_hashed(context->symbol_table, identifier->value, length, 
+                                                                          identifier_hash, SYMBOL_SCOPE_GLOBAL);
+        symbol_t* identifier_in_function_scope = symbol_table_lookup_hashed(context->symbol_table, identifier->value, length, 
+                                                                            identifier_hash, scope);
         ast_node_set_symbol(identifier_node, (identifier_in_function_scope != NULL) ? 
                                               identifier_in_function_scope:
                                               identifier_in_global_scope);
@@ -525,7 +533,7 @@ int check_assignment(ast_node_t* assignment_node, symbol_table_t* st, symbol_t*
     identifier = ast_node_get_symbol(identifier_node);
     if(identifier->type != symbol_variable) {
         semantic_errors++;
-        fprintf(stderr, "%s: cannot assign value directly to %s '%s' of type %s\n", 
+        compilation_error(context, compilation_phase_semantic, 0, "%s: cannot assign value directly to %s '%s' of type %s", 
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : 
                     scope->value,
                 symbol_type_to_string(identifier->type),
@@ -533,13 +541,13 @@ int check_assignment(ast_node_t* assignment_node, symbol_table_t* st, symbol_t*
                 data_type_to_string(identifier->data_type));
     }
 
-    semantic_errors += check_expression_type(expression_node, identifier->data_type, st, scope);
+    semantic_errors += check_expression_type(expression_node, identifier->data_type, context, scope);
 
     return semantic_errors;
 }
 
 
-int check_vector_assignment(ast_node_t* assignment_node, symbol_table_t* st, symbol_t* scope) {
+int check_vector_assignment(ast_node_t* assignment_node, compilation_context_t* context, symbol_t* scope) {
     assert(assignment_node != NULL);
     assert(ast_node_get_type(assignment_node) == ast_vector_assign);
 
@@ -551,9 +559,9 @@ int check_vector_assignment(ast_node_t* assignment_node, symbol_table_t* st, sym
     ast_node_t* expression_node = list_current(list_next(&it));
     symbol_t* identifier = ast_node_get_symbol(identifier_node);
 
-    if(!is_identifier_valid_in_scope(st, identifier, scope)) {
+    if(!is_identifier_valid_in_scope(context->symbol_table, identifier, scope)) {
         semantic_errors++;
-        fprintf(stderr, "%s: '%s' not declared in this scope\n", 
+        compilation_error(context, compilation_phase_semantic, 0, "%s: '%s' not declared in this scope", 
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : 
                     scope->value,
                     identifier->value);
@@ -561,62 +569,67 @@ int check_vector_assignment(ast_node_t* assignment_node, symbol_table_t* st, sym
 
     if(identifier->type != symbol_vector) {
         semantic_errors++;
-        fprintf(stderr, "%s: %s '%s' is not a vector and cannot be indexed\n", 
+        compilation_error(context, compilation_phase_semantic, 0, "%s: %s '%s' is not a vector and cannot be indexed", 
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : 
                     scope->value,
                     symbol_type_to_string(identifier->type),
                     identifier->value);
     }
 
-    semantic_errors += check_vector_index_type(index_node, st, scope);
+    semantic_errors += check_vector_index_type(index_node, context, scope);
 
-    semantic_errors += check_expression_type(expression_node, identifier->data_type, st, scope);
+    semantic_errors += check_expression_type(expression_node, identifier->data_type, context, scope);
 
     return semantic_errors;
 }
 
 
 bool identifier_already_declared(symbol_table_t* st, symbol_t* identifier, symbol_t* scope) {
-    symbol_t* symbol = symbol_table_get(st, identifier->value, scope);
+    symbol_t* symbol = symbol_table_lookup(st, identifier->value, strlen(identifier->value), scope);
     return symbol != NULL && symbol->type != symbol_identifier;
 }
 
 bool identifier_declared_in_any_other_scope(symbol_table_t* st, symbol_t* identifier, symbol_t* except_scope) {
-    if(identifier_already_declared(st, identifier, SYMBOL_SCOPE_GLOBAL)) {
-        return true;
-    }
-
-    for(symbol_table_iterator_t it = symbol_table_begin(st); symbol_table_current(it); symbol_table_next(&it)) {
-        symbol_t* symbol = symbol_table_current(it);
-        if(symbol->type == symbol_function && symbol != except_scope) {
-            if(identifier_already_declared(st, identifier, symbol)) {
-                return true;
-            }
+    size_t length = strlen(identifier->value);
+    size_t identifier_hash = symbol_table_hash(identifier->value, length);
+    symbol_table_name_iterator_t it = symbol_table_name_begin(st, identifier->value, length, identifier_hash);
+    for(; symbol_table_name_current(it) != NULL; symbol_table_name_next(&it)) {
+        symbol_t* symbol = symbol_table_name_current(it);
+        if(symbol->type == symbol_identifier) {
+            continue;
+        }
+        if(symbol->scope == SYMBOL_SCOPE_GLOBAL) {
+            return true;
+        }
+        if(symbol->scope != except_scope && symbol->scope->type == symbol_function) {
+            return true;
         }
     }
     return false;
 }
 
 bool is_identifier_valid_in_scope(symbol_table_t* st, symbol_t* identifier, symbol_t* scope) {
-    symbol_t* symbol = symbol_table_get(st, identifier->value, scope);
+    size_t length = strlen(identifier->value);
+    size_t identifier_hash = symbol_table_hash(identifier->value, length);
+    symbol_t* symbol = symbol_table_lookup_hashed(st, identifier->value, length, identifier_hash, scope);
     if(symbol == NULL && scope != SYMBOL_SCOPE_GLOBAL) {
-        symbol = symbol_table_get(st, identifier->value, SYMBOL_SCOPE_GLOBAL);
+        symbol = symbol_table_lookup_hashed(st, identifier->value, length, identifier_hash, SYMBOL_SCOPE_GLOBAL);
     }
     return symbol != NULL && symbol->type != symbol_identifier;
 }
 
-int check_expression_type(ast_node_t* expression_node, data_type_t expected_data_type, symbol_table_t* st, symbol_t* scope) {
+int check_expression_type(ast_node_t* expression_node, data_type_t expected_data_type, compilation_context_t* context, symbol_t* scope) {
     assert(expression_node != NULL);
     assert(is_valid_expression_node_type(expression_node));
 
     int semantic_errors = 0;
 
-    semantic_errors += check_identifiers_in_expression(expression_node, st, scope);
+    semantic_errors += check_identifiers_in_expression(expression_node, context, scope);
 
-    data_type_t evaluated_data_type = evaluate_expression_data_type(expression_node, st, scope);
+    data_type_t evaluated_data_type = evaluate_expression_data_type(expression_node, context->symbol_table, scope);
     ast_node_set_evaluated_data_type(expression_node, evaluated_data_type);
     if(!are_compatible_data_types(evaluated_data_type, expected_data_type)) {
-        fprintf(stderr, "%s: expression incompatible with type %s\n",
+        compilation_error(context, compilation_phase_semantic, 0, "%s: expression incompatible with type %s",
             scope->value,
             data_type_to_string(expected_data_type));
         semantic_errors++;
@@ -624,46 +637,46 @@ int check_expression_type(ast_node_t* expression_node, data_type_t expected_data
     return semantic_errors;
 }
 
-int check_vector_index_type(ast_node_t* index_node, symbol_table_t* st, symbol_t* scope) {
+int check_vector_index_type(ast_node_t* index_node, compilation_context_t* context, symbol_t* scope) {
     assert(index_node != NULL);
     assert(is_valid_expression_node_type(index_node));
 
     int semantic_errors = 0;
 
-    semantic_errors += check_identifiers_in_expression(index_node, st, scope);
+    semantic_errors += check_identifiers_in_expression(index_node, context, scope);
 
-    data_type_t evaluated_data_type = evaluate_expression_data_type(index_node, st, scope);
+    data_type_t evaluated_data_type = evaluate_expression_data_type(index_node, context->symbol_table, scope);
     ast_node_set_evaluated_data_type(index_node, evaluated_data_type);
     if(evaluated_data_type != data_type_int) {
-        fprintf(stderr, "%s: index of vector must be an integer\n",
+        compilation_error(context, compilation_phase_semantic, 0, "%s: index of vector must be an integer",
             scope->value);
         semantic_errors++;
     }
     return semantic_errors;
 }
 
-int check_identifiers_in_expression(ast_node_t* expression_node, symbol_table_t* st, symbol_t* scope) {
+int check_identifiers_in_expression(ast_node_t* expression_node, compilation_context_t* context, symbol_t* scope) {
     int semantic_errors = 0;
     list_iterator_t it = list_begin(ast_node_get_children(expression_node));
     switch(ast_node_get_type(expression_node)) {
     case ast_func_call:
-        semantic_errors += check_function_call(expression_node, st, scope);
+        semantic_errors += check_function_call(expression_node, context, scope);
         break;
     case ast_vector_index:;
         ast_node_t* vector_identifier_node = list_current(it);
         ast_node_t* vector_index_node = list_current(list_next(&it));
         symbol_t* vector_identifier = ast_node_get_symbol(vector_identifier_node);
-        if(!is_identifier_valid_in_scope(st, vector_identifier, scope)) {
+        if(!is_identifier_valid_in_scope(context->symbol_table, vector_identifier, scope)) {
             semantic_errors++;
-            fprintf(stderr, "%s: undefined identifier '%s'\n",
+            compilation_error(context, compilation_phase_semantic, 0, "%s: undefined identifier '%s'",
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : scope->value,
                 vector_identifier->value);
             break;
         }
-        semantic_errors += check_vector_index_type(vector_index_node, st, scope);
+        semantic_errors += check_vector_index_type(vector_index_node, context, scope);
         if(vector_identifier->type != symbol_vector) {
             semantic_errors++;
-            fprintf(stderr, "%s: identifier %s is not a vector type\n",
+            compilation_error(context, compilation_phase_semantic, 0, "%s: identifier %s is not a vector type",
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : scope->value,
                 vector_identifier->value);
         }
@@ -671,14 +684,14 @@ int check_identifiers_in_expression(ast_node_t* expression_node, symbol_table_t*
         
     case ast_symbol:;
         symbol_t* identifier = ast_node_get_symbol(expression_node);
-        if(!is_identifier_valid_in_scope(st, identifier, scope)) {
+        if(!is_identifier_valid_in_scope(context->symbol_table, identifier, scope)) {
             semantic_errors++;
-            fprintf(stderr, "%s: undefined identifier '%s'\n",
+            compilation_error(context, compilation_phase_semantic, 0, "%s: undefined identifier '%s'",
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : scope->value,
                 identifier->value);
             break;
         } else {
-            symbol_t* symbol_in_scope = symbol_table_get(st, identifier->value, scope);
+            symbol_t* symbol_in_scope = symbol_table_get(context->symbol_table, identifier->value, scope);
             if(symbol_in_scope != NULL) {
                 ast_node_set_symbol(expression_node, symbol_in_scope);
             }
@@ -686,7 +699,7 @@ int check_identifiers_in_expression(ast_node_t* expression_node, symbol_table_t*
         if(identifier->type == symbol_function ||
            identifier->type == symbol_vector) {
             semantic_errors++;
-            fprintf(stderr, "%s: trying to dereference %s identifier %s\n",
+            compilation_error(context, compilation_phase_semantic, 0, "%s: trying to dereference %s identifier %s",
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : scope->value,
                 symbol_type_to_string(identifier->type),
                 identifier->value);
@@ -696,7 +709,7 @@ int check_identifiers_in_expression(ast_node_t* expression_node, symbol_table_t*
     default:;
         ast_node_t* child = list_current(it);
         while(child != NULL) {
-            semantic_errors += check_identifiers_in_expression(child, st, scope);
+            semantic_errors += check_identifiers_in_expression(child, context, scope);
             child = list_current(list_next(&it));
         }
         break;
@@ -704,7 +717,7 @@ int check_identifiers_in_expression(ast_node_t* expression_node, symbol_table_t*
     return semantic_errors;
 }
 
-int check_function_call(ast_node_t* function_node, symbol_table_t* st, symbol_t* scope) {
+int check_function_call(ast_node_t* function_node, compilation_context_t* context, symbol_t* scope) {
     int semantic_errors = 0;
     list_t* children = ast_node_get_children(function_node);
     list_iterator_t it = list_begin(children);
@@ -713,9 +726,9 @@ int check_function_call(ast_node_t* function_node, symbol_table_t* st, symbol_t*
     symbol_t* identifier = ast_node_get_symbol(identifier_node);
     
 
-    if(!is_identifier_valid_in_scope(st, identifier, scope)) {
+    if(!is_identifier_valid_in_scope(context->symbol_table, identifier, scope)) {
         semantic_errors++;
-        fprintf(stderr, "%s: undefined identifier '%s'\n",
+        compilation_error(context, compilation_phase_semantic, 0, "%s: undefined identifier '%s'",
                 scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : scope->value,
                 identifier->value);
         return semantic_errors;
@@ -723,7 +736,7 @@ int check_function_call(ast_node_t* function_node, symbol_table_t* st, symbol_t*
 
     if(identifier->type != symbol_function) {
         semantic_errors++;
-        fprintf(stderr, "%s: trying to call non-function identifier %s\n",
+        compilation_error(context, compilation_phase_semantic, 0, "%s: trying to call non-function identifier %s",
             scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : scope->value,
             identifier->value);
         return semantic_errors;
@@ -737,19 +750,19 @@ int check_function_call(ast_node_t* function_node, symbol_table_t* st, symbol_t*
         ast_node_t* expression = list_current(argument_it);
         symbol_t* current_parameter = list_current(parameter_it);
         
-        semantic_errors += check_expression_type(expression, current_parameter->data_type, st, scope);
+        semantic_errors += check_expression_type(expression, current_parameter->data_type, context, scope);
 
         arguments = list_current(list_next(&argument_it));
         list_next(&parameter_it);
     }
     if(list_current(parameter_it) != NULL) {
         semantic_errors++;
-        fprintf(stderr, "%s: too few arguments passed to function %s\n",
+        compilation_error(context, compilation_phase_semantic, 0, "%s: too few arguments passed to function %s",
             scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : scope->value,
             identifier->value);
     } else if (arguments != NULL) {
         semantic_errors++;
-        fprintf(stderr, "%s: too many arguments passed to function %s\n",
+        compilation_error(context, compilation_phase_semantic, 0, "%s: too many arguments passed to function %s",
             scope == SYMBOL_SCOPE_GLOBAL ? "GLOBAL" : scope->value,
             identifier->value);
     }
@@ -974,42 +987,6 @@ bool is_valid_expression_node_type(ast_node_t* expression_node) {
 }
 
 
-const char* symbol_type_to_string(symbol_type_t type) {
-    switch(type) {
-        case symbol_int_literal:
-            return "int literal";
-            break;
-        case symbol_char_literal:
-            return "char literal";
-            break;
-        case symbol_string_literal:
-            return "string literal";
-            break;
-        case symbol_identifier:
-            return "identifier";
-            break;
-        case symbol_variable:
-            return "variable";
-            break;
-        case symbol_vector:
-            return "vector";
-            break;
-        case symbol_function:
-            return "function";
-            break;
-        case symbol_parameter:
-            return "parameter";
-            break;
-        case symbol_label:
-            return "label";
-            break;
-        default:
-            return "";
-            break;
-    }
-}
-
-
 const char* data_type_to_string(data_type_t type) {
     switch(type) {
         case data_type_undefined:
@@ -1,9 +1,8 @@
 #ifndef SEMANTIC_H
 #define SEMANTIC_H
 
-#include "syntax_tree.h"
-#include "symbol_table.h"
+#include "compilation_context.h"
 
-int check_semantic_errors(ast_t* ast, symbol_table_t* st);
+int check_semantic_errors(compilation_context_t* context);
 
 #endif
\ No newline at end of file
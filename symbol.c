@@ -3,17 +3,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "allocation.h"
+
 void copy_symbol_value(const char* value, symbol_t* symbol) {
-    size_t value_length = strlen(value);
-    symbol->value = calloc(value_length+1, sizeof(char));
-    strcpy(symbol->value, value);
-    symbol->value[value_length] = '\0';
+    symbol->value = allocate_string(value);
 }
 
 symbol_t* new_symbol(const char* value, symbol_type_t type, data_type_t data_type, 
                     symbol_t* scope, int first_defined_at_line, 
                     list_t* parameters) {
-    symbol_t* symbol = malloc(sizeof(symbol_t));
+    symbol_t* symbol = allocate(allocation_symbol, sizeof(symbol_t));
+    symbol->id = SYMBOL_NO_ID;
     copy_symbol_value(value, symbol);
     symbol->type = type;
     symbol->data_type = data_type;
@@ -25,13 +25,49 @@ symbol_t* new_symbol(const char* value, symbol_type_t type, data_type_t data_typ
 
 
 symbol_t* new_empty_symbol() {
-    symbol_t* symbol = malloc(sizeof(symbol_t));
+    symbol_t* symbol = allocate(allocation_symbol, sizeof(symbol_t));
     return symbol;
 }
 
 
 void delete_symbol(symbol_t* symbol) {
     delete_list(symbol->parameters, NULL);
-    free(symbol->value);
-    free(symbol);
+    release(allocation_string, symbol->value);
+    release(allocation_symbol, symbol);
+}
+
+
+const char* symbol_type_to_string(symbol_type_t type) {
+    switch(type) {
+        case symbol_int_literal:
+            return "int literal";
+            break;
+        case symbol_char_literal:
+            return "char literal";
+            break;
+        case symbol_string_literal:
+            return "string literal";
+            break;
+        case symbol_identifier:
+            return "identifier";
+            break;
+        case symbol_variable:
+            return "variable";
+            break;
+        case symbol_vector:
+            return "vector";
+            break;
+        case symbol_function:
+            return "function";
+            break;
+        case symbol_parameter:
+            return "parameter";
+            break;
+        case symbol_label:
+            return "label";
+            break;
+        default:
+            return "";
+            break;
+    }
 }
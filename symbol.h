@@ -21,8 +21,14 @@ typedef enum symbol_type {
     symbol_label
 } symbol_type_t;
 
+#define SYMBOL_TYPE_COUNT (symbol_label + 1)
+
+
+#define SYMBOL_NO_ID ((size_t)-1)
 
 struct symbol {
+    // Position of the symbol in its symbol table, usable as a dense index
+    size_t id;
     char* value;
     symbol_type_t type;
     data_type_t data_type;
@@ -39,4 +45,6 @@ symbol_t* new_empty_symbol();
 
 void delete_symbol(symbol_t* symbol);
 
+const char* symbol_type_to_string(symbol_type_t type);
+
 #endif
\ No newline at end of file
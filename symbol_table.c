@@ -1,26 +1,86 @@
 #include "symbol_table.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include "allocation.h"
 #include "symbol.h"
-#include "list.h"
 
-#define TABLE_SIZE 1009
-#define BUCKET_LIST_END -1
+#define INITIAL_SLOTS_CAPACITY 256
+#define INITIAL_ENTRIES_CAPACITY 128
+// The slots array grows once it is more than 7/8 full
+#define MAX_LOAD_NUMERATOR 7
+#define MAX_LOAD_DENOMINATOR 8
+#define EMPTY_SLOT SIZE_MAX
+#define NO_ENTRY SIZE_MAX
+// Never a real scope, matches the first entry with the searched name
+#define ANY_SCOPE ((symbol_t*)UINTPTR_MAX)
+#define PROBE_HISTOGRAM_SIZE 8
 
+/*
+ * Entries sharing a name are chained in insertion order, which gives the
+ * list of scopes a name was declared in without scanning the table. Only
+ * the first entry of a chain keeps track of its last one. A renamed entry
+ * joins the end of the chain of its new name.
+ */
+typedef struct symbol_table_entry {
+    size_t hash;
+    size_t length;
+    symbol_t* symbol;
+    size_t first_with_same_name;
+    size_t last_with_same_name;
+    size_t next_with_same_name;
+} symbol_table_entry_t;
+
+typedef struct symbol_table_slot {
+    size_t hash;
+    size_t entry;
+} symbol_table_slot_t;
+
+/*
+ * Robin Hood open addressing table. Symbols are kept in the entries array
+ * in insertion order, which is also the iteration order, while the slots
+ * array maps hashes to entries. Symbols are hashed by name only, because
+ * semantic analysis moves identifiers to function scopes after they have
+ * been inserted; the scope is compared when probing.
+ */
 struct symbol_table {
-    list_t** bucket;
+    symbol_table_entry_t* entries;
+    size_t size;
+    size_t entries_capacity;
+    symbol_table_slot_t* slots;
+    size_t slots_capacity;
+    // Symbols and names alive before the table, the rest belong to it
+    allocation_mark_t mark;
 };
 
-size_t hash(const char* key);
+size_t probe_distance(const symbol_table_t* st, size_t slot_index);
+
+size_t symbol_table_find_entry(const symbol_table_t* st, const char* key, size_t length,
+                               size_t key_hash, symbol_t* scope, size_t* same_name_entry);
+
+void symbol_table_insert_slot(symbol_table_t* st, size_t key_hash, size_t entry);
+
+size_t symbol_table_remove_slot(symbol_table_t* st, const symbol_t* symbol);
+
+void symbol_table_link_same_name(symbol_table_t* st, size_t entry, size_t same_name_entry);
+
+void symbol_table_unlink_same_name(symbol_table_t* st, size_t entry);
+
+void symbol_table_grow(symbol_table_t* st);
 
 
 symbol_table_t* new_symbol_table() {
-    symbol_table_t* st = malloc(sizeof(symbol_table_t));
-    st->bucket = calloc(TABLE_SIZE, sizeof(list_t*));
+    symbol_table_t* st = allocate(allocation_symbol_table, sizeof(symbol_table_t));
+    st->size = 0;
+    st->entries_capacity = INITIAL_ENTRIES_CAPACITY;
+    st->entries = allocate(allocation_symbol_table, st->entries_capacity * sizeof(symbol_table_entry_t));
+    st->slots_capacity = INITIAL_SLOTS_CAPACITY;
+    st->slots = allocate(allocation_symbol_table, st->slots_capacity * sizeof(symbol_table_slot_t));
+    st->mark = allocation_mark();
 
-    for (int bucket_index = 0; bucket_index < TABLE_SIZE; bucket_index++) {
-        st->bucket[bucket_index] = new_list();
+    for (size_t slot_index = 0; slot_index < st->slots_capacity; slot_index++) {
+        st->slots[slot_index].entry = EMPTY_SLOT;
     }
 
     return st;
@@ -28,41 +88,57 @@ symbol_table_t* new_symbol_table() {
 
 
 void delete_symbol_table(symbol_table_t* st) {
-    for (int bucket_index = 0; bucket_index < TABLE_SIZE; bucket_index++) {
-        delete_list(st->bucket[bucket_index], (void (*)(void*))&delete_symbol);
-    } 
-    free(st->bucket);
-    free(st);
+    for (size_t entry_index = 0; entry_index < st->size; entry_index++) {
+        delete_symbol(st->entries[entry_index].symbol);
+    }
+    allocation_check_leaks(&st->mark, allocation_symbol, "delete_symbol_table");
+    allocation_check_leaks(&st->mark, allocation_string, "delete_symbol_table");
+    release(allocation_symbol_table, st->entries);
+    release(allocation_symbol_table, st->slots);
+    release(allocation_symbol_table, st);
 }
 
 
-symbol_t* symbol_table_add(const symbol_table_t* st, const char* symbol, 
+symbol_t* symbol_table_add(symbol_table_t* st, const char* symbol,
                            symbol_type_t type, int first_defined_at_line) {
     return symbol_table_add_with_scope(st, symbol, type, first_defined_at_line, SYMBOL_SCOPE_GLOBAL);
 }
 
 
-bool symbol_comp(list_element_t* s1, list_element_t* s2) {
-    return strcmp(((symbol_t*)s1)->value, ((symbol_t*)s2)->value) == 0 && 
-           ((symbol_t*)s1)->scope == ((symbol_t*)s2)->scope;
-}
-
-
-symbol_t* symbol_table_add_symbol(const symbol_table_t* st, symbol_t* symbol) {
-    size_t bucket_index = hash(symbol->value);
-    list_iterator_t symbol_in_hash_it = list_find(list_begin(st->bucket[bucket_index]), symbol, &symbol_comp);
-    symbol_t* symbol_in_hash = list_current(symbol_in_hash_it);
-    if(symbol_in_hash == NULL) {
-        list_push_back(st->bucket[bucket_index], symbol);
-        return symbol;
-    } else {
+symbol_t* symbol_table_add_symbol(symbol_table_t* st, symbol_t* symbol) {
+    size_t length = strlen(symbol->value);
+    size_t key_hash = symbol_table_hash(symbol->value, length);
+    size_t same_name_entry = NO_ENTRY;
+    size_t entry_in_table = symbol_table_find_entry(st, symbol->value, length, key_hash, 
+                                                    symbol->scope, &same_name_entry);
+    if(entry_in_table != NO_ENTRY) {
         delete_symbol(symbol);
-        return symbol_in_hash;
+        return st->entries[entry_in_table].symbol;
+    }
+
+    if((st->size + 1) * MAX_LOAD_DENOMINATOR > st->slots_capacity * MAX_LOAD_NUMERATOR) {
+        symbol_table_grow(st);
     }
+    if(st->size == st->entries_capacity) {
+        st->entries_capacity *= 2;
+        st->entries = reallocate(allocation_symbol_table, st->entries,
+                                 st->entries_capacity * sizeof(symbol_table_entry_t));
+    }
+
+    symbol_table_entry_t* entry = &st->entries[st->size];
+    entry->hash = key_hash;
+    entry->length = length;
+    entry->symbol = symbol;
+    symbol->id = st->size;
+    symbol_table_link_same_name(st, st->size, same_name_entry);
+    symbol_table_insert_slot(st, key_hash, st->size);
+    st->size++;
+
+    return symbol;
 }
 
 
-symbol_t* symbol_table_add_with_scope(const symbol_table_t* st, const char* value, 
+symbol_t* symbol_table_add_with_scope(symbol_table_t* st, const char* value,
                            symbol_type_t type, int first_defined_at_line, symbol_t* scope){
     symbol_t* symbol = new_symbol(value, type, data_type_undefined, scope, first_defined_at_line, NULL);
 
@@ -70,85 +146,275 @@ symbol_t* symbol_table_add_with_scope(const symbol_table_t* st, const char* valu
 }
 
 
-symbol_t* symbol_table_get(symbol_table_t* st, char* key, symbol_t* scope) {
-    size_t bucket_index = hash(key);
-    list_iterator_t it = list_begin(st->bucket[bucket_index]);
-    symbol_t* symbol = new_symbol(key, 0, 0, scope, 0, NULL);
-    it = list_find(it, symbol, &symbol_comp);
-    delete_symbol(symbol);
-    symbol = list_current(it);
-    return symbol;
+void symbol_table_rename(symbol_table_t* st, symbol_t* symbol, char* value) {
+    size_t entry_index = symbol_table_remove_slot(st, symbol);
+    symbol_table_entry_t* entry = &st->entries[entry_index];
+    symbol_table_unlink_same_name(st, entry_index);
+
+    release(allocation_string, symbol->value);
+    symbol->value = value;
+    entry->length = strlen(value);
+    entry->hash = symbol_table_hash(value, entry->length);
+
+    size_t same_name_entry = NO_ENTRY;
+    symbol_table_find_entry(st, value, entry->length, entry->hash, ANY_SCOPE, &same_name_entry);
+    symbol_table_link_same_name(st, entry_index, same_name_entry);
+    symbol_table_insert_slot(st, entry->hash, entry_index);
 }
 
 
-bool symbol_table_contains(symbol_table_t* st, char* key, symbol_t* scope) {
-    return symbol_table_get(st, key, scope) != NULL;
+symbol_t* symbol_table_get(const symbol_table_t* st, const char* key, symbol_t* scope) {
+    return symbol_table_lookup(st, key, strlen(key), scope);
 }
 
-void symbol_bucket_printer(list_element_t* element) {
-    symbol_t* symbol = element;
-    fprintf(stderr, "{%s, %d, %d, %s} ",
-            symbol->value, 
-            symbol->type, 
-            symbol->data_type, 
-            symbol->scope == SYMBOL_SCOPE_GLOBAL ?
-                "GLOBAL" : symbol->scope->value);
+
+size_t symbol_table_size(const symbol_table_t* st) {
+    return st->size;
 }
 
-void symbol_table_print(FILE* stream, const symbol_table_t* st) {
-    for (int bucket_index = 0; bucket_index < TABLE_SIZE; bucket_index++) {
-        if (list_size(st->bucket[bucket_index]) > 0) {
-            fprintf(stream, "[ %d ] : ", bucket_index);
-            list_print(st->bucket[bucket_index], &symbol_bucket_printer);
-            fprintf(stream, "\n");
-        }    
+
+bool symbol_table_contains(const symbol_table_t* st, const char* key, symbol_t* scope) {
+    return symbol_table_lookup(st, key, strlen(key), scope) != NULL;
+}
+
+
+symbol_t* symbol_table_lookup(const symbol_table_t* st, const char* key, size_t length,
+                              symbol_t* scope) {
+    return symbol_table_lookup_hashed(st, key, length, symbol_table_hash(key, length), scope);
+}
+
+
+symbol_t* symbol_table_lookup_hashed(const symbol_table_t* st, const char* key, size_t length,
+                                     size_t key_hash, symbol_t* scope) {
+    size_t entry_index = symbol_table_find_entry(st, key, length, key_hash, scope, NULL);
+    return entry_index != NO_ENTRY ? st->entries[entry_index].symbol : NULL;
+}
+
+
+size_t symbol_table_find_entry(const symbol_table_t* st, const char* key, size_t length,
+                               size_t key_hash, symbol_t* scope, size_t* same_name_entry) {
+    size_t mask = st->slots_capacity - 1;
+    size_t slot_index = key_hash & mask;
+    for(size_t distance = 0; ; distance++) {
+        symbol_table_slot_t* slot = &st->slots[slot_index];
+        // An entry closer to its home than we are to ours ends the probe
+        if(slot->entry == EMPTY_SLOT || probe_distance(st, slot_index) < distance) {
+            return NO_ENTRY;
+        }
+        symbol_table_entry_t* entry = &st->entries[slot->entry];
+        if(slot->hash == key_hash && entry->length == length &&
+           memcmp(entry->symbol->value, key, length) == 0) {
+            if(same_name_entry != NULL) {
+                *same_name_entry = slot->entry;
+            }
+            if(entry->symbol->scope == scope || scope == ANY_SCOPE) {
+                return slot->entry;
+            }
+        }
+        slot_index = (slot_index + 1) & mask;
     }
 }
 
 
-size_t hash(const char* key) {
-    int calculated_hash = 1;
-    size_t key_length = strlen(key);
-    for(int i = 0; i < key_length; i++) {
-        calculated_hash = ((calculated_hash * key[i]) % TABLE_SIZE) + 1;
+symbol_table_name_iterator_t symbol_table_name_begin(symbol_table_t* st, const char* key, 
+                                                     size_t length, size_t key_hash) {
+    size_t same_name_entry = symbol_table_find_entry(st, key, length, key_hash, ANY_SCOPE, NULL);
+
+    symbol_table_name_iterator_t it;
+    it.table = st;
+    it.index = same_name_entry == NO_ENTRY ? NO_ENTRY : st->entries[same_name_entry].first_with_same_name;
+    return it;
+}
+
+
+symbol_table_name_iterator_t symbol_table_name_next(symbol_table_name_iterator_t* it) {
+    if(it->index != NO_ENTRY) {
+        it->index = it->table->entries[it->index].next_with_same_name;
     }
-    return calculated_hash - 1;
+    return *it;
 }
 
-size_t next_non_empty_bucket(symbol_table_t* st, size_t current_index) {
-    size_t index = current_index + 1;
-    while(index < TABLE_SIZE && list_size(st->bucket[index]) == 0) {
-        index++;
+
+symbol_t* symbol_table_name_current(symbol_table_name_iterator_t it) {
+    return it.index != NO_ENTRY ? it.table->entries[it.index].symbol : NULL;
+}
+
+
+void symbol_table_insert_slot(symbol_table_t* st, size_t key_hash, size_t entry) {
+    size_t mask = st->slots_capacity - 1;
+    symbol_table_slot_t inserted = { key_hash, entry };
+    size_t slot_index = key_hash & mask;
+    size_t distance = 0;
+    while(st->slots[slot_index].entry != EMPTY_SLOT) {
+        size_t existing_distance = probe_distance(st, slot_index);
+        if(existing_distance < distance) {
+            symbol_table_slot_t displaced = st->slots[slot_index];
+            st->slots[slot_index] = inserted;
+            inserted = displaced;
+            distance = existing_distance;
+        }
+        slot_index = (slot_index + 1) & mask;
+        distance++;
+    }
+    st->slots[slot_index] = inserted;
+}
+
+
+// Backward shift deletion: the slots after the removed one move back
+// until one is empty or already in its home slot. Returns the entry of the
+// symbol, found under its current name.
+size_t symbol_table_remove_slot(symbol_table_t* st, const symbol_t* symbol) {
+    size_t mask = st->slots_capacity - 1;
+    size_t slot_index = symbol_table_hash(symbol->value, strlen(symbol->value)) & mask;
+    while(st->slots[slot_index].entry == EMPTY_SLOT ||
+          st->entries[st->slots[slot_index].entry].symbol != symbol) {
+        slot_index = (slot_index + 1) & mask;
+    }
+    size_t entry = st->slots[slot_index].entry;
+    size_t next_index = (slot_index + 1) & mask;
+    while(st->slots[next_index].entry != EMPTY_SLOT && probe_distance(st, next_index) > 0) {
+        st->slots[slot_index] = st->slots[next_index];
+        slot_index = next_index;
+        next_index = (next_index + 1) & mask;
+    }
+    st->slots[slot_index].entry = EMPTY_SLOT;
+    return entry;
+}
+
+
+void symbol_table_link_same_name(symbol_table_t* st, size_t entry, size_t same_name_entry) {
+    symbol_table_entry_t* linked = &st->entries[entry];
+    linked->next_with_same_name = NO_ENTRY;
+    if(same_name_entry == NO_ENTRY) {
+        linked->first_with_same_name = entry;
+        linked->last_with_same_name = entry;
+    } else {
+        size_t first_index = st->entries[same_name_entry].first_with_same_name;
+        symbol_table_entry_t* first = &st->entries[first_index];
+        st->entries[first->last_with_same_name].next_with_same_name = entry;
+        first->last_with_same_name = entry;
+        linked->first_with_same_name = first_index;
+    }
+}
+
+
+void symbol_table_unlink_same_name(symbol_table_t* st, size_t entry) {
+    symbol_table_entry_t* unlinked = &st->entries[entry];
+    size_t first_index = unlinked->first_with_same_name;
+    if(first_index == entry) {
+        size_t next_index = unlinked->next_with_same_name;
+        if(next_index != NO_ENTRY) {
+            st->entries[next_index].last_with_same_name = unlinked->last_with_same_name;
+        }
+        for(size_t i = next_index; i != NO_ENTRY; i = st->entries[i].next_with_same_name) {
+            st->entries[i].first_with_same_name = next_index;
+        }
+        return;
+    }
+    size_t previous = first_index;
+    while(st->entries[previous].next_with_same_name != entry) {
+        previous = st->entries[previous].next_with_same_name;
+    }
+    st->entries[previous].next_with_same_name = unlinked->next_with_same_name;
+    if(st->entries[first_index].last_with_same_name == entry) {
+        st->entries[first_index].last_with_same_name = previous;
+    }
+}
+
+
+void symbol_table_grow(symbol_table_t* st) {
+    release(allocation_symbol_table, st->slots);
+    st->slots_capacity *= 2;
+    st->slots = allocate(allocation_symbol_table, st->slots_capacity * sizeof(symbol_table_slot_t));
+    for (size_t slot_index = 0; slot_index < st->slots_capacity; slot_index++) {
+        st->slots[slot_index].entry = EMPTY_SLOT;
     }
-    if(index == TABLE_SIZE) {
-        return BUCKET_LIST_END;
+    for (size_t entry_index = 0; entry_index < st->size; entry_index++) {
+        symbol_table_insert_slot(st, st->entries[entry_index].hash, entry_index);
     }
-    return index;
+}
+
+
+size_t probe_distance(const symbol_table_t* st, size_t slot_index) {
+    size_t mask = st->slots_capacity - 1;
+    return (slot_index - (st->slots[slot_index].hash & mask)) & mask;
+}
+
+
+void symbol_table_print(FILE* stream, const symbol_table_t* st) {
+    for (size_t entry_index = 0; entry_index < st->size; entry_index++) {
+        symbol_t* symbol = st->entries[entry_index].symbol;
+        fprintf(stream, "[ %zu ] : {%s, %d, %d, %s}\n",
+                entry_index,
+                symbol->value,
+                symbol->type,
+                symbol->data_type,
+                symbol->scope == SYMBOL_SCOPE_GLOBAL ?
+                    "GLOBAL" : symbol->scope->value);
+    }
+}
+
+
+void symbol_table_print_statistics(FILE* stream, const symbol_table_t* st) {
+    size_t histogram[PROBE_HISTOGRAM_SIZE] = { 0 };
+    size_t displaced = 0;
+    size_t total_distance = 0;
+    size_t max_distance = 0;
+
+    for (size_t slot_index = 0; slot_index < st->slots_capacity; slot_index++) {
+        if(st->slots[slot_index].entry == EMPTY_SLOT) {
+            continue;
+        }
+        size_t distance = probe_distance(st, slot_index);
+        displaced += distance > 0 ? 1 : 0;
+        total_distance += distance;
+        max_distance = distance > max_distance ? distance : max_distance;
+        histogram[distance < PROBE_HISTOGRAM_SIZE - 1 ? distance : PROBE_HISTOGRAM_SIZE - 1]++;
+    }
+
+    fprintf(stream, "Symbol table: %zu symbols in %zu slots (load factor %.2f)\n",
+            st->size, st->slots_capacity, (double)st->size / st->slots_capacity);
+    fprintf(stream, "  collisions (symbols outside their home slot): %zu\n", displaced);
+    fprintf(stream, "  probe length: average %.2f, maximum %zu\n",
+            st->size > 0 ? (double)total_distance / st->size : 0.0, max_distance);
+    for (size_t distance = 0; distance < PROBE_HISTOGRAM_SIZE; distance++) {
+        fprintf(stream, "  probe length %s%zu: %zu\n",
+                distance == PROBE_HISTOGRAM_SIZE - 1 ? ">=" : "",
+                distance, histogram[distance]);
+    }
+}
+
+
+size_t symbol_table_hash(const char* key, size_t length) {
+    // 64 bit FNV-1a followed by the murmur3 finalizer, so that the low
+    // bits used to pick a slot depend on every character of the key
+    uint64_t calculated_hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < length; i++) {
+        calculated_hash ^= (unsigned char)key[i];
+        calculated_hash *= 1099511628211ULL;
+    }
+    calculated_hash ^= calculated_hash >> 33;
+    calculated_hash *= 0xff51afd7ed558ccdULL;
+    calculated_hash ^= calculated_hash >> 33;
+    calculated_hash *= 0xc4ceb9fe1a85ec53ULL;
+    calculated_hash ^= calculated_hash >> 33;
+    return (size_t)calculated_hash;
 }
 
 symbol_table_iterator_t symbol_table_begin(symbol_table_t* st) {
     symbol_table_iterator_t it;
     it.table = st;
-    it.current_bucket_index = next_non_empty_bucket(st, -1);
-    if (it.current_bucket_index != BUCKET_LIST_END) {
-        it.current_bucket = list_begin(st->bucket[it.current_bucket_index]);
-    }
+    it.index = 0;
     return it;
 }
 
 symbol_table_iterator_t symbol_table_next(symbol_table_iterator_t* it) {
-    list_iterator_t next = list_next(&(it->current_bucket));
-    symbol_t* current = list_current(next);
-    if(current == NULL) {
-        size_t next_index = next_non_empty_bucket(it->table, it->current_bucket_index);
-        if(next_index != BUCKET_LIST_END) {
-            it->current_bucket_index = next_index;
-            it->current_bucket = list_begin(it->table->bucket[next_index]);
-        }
+    if(it->index < it->table->size) {
+        it->index++;
     }
     return *it;
 }
 
 symbol_t* symbol_table_current(symbol_table_iterator_t it) {
-    return (it.current_bucket_index != BUCKET_LIST_END) ? list_current(it.current_bucket) : NULL;
-}
\ No newline at end of file
+    return (it.index < it.table->size) ? it.table->entries[it.index].symbol : NULL;
+}
@@ -11,34 +11,75 @@ typedef struct symbol_table symbol_table_t;
 
 typedef struct symbol_table_iterator symbol_table_iterator_t;
 
+typedef struct symbol_table_name_iterator symbol_table_name_iterator_t;
+
 symbol_table_t* new_symbol_table();
 
 void delete_symbol_table(symbol_table_t* st);
 
-symbol_t* symbol_table_add(const symbol_table_t* st, const char* symbol, 
+symbol_t* symbol_table_add(symbol_table_t* st, const char* symbol, 
                            symbol_type_t type, int first_defined_at_line);
 
-symbol_t* symbol_table_add_with_scope(const symbol_table_t* st, const char* symbol, 
+symbol_t* symbol_table_add_with_scope(symbol_table_t* st, const char* symbol, 
                            symbol_type_t type, int first_defined_at_line, symbol_t* scope);
 
-symbol_t* symbol_table_get(symbol_table_t* st, char* key, symbol_t* scope);
+/*
+ * Gives the symbol a new name, allocated as an allocation_string, and
+ * releases the old one. Names must only change through here, since the
+ * table keeps the hash and length of every name.
+ */
+void symbol_table_rename(symbol_table_t* st, symbol_t* symbol, char* value);
+
+symbol_t* symbol_table_get(const symbol_table_t* st, const char* key, symbol_t* scope);
 
-bool symbol_table_contains(symbol_table_t* st, char* key, 
+bool symbol_table_contains(const symbol_table_t* st, const char* key, 
                            symbol_t* scope);
 
+/*
+ * Lookups by key and length that never allocate. key does not need to be
+ * null terminated. The hashed variant takes a hash computed beforehand
+ * with symbol_table_hash, for callers probing several scopes for the same
+ * name.
+ */
+size_t symbol_table_hash(const char* key, size_t length);
+
+symbol_t* symbol_table_lookup(const symbol_table_t* st, const char* key, size_t length,
+                              symbol_t* scope);
+
+symbol_t* symbol_table_lookup_hashed(const symbol_table_t* st, const char* key, size_t length,
+                                     size_t key_hash, symbol_t* scope);
+
+size_t symbol_table_size(const symbol_table_t* st);
+
 void symbol_table_print(FILE* stream, const symbol_table_t* st);
 
+void symbol_table_print_statistics(FILE* stream, const symbol_table_t* st);
+
 symbol_table_iterator_t symbol_table_begin(symbol_table_t* st);
 
 symbol_table_iterator_t symbol_table_next(symbol_table_iterator_t* it);
 
 symbol_t* symbol_table_current(symbol_table_iterator_t it);
 
+/*
+ * Iterates, in insertion order, over every symbol with the given name,
+ * whatever its scope.
+ */
+symbol_table_name_iterator_t symbol_table_name_begin(symbol_table_t* st, const char* key, 
+                                                     size_t length, size_t key_hash);
+
+symbol_table_name_iterator_t symbol_table_name_next(symbol_table_name_iterator_t* it);
+
+symbol_t* symbol_table_name_current(symbol_table_name_iterator_t it);
+
 struct symbol_table_iterator {
   symbol_table_t* table;
-  size_t current_bucket_index;
-  list_iterator_t current_bucket;
-  symbol_t* current;
+  size_t index;
+};
+
+struct symbol_table_name_iterator {
+  symbol_table_t* table;
+  size_t index;
 };
 
 #endif
@@ -2,9 +2,14 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include "syntax_tree.h"
+#include "allocation.h"
 
 struct ast {
     ast_node_t* root;
+    // Owns every node and children list of the tree
+    arena_t* arena;
+    size_t node_count;
+    allocation_mark_t mark;
 };
 
 struct ast_node {
@@ -28,8 +33,11 @@ void decompile(FILE* stream, ast_t* ast) {
 }
 
 ast_t* new_ast() {
-    ast_t* ast = malloc(sizeof(ast_t));
+    ast_t* ast = allocate(allocation_ast, sizeof(ast_t));
     ast->root = NULL;
+    ast->mark = allocation_mark();
+    ast->arena = new_arena(ARENA_DEFAULT_BLOCK_SIZE, allocation_ast);
+    ast->node_count = 0;
     return ast;
 }
 
@@ -61,15 +69,19 @@ ast_node_t* ast_get_root(ast_t* ast) {
 }
 
 void delete_ast(ast_t* ast) {
-    delete_ast_node(ast->root);
-    free(ast);
+    delete_arena(ast->arena);
+    allocation_check_leaks(&ast->mark, allocation_ast, "delete_ast");
+    release(allocation_ast, ast);
 }
 
-ast_node_t* new_ast_node(ast_node_type_t type, size_t children_quantity,...) {
-    ast_node_t* new_node = malloc(sizeof(ast_node_t));
-    new_node->children = new_list();
+ast_node_t* new_ast_node(ast_t* ast, ast_node_type_t type, size_t children_quantity,...) {
+    ast_node_t* new_node = arena_allocate(ast->arena, sizeof(ast_node_t));
+    ast->node_count++;
+    new_node->children = new_list_in_arena(ast->arena);
     new_node->type = type;
     new_node->symbol = NULL;
+    new_node->scope = SYMBOL_SCOPE_GLOBAL;
+    new_node->evaluated_data_type = data_type_undefined;
 
     va_list ap;
     va_start(ap, children_quantity);
@@ -83,12 +95,15 @@ ast_node_t* new_ast_node(ast_node_type_t type, size_t children_quantity,...) {
     return new_node;
 }
 
-ast_node_t* new_ast_symbol_node(symbol_t* symbol) {
-    ast_node_t* new_node = malloc(sizeof(ast_node_t));
+ast_node_t* new_ast_symbol_node(ast_t* ast, symbol_t* symbol) {
+    ast_node_t* new_node = arena_allocate(ast->arena, sizeof(ast_node_t));
+    ast->node_count++;
 
     new_node->symbol = symbol;
     new_node->type = ast_symbol;
-    new_node->children = new_list();
+    new_node->children = new_list_in_arena(ast->arena);
+    new_node->scope = SYMBOL_SCOPE_GLOBAL;
+    new_node->evaluated_data_type = data_type_undefined;
 
     return new_node;
 }
@@ -122,12 +137,6 @@ void ast_node_set_evaluated_data_type(ast_node_t* node, data_type_t evaluated_da
 }
 
 
-void delete_ast_node(ast_node_t* node) {
-    delete_list(node->children, (void (*)(list_element_t*))&delete_ast_node);
-    free(node);
-}
-
-
 void ast_print(FILE* stream, ast_t* ast) {
     fprintf(stream, "Printing Abstract Syntax Tree:\n");
     if (ast == NULL) {
@@ -136,6 +145,14 @@ void ast_print(FILE* stream, ast_t* ast) {
     ast_node_print(stream, ast->root, 0);
 }
 
+size_t ast_node_count(const ast_t* ast) {
+    return ast->node_count;
+}
+
+void ast_print_memory_stats(FILE* stream, ast_t* ast) {
+    arena_print_stats(stream, "Abstract Syntax Tree", ast->arena);
+}
+
 void ast_node_print(FILE* stream, ast_node_t* node, int depth) {
     if (node == NULL) {
         return;
@@ -3,6 +3,7 @@
 
 #include "symbol_table.h"
 #include "list.h"
+#include "arena.h"
 
 typedef struct ast ast_t;
 
@@ -61,9 +62,9 @@ ast_node_t* ast_get_root(ast_t* ast);
 
 void delete_ast(ast_t* ast);
 
-ast_node_t* new_ast_node(ast_node_type_t type, size_t children_quantity,...);
+ast_node_t* new_ast_node(ast_t* ast, ast_node_type_t type, size_t children_quantity,...);
 
-ast_node_t* new_ast_symbol_node(symbol_t* symbol);
+ast_node_t* new_ast_symbol_node(ast_t* ast, symbol_t* symbol);
 
 symbol_t* ast_node_get_symbol(ast_node_t* node);
 
@@ -79,10 +80,12 @@ data_type_t ast_node_get_evaluated_data_type(ast_node_t* node);
 
 void ast_node_set_evaluated_data_type(ast_node_t* node, data_type_t evaluated_data_type);
 
-void delete_ast_node(ast_node_t* node);
-
 void ast_print(FILE* stream, ast_t* ast);
 
+size_t ast_node_count(const ast_t* ast);
+
+void ast_print_memory_stats(FILE* stream, ast_t* ast);
+
 void decompile(FILE* stream, ast_t* ast);
 
 #endif
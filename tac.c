@@ -2,8 +2,10 @@
 
 #include <stdlib.h>
 
+#include "allocation.h"
+
 tac_t* new_tac(tac_type_t type, symbol_t* res, symbol_t* op1, symbol_t* op2) {
-    tac_t* tac = malloc(sizeof(tac_t));
+    tac_t* tac = allocate(allocation_tac, sizeof(tac_t));
     tac->type = type;
     tac->res = res;
     tac->op1 = op1;
@@ -13,7 +15,93 @@ tac_t* new_tac(tac_type_t type, symbol_t* res, symbol_t* op1, symbol_t* op2) {
 
 
 void delete_tac(tac_t* tac) {
-    free(tac);
+    release(allocation_tac, tac);
+}
+
+
+symbol_t* tac_get_operand(tac_t* tac, tac_operand_t operand) {
+    switch(operand) {
+    case tac_operand_res:
+        return tac->res;
+    case tac_operand_op1:
+        return tac->op1;
+    case tac_operand_op2:
+        return tac->op2;
+    default:
+        return NOP;
+    }
+}
+
+
+void tac_set_operand(tac_t* tac, tac_operand_t operand, symbol_t* symbol) {
+    switch(operand) {
+    case tac_operand_res:
+        tac->res = symbol;
+        break;
+    case tac_operand_op1:
+        tac->op1 = symbol;
+        break;
+    case tac_operand_op2:
+        tac->op2 = symbol;
+        break;
+    }
+}
+
+
+bool tac_operand_is_definition(tac_type_t type, tac_operand_t operand) {
+    if(operand != tac_operand_res) {
+        return false;
+    }
+    switch(type) {
+    case tac_sum:
+    case tac_sub:
+    case tac_mul:
+    case tac_div:
+    case tac_eq:
+    case tac_dif:
+    case tac_gt:
+    case tac_ge:
+    case tac_lt:
+    case tac_le:
+    case tac_move:
+    case tac_vector_index:
+    case tac_call:
+    case tac_read:
+    case tac_parameter:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+bool tac_operand_is_use(tac_type_t type, tac_operand_t operand) {
+    switch(type) {
+    case tac_sum:
+    case tac_sub:
+    case tac_mul:
+    case tac_div:
+    case tac_eq:
+    case tac_dif:
+    case tac_gt:
+    case tac_ge:
+    case tac_lt:
+    case tac_le:
+    case tac_vector_index:
+        return operand == tac_operand_op1 || operand == tac_operand_op2;
+    case tac_move:
+    case tac_jump_false:
+        return operand == tac_operand_op1;
+    // the vector itself is read to compute the address being written
+    case tac_vector_move:
+        return true;
+    case tac_argument:
+    case tac_return:
+    case tac_print:
+        return operand == tac_operand_res;
+    default:
+        return false;
+    }
 }
 
 
@@ -42,8 +42,18 @@ typedef enum tac_type {
     tac_label
 } tac_type_t;
 
+#define TAC_TYPE_COUNT (tac_label + 1)
+
 #define NOP NULL
 
+typedef enum tac_operand {
+    tac_operand_res,
+    tac_operand_op1,
+    tac_operand_op2
+} tac_operand_t;
+
+#define TAC_OPERANDS 3
+
 typedef struct tac {
     tac_type_t type; 
     symbol_t* res;
@@ -53,6 +63,16 @@ typedef struct tac {
 
 tac_t* new_tac(tac_type_t type, symbol_t* res, symbol_t* op1, symbol_t* op2);
 
+symbol_t* tac_get_operand(tac_t* tac, tac_operand_t operand);
+
+void tac_set_operand(tac_t* tac, tac_operand_t operand, symbol_t* symbol);
+
+// Whether the operand is a value written by the instruction
+bool tac_operand_is_definition(tac_type_t type, tac_operand_t operand);
+
+// Whether the operand is a value read by the instruction
+bool tac_operand_is_use(tac_type_t type, tac_operand_t operand);
+
 void delete_tac(tac_t* tac);
 
 char* tac_type_to_string(tac_type_t type);
@@ -0,0 +1,460 @@
+#include "tac_buffer.h"
+
+#include <stdlib.h>
+
+#include "allocation.h"
+
+#define INITIAL_BUFFER_CAPACITY 256
+
+typedef struct tac_instruction {
+    tac_t tac;
+    tac_id_t previous;
+    tac_id_t next;
+    tac_id_t next_definition;
+    bool removed;
+} tac_instruction_t;
+
+typedef struct tac_use_link {
+    tac_use_t use;
+    tac_use_id_t next;
+} tac_use_link_t;
+
+typedef struct tac_symbol_chains {
+    tac_id_t first_definition;
+    tac_id_t last_definition;
+    tac_use_id_t first_use;
+    tac_use_id_t last_use;
+    size_t definitions;
+    size_t uses;
+} tac_symbol_chains_t;
+
+struct tac_buffer {
+    symbol_table_t* st;
+    tac_instruction_t* instructions;
+    size_t count;
+    size_t capacity;
+    size_t removed;
+    tac_id_t first;
+    tac_id_t last;
+    tac_function_range_t* functions;
+    size_t function_count;
+    size_t functions_capacity;
+    tac_symbol_chains_t* chains;
+    size_t chains_size;
+    tac_use_link_t* uses;
+    size_t use_count;
+    size_t uses_capacity;
+};
+
+tac_id_t tac_buffer_new_instruction(tac_buffer_t* buffer, tac_t tac);
+
+void tac_buffer_index_functions(tac_buffer_t* buffer);
+
+const tac_symbol_chains_t* tac_buffer_symbol_chains(const tac_buffer_t* buffer, symbol_t* symbol);
+
+void tac_buffer_add_definition(tac_buffer_t* buffer, symbol_t* symbol, tac_id_t id);
+
+void tac_buffer_add_use(tac_buffer_t* buffer, symbol_t* symbol, tac_id_t id, tac_operand_t operand);
+
+
+tac_buffer_t* new_tac_buffer(symbol_table_t* st) {
+    tac_buffer_t* buffer = allocate(allocation_tac_buffer, sizeof(tac_buffer_t));
+    buffer->st = st;
+    buffer->capacity = INITIAL_BUFFER_CAPACITY;
+    buffer->instructions = allocate(allocation_tac_buffer, buffer->capacity * sizeof(tac_instruction_t));
+    buffer->count = 0;
+    buffer->removed = 0;
+    buffer->first = TAC_ID_NONE;
+    buffer->last = TAC_ID_NONE;
+    buffer->functions = NULL;
+    buffer->function_count = 0;
+    buffer->functions_capacity = 0;
+    buffer->chains = NULL;
+    buffer->chains_size = 0;
+    buffer->uses = NULL;
+    buffer->use_count = 0;
+    buffer->uses_capacity = 0;
+    return buffer;
+}
+
+
+tac_buffer_t* new_tac_buffer_from_list(tac_list_t* tacs, symbol_table_t* st) {
+    tac_buffer_t* buffer = new_tac_buffer(st);
+    for(list_iterator_t it = list_begin(tacs); list_current(it) != NULL; list_next(&it)) {
+        tac_buffer_append(buffer, *(tac_t*)list_current(it));
+    }
+    tac_buffer_index_functions(buffer);
+    return buffer;
+}
+
+
+void delete_tac_buffer(tac_buffer_t* buffer) {
+    release(allocation_tac_buffer, buffer->instructions);
+    release(allocation_tac_buffer, buffer->functions);
+    release(allocation_tac_buffer, buffer->chains);
+    release(allocation_tac_buffer, buffer->uses);
+    release(allocation_tac_buffer, buffer);
+}
+
+
+tac_list_t* tac_buffer_to_list(tac_buffer_t* buffer) {
+    tac_list_t* tacs = new_list();
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        list_push_back(tacs, new_tac(tac->type, tac->res, tac->op1, tac->op2));
+    }
+    return tacs;
+}
+
+
+size_t tac_buffer_size(const tac_buffer_t* buffer) {
+    return buffer->count - buffer->removed;
+}
+
+
+tac_t* tac_buffer_get(tac_buffer_t* buffer, tac_id_t id) {
+    return &buffer->instructions[id].tac;
+}
+
+
+bool tac_buffer_is_removed(const tac_buffer_t* buffer, tac_id_t id) {
+    return buffer->instructions[id].removed;
+}
+
+
+tac_id_t tac_buffer_first(const tac_buffer_t* buffer) {
+    return buffer->first;
+}
+
+
+tac_id_t tac_buffer_last(const tac_buffer_t* buffer) {
+    return buffer->last;
+}
+
+
+tac_id_t tac_buffer_next(const tac_buffer_t* buffer, tac_id_t id) {
+    return buffer->instructions[id].next;
+}
+
+
+tac_id_t tac_buffer_previous(const tac_buffer_t* buffer, tac_id_t id) {
+    return buffer->instructions[id].previous;
+}
+
+
+tac_id_t tac_buffer_new_instruction(tac_buffer_t* buffer, tac_t tac) {
+    if(buffer->count == buffer->capacity) {
+        buffer->capacity *= 2;
+        buffer->instructions = reallocate(allocation_tac_buffer, buffer->instructions,
+                                       buffer->capacity * sizeof(tac_instruction_t));
+    }
+    tac_id_t id = buffer->count++;
+    tac_instruction_t* instruction = &buffer->instructions[id];
+    instruction->tac = tac;
+    instruction->previous = TAC_ID_NONE;
+    instruction->next = TAC_ID_NONE;
+    instruction->next_definition = TAC_ID_NONE;
+    instruction->removed = false;
+    return id;
+}
+
+
+tac_id_t tac_buffer_append(tac_buffer_t* buffer, tac_t tac) {
+    if(buffer->last == TAC_ID_NONE) {
+        tac_id_t id = tac_buffer_new_instruction(buffer, tac);
+        buffer->first = id;
+        buffer->last = id;
+        return id;
+    }
+    return tac_buffer_insert_after(buffer, buffer->last, tac);
+}
+
+
+tac_id_t tac_buffer_insert_before(tac_buffer_t* buffer, tac_id_t position, tac_t tac) {
+    tac_id_t id = tac_buffer_new_instruction(buffer, tac);
+    tac_instruction_t* instruction = &buffer->instructions[id];
+    tac_instruction_t* next = &buffer->instructions[position];
+    instruction->previous = next->previous;
+    instruction->next = position;
+    if(next->previous != TAC_ID_NONE) {
+        buffer->instructions[next->previous].next = id;
+    } else {
+        buffer->first = id;
+    }
+    next->previous = id;
+    return id;
+}
+
+
+tac_id_t tac_buffer_insert_after(tac_buffer_t* buffer, tac_id_t position, tac_t tac) {
+    tac_id_t id = tac_buffer_new_instruction(buffer, tac);
+    tac_instruction_t* instruction = &buffer->instructions[id];
+    tac_instruction_t* previous = &buffer->instructions[position];
+    instruction->previous = position;
+    instruction->next = previous->next;
+    if(previous->next != TAC_ID_NONE) {
+        buffer->instructions[previous->next].previous = id;
+    } else {
+        buffer->last = id;
+    }
+    previous->next = id;
+    return id;
+}
+
+
+void tac_buffer_remove(tac_buffer_t* buffer, tac_id_t id) {
+    tac_instruction_t* instruction = &buffer->instructions[id];
+    if(instruction->removed) {
+        return;
+    }
+    if(instruction->previous != TAC_ID_NONE) {
+        buffer->instructions[instruction->previous].next = instruction->next;
+    } else {
+        buffer->first = instruction->next;
+    }
+    if(instruction->next != TAC_ID_NONE) {
+        buffer->instructions[instruction->next].previous = instruction->previous;
+    } else {
+        buffer->last = instruction->previous;
+    }
+    // Links are kept so that iteration can continue from a removed id
+    instruction->removed = true;
+    buffer->removed++;
+}
+
+
+void tac_buffer_move_after(tac_buffer_t* buffer, tac_id_t first, tac_id_t last, tac_id_t position) {
+    tac_instruction_t* instructions = buffer->instructions;
+    tac_id_t before = instructions[first].previous;
+    tac_id_t after = instructions[last].next;
+    if(before != TAC_ID_NONE) {
+        instructions[before].next = after;
+    } else {
+        buffer->first = after;
+    }
+    if(after != TAC_ID_NONE) {
+        instructions[after].previous = before;
+    } else {
+        buffer->last = before;
+    }
+
+    tac_id_t next = instructions[position].next;
+    instructions[position].next = first;
+    instructions[first].previous = position;
+    instructions[last].next = next;
+    if(next != TAC_ID_NONE) {
+        instructions[next].previous = last;
+    } else {
+        buffer->last = last;
+    }
+}
+
+
+void tac_buffer_compact(tac_buffer_t* buffer) {
+    size_t size = tac_buffer_size(buffer);
+    size_t capacity = size > INITIAL_BUFFER_CAPACITY ? size : INITIAL_BUFFER_CAPACITY;
+    tac_instruction_t* instructions = allocate(allocation_tac_buffer, capacity * sizeof(tac_instruction_t));
+
+    tac_id_t new_id = 0;
+    for(tac_id_t id = buffer->first; id != TAC_ID_NONE; id = buffer->instructions[id].next) {
+        instructions[new_id].tac = buffer->instructions[id].tac;
+        instructions[new_id].previous = new_id == 0 ? TAC_ID_NONE : new_id - 1;
+        instructions[new_id].next = new_id + 1 == size ? TAC_ID_NONE : new_id + 1;
+        instructions[new_id].next_definition = TAC_ID_NONE;
+        instructions[new_id].removed = false;
+        new_id++;
+    }
+
+    release(allocation_tac_buffer, buffer->instructions);
+    buffer->instructions = instructions;
+    buffer->capacity = capacity;
+    buffer->count = size;
+    buffer->removed = 0;
+    buffer->first = size > 0 ? 0 : TAC_ID_NONE;
+    buffer->last = size > 0 ? size - 1 : TAC_ID_NONE;
+    buffer->use_count = 0;
+    buffer->chains_size = 0;
+    tac_buffer_index_functions(buffer);
+}
+
+
+void tac_buffer_index_functions(tac_buffer_t* buffer) {
+    buffer->function_count = 0;
+    for(tac_id_t id = buffer->first; id != TAC_ID_NONE; id = buffer->instructions[id].next) {
+        tac_t* tac = &buffer->instructions[id].tac;
+        if(tac->type == tac_begin_function) {
+            if(buffer->function_count == buffer->functions_capacity) {
+                buffer->functions_capacity = buffer->functions_capacity == 0 ?
+                                             16 : buffer->functions_capacity * 2;
+                buffer->functions = reallocate(allocation_tac_buffer, buffer->functions,
+                                            buffer->functions_capacity * sizeof(tac_function_range_t));
+            }
+            tac_function_range_t* range = &buffer->functions[buffer->function_count++];
+            range->function = tac->res;
+            range->begin = id;
+            range->end = TAC_ID_NONE;
+        } else if(tac->type == tac_end_function && buffer->function_count > 0) {
+            buffer->functions[buffer->function_count - 1].end = id;
+        }
+    }
+}
+
+
+size_t tac_buffer_function_count(const tac_buffer_t* buffer) {
+    return buffer->function_count;
+}
+
+
+tac_function_range_t tac_buffer_function(const tac_buffer_t* buffer, size_t index) {
+    return buffer->functions[index];
+}
+
+
+void tac_buffer_build_chains(tac_buffer_t* buffer) {
+    size_t symbols = symbol_table_size(buffer->st);
+    if(symbols > buffer->chains_size) {
+        release(allocation_tac_buffer, buffer->chains);
+        buffer->chains = allocate(allocation_tac_buffer, symbols * sizeof(tac_symbol_chains_t));
+    }
+    buffer->chains_size = symbols;
+    for(size_t i = 0; i < symbols; i++) {
+        buffer->chains[i].first_definition = TAC_ID_NONE;
+        buffer->chains[i].last_definition = TAC_ID_NONE;
+        buffer->chains[i].first_use = TAC_USE_NONE;
+        buffer->chains[i].last_use = TAC_USE_NONE;
+        buffer->chains[i].definitions = 0;
+        buffer->chains[i].uses = 0;
+    }
+    buffer->use_count = 0;
+
+    for(tac_id_t id = buffer->first; id != TAC_ID_NONE; id = buffer->instructions[id].next) {
+        tac_instruction_t* instruction = &buffer->instructions[id];
+        instruction->next_definition = TAC_ID_NONE;
+        for(tac_operand_t operand = tac_operand_res; operand < TAC_OPERANDS; operand++) {
+            symbol_t* symbol = tac_get_operand(&instruction->tac, operand);
+            if(symbol == NOP) {
+                continue;
+            }
+            if(tac_operand_is_definition(instruction->tac.type, operand)) {
+                tac_buffer_add_definition(buffer, symbol, id);
+            } else if(tac_operand_is_use(instruction->tac.type, operand)) {
+                tac_buffer_add_use(buffer, symbol, id, operand);
+            }
+        }
+    }
+    tac_buffer_index_functions(buffer);
+}
+
+
+void tac_buffer_add_definition(tac_buffer_t* buffer, symbol_t* symbol, tac_id_t id) {
+    if(symbol->id >= buffer->chains_size) {
+        return;
+    }
+    tac_symbol_chains_t* chains = &buffer->chains[symbol->id];
+    if(chains->last_definition == TAC_ID_NONE) {
+        chains->first_definition = id;
+    } else {
+        buffer->instructions[chains->last_definition].next_definition = id;
+    }
+    chains->last_definition = id;
+    chains->definitions++;
+}
+
+
+void tac_buffer_add_use(tac_buffer_t* buffer, symbol_t* symbol, tac_id_t id, tac_operand_t operand) {
+    if(symbol->id >= buffer->chains_size) {
+        return;
+    }
+    if(buffer->use_count == buffer->uses_capacity) {
+        buffer->uses_capacity = buffer->uses_capacity == 0 ?
+                                INITIAL_BUFFER_CAPACITY : buffer->uses_capacity * 2;
+        buffer->uses = reallocate(allocation_tac_buffer, buffer->uses,
+                                   buffer->uses_capacity * sizeof(tac_use_link_t));
+    }
+    tac_use_id_t use = buffer->use_count++;
+    buffer->uses[use].use.instruction = id;
+    buffer->uses[use].use.operand = operand;
+    buffer->uses[use].next = TAC_USE_NONE;
+
+    tac_symbol_chains_t* chains = &buffer->chains[symbol->id];
+    if(chains->last_use == TAC_USE_NONE) {
+        chains->first_use = use;
+    } else {
+        buffer->uses[chains->last_use].next = use;
+    }
+    chains->last_use = use;
+    chains->uses++;
+}
+
+
+const tac_symbol_chains_t* tac_buffer_symbol_chains(const tac_buffer_t* buffer, symbol_t* symbol) {
+    if(symbol == NOP || symbol->id >= buffer->chains_size) {
+        return NULL;
+    }
+    return &buffer->chains[symbol->id];
+}
+
+
+tac_id_t tac_buffer_first_definition(const tac_buffer_t* buffer, symbol_t* symbol) {
+    const tac_symbol_chains_t* chains = tac_buffer_symbol_chains(buffer, symbol);
+    return chains != NULL ? chains->first_definition : TAC_ID_NONE;
+}
+
+
+tac_id_t tac_buffer_next_definition(const tac_buffer_t* buffer, tac_id_t id) {
+    return buffer->instructions[id].next_definition;
+}
+
+
+size_t tac_buffer_definition_count(const tac_buffer_t* buffer, symbol_t* symbol) {
+    const tac_symbol_chains_t* chains = tac_buffer_symbol_chains(buffer, symbol);
+    return chains != NULL ? chains->definitions : 0;
+}
+
+
+tac_use_id_t tac_buffer_first_use(const tac_buffer_t* buffer, symbol_t* symbol) {
+    const tac_symbol_chains_t* chains = tac_buffer_symbol_chains(buffer, symbol);
+    return chains != NULL ? chains->first_use : TAC_USE_NONE;
+}
+
+
+tac_use_id_t tac_buffer_next_use(const tac_buffer_t* buffer, tac_use_id_t use) {
+    return buffer->uses[use].next;
+}
+
+
+tac_use_t tac_buffer_use(const tac_buffer_t* buffer, tac_use_id_t use) {
+    return buffer->uses[use].use;
+}
+
+
+size_t tac_buffer_use_count(const tac_buffer_t* buffer, symbol_t* symbol) {
+    const tac_symbol_chains_t* chains = tac_buffer_symbol_chains(buffer, symbol);
+    return chains != NULL ? chains->uses : 0;
+}
+
+
+tac_id_t tac_buffer_reaching_definition(tac_buffer_t* buffer, tac_id_t id, tac_operand_t operand) {
+    symbol_t* symbol = tac_get_operand(tac_buffer_get(buffer, id), operand);
+    if(tac_buffer_definition_count(buffer, symbol) != 1) {
+        return TAC_ID_NONE;
+    }
+    return tac_buffer_first_definition(buffer, symbol);
+}
+
+
+void tac_buffer_print(FILE* stream, tac_buffer_t* buffer) {
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        fprintf(stream, "%zu: TAC(%s, %s, %s, %s)",
+                id,
+                tac_type_to_string(tac->type),
+                tac->res != NOP ? tac->res->value : "NOP",
+                tac->op1 != NOP ? tac->op1->value : "NOP",
+                tac->op2 != NOP ? tac->op2->value : "NOP");
+        if(tac_operand_is_definition(tac->type, tac_operand_res)) {
+            fprintf(stream, " uses: %zu", tac_buffer_use_count(buffer, tac->res));
+        }
+        fprintf(stream, "\n");
+    }
+}
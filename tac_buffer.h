@@ -0,0 +1,108 @@
+#ifndef TAC_BUFFER_H
+#define TAC_BUFFER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "tac.h"
+#include "symbol_table.h"
+
+/*
+ * Contiguous storage for a TAC program. Instructions are identified by
+ * their position in the buffer, which never changes: removed instructions
+ * become tombstones and inserted ones are appended and linked into place,
+ * until tac_buffer_compact renumbers everything in program order.
+ *
+ * Def-use chains list, for each symbol, the instructions writing it and
+ * the operands reading it. They are built by tac_buffer_build_chains and
+ * are not updated by later changes to the buffer.
+ */
+
+typedef struct tac_buffer tac_buffer_t;
+
+typedef size_t tac_id_t;
+
+#define TAC_ID_NONE ((tac_id_t)-1)
+
+typedef size_t tac_use_id_t;
+
+#define TAC_USE_NONE ((tac_use_id_t)-1)
+
+typedef struct tac_use {
+    tac_id_t instruction;
+    tac_operand_t operand;
+} tac_use_t;
+
+typedef struct tac_function_range {
+    symbol_t* function;
+    tac_id_t begin;
+    tac_id_t end;
+} tac_function_range_t;
+
+tac_buffer_t* new_tac_buffer(symbol_table_t* st);
+
+tac_buffer_t* new_tac_buffer_from_list(tac_list_t* tacs, symbol_table_t* st);
+
+void delete_tac_buffer(tac_buffer_t* buffer);
+
+tac_list_t* tac_buffer_to_list(tac_buffer_t* buffer);
+
+size_t tac_buffer_size(const tac_buffer_t* buffer);
+
+// Pointers are invalidated when instructions are added to the buffer
+tac_t* tac_buffer_get(tac_buffer_t* buffer, tac_id_t id);
+
+bool tac_buffer_is_removed(const tac_buffer_t* buffer, tac_id_t id);
+
+tac_id_t tac_buffer_first(const tac_buffer_t* buffer);
+
+tac_id_t tac_buffer_last(const tac_buffer_t* buffer);
+
+tac_id_t tac_buffer_next(const tac_buffer_t* buffer, tac_id_t id);
+
+tac_id_t tac_buffer_previous(const tac_buffer_t* buffer, tac_id_t id);
+
+tac_id_t tac_buffer_append(tac_buffer_t* buffer, tac_t tac);
+
+tac_id_t tac_buffer_insert_before(tac_buffer_t* buffer, tac_id_t position, tac_t tac);
+
+tac_id_t tac_buffer_insert_after(tac_buffer_t* buffer, tac_id_t position, tac_t tac);
+
+void tac_buffer_remove(tac_buffer_t* buffer, tac_id_t id);
+
+// Moves the instructions from first to last, in program order, after the
+// position, which must not be among them. They keep their ids.
+void tac_buffer_move_after(tac_buffer_t* buffer, tac_id_t first, tac_id_t last, tac_id_t position);
+
+void tac_buffer_compact(tac_buffer_t* buffer);
+
+size_t tac_buffer_function_count(const tac_buffer_t* buffer);
+
+tac_function_range_t tac_buffer_function(const tac_buffer_t* buffer, size_t index);
+
+void tac_buffer_build_chains(tac_buffer_t* buffer);
+
+tac_id_t tac_buffer_first_definition(const tac_buffer_t* buffer, symbol_t* symbol);
+
+tac_id_t tac_buffer_next_definition(const tac_buffer_t* buffer, tac_id_t id);
+
+size_t tac_buffer_definition_count(const tac_buffer_t* buffer, symbol_t* symbol);
+
+tac_use_id_t tac_buffer_first_use(const tac_buffer_t* buffer, symbol_t* symbol);
+
+tac_use_id_t tac_buffer_next_use(const tac_buffer_t* buffer, tac_use_id_t use);
+
+tac_use_t tac_buffer_use(const tac_buffer_t* buffer, tac_use_id_t use);
+
+size_t tac_buffer_use_count(const tac_buffer_t* buffer, symbol_t* symbol);
+
+/*
+ * Use-def chain of an operand. Temporaries are written once by the code
+ * generator, so for them this is their only definition; symbols with
+ * several definitions need a data flow analysis and give TAC_ID_NONE.
+ */
+tac_id_t tac_buffer_reaching_definition(tac_buffer_t* buffer, tac_id_t id, tac_operand_t operand);
+
+void tac_buffer_print(FILE* stream, tac_buffer_t* buffer);
+
+#endif
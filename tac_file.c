@@ -0,0 +1,443 @@
+#include "tac_file.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tac.h"
+
+#define TAC_FILE_MAGIC "ETAPATAC"
+#define TAC_FILE_NONE UINT32_MAX
+#define RES (1 << tac_operand_res)
+#define OP1 (1 << tac_operand_op1)
+#define OP2 (1 << tac_operand_op2)
+
+typedef struct tac_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t symbol_count;
+    uint32_t parameter_count;
+    uint32_t tac_count;
+    uint32_t strings_size;
+    uint32_t reserved;
+} tac_file_header_t;
+
+typedef struct tac_file_symbol {
+    uint32_t name;
+    uint32_t type;
+    uint32_t data_type;
+    uint32_t scope;
+    int32_t line;
+    uint32_t first_parameter;
+    uint32_t parameter_count;
+} tac_file_symbol_t;
+
+typedef struct tac_file_tac {
+    uint32_t type;
+    uint32_t operands[TAC_OPERANDS];
+} tac_file_tac_t;
+
+// Symbols in the order they are written, with an open addressing table
+// from each symbol to its index
+typedef struct tac_file_writer {
+    symbol_t** symbols;
+    size_t symbol_count;
+    size_t symbol_capacity;
+    symbol_t** slots;
+    uint32_t* slot_indices;
+    size_t slot_count;
+} tac_file_writer_t;
+
+// Operands the back end reads for each instruction, as values, as the
+// function, label or scope they name, or for the size of a vector. Float
+// initializers also read op2.
+static const uint8_t required_operands[TAC_TYPE_COUNT] = {
+    [tac_init] = RES | OP1,
+    [tac_temp] = RES,
+    [tac_literal] = 0,
+    [tac_vector_uninit] = RES | OP1,
+    [tac_vector_init] = RES | OP1,
+    [tac_vector_init_value] = RES | OP1,
+    [tac_vector_index] = RES | OP1 | OP2,
+    [tac_symbol] = 0,
+    [tac_sum] = RES | OP1 | OP2,
+    [tac_sub] = RES | OP1 | OP2,
+    [tac_mul] = RES | OP1 | OP2,
+    [tac_div] = RES | OP1 | OP2,
+    [tac_eq] = RES | OP1 | OP2,
+    [tac_dif] = RES | OP1 | OP2,
+    [tac_gt] = RES | OP1 | OP2,
+    [tac_ge] = RES | OP1 | OP2,
+    [tac_lt] = RES | OP1 | OP2,
+    [tac_le] = RES | OP1 | OP2,
+    [tac_move] = RES | OP1,
+    [tac_vector_move] = RES | OP1 | OP2,
+    [tac_begin_function] = RES,
+    [tac_end_function] = RES,
+    [tac_jump_false] = RES | OP1,
+    [tac_jump] = RES,
+    [tac_call] = RES | OP1,
+    [tac_argument] = RES,
+    [tac_parameter] = RES,
+    [tac_return] = RES | OP1,
+    [tac_print] = RES,
+    [tac_read] = RES,
+    [tac_label] = RES
+};
+
+struct tac_file {
+    void* mapping;
+    size_t mapping_size;
+    symbol_t* symbols;
+    size_t symbol_count;
+    tac_t* tacs;
+    list_t* code;
+};
+
+uint32_t tac_file_writer_add(tac_file_writer_t* writer, symbol_t* symbol);
+
+uint32_t tac_file_writer_find(const tac_file_writer_t* writer, const symbol_t* symbol);
+
+size_t tac_file_slot(const tac_file_writer_t* writer, const symbol_t* symbol);
+
+bool tac_file_is_valid(const uint8_t* data, size_t size);
+
+bool tac_file_requires_operand(const tac_file_tac_t* tac, const tac_file_symbol_t* symbols,
+                               tac_operand_t operand);
+
+uint32_t tac_file_function_operand(const tac_file_tac_t* tac);
+
+
+bool write_tac_file(FILE* stream, list_t* code) {
+    tac_file_writer_t writer = { NULL, 0, 0, NULL, NULL, 0 };
+    for(list_iterator_t it = list_begin(code); list_current(it) != NULL; list_next(&it)) {
+        tac_t* tac = list_current(it);
+        for(tac_operand_t operand = 0; operand < TAC_OPERANDS; operand++) {
+            tac_file_writer_add(&writer, tac_get_operand(tac, operand));
+        }
+    }
+    // Scopes and parameters may name symbols no instruction uses, so the
+    // list grows while it is walked
+    size_t parameter_count = 0;
+    for(size_t i = 0; i < writer.symbol_count; i++) {
+        symbol_t* symbol = writer.symbols[i];
+        tac_file_writer_add(&writer, symbol->scope);
+        if(symbol->parameters == NULL) {
+            continue;
+        }
+        parameter_count += list_size(symbol->parameters);
+        for(list_iterator_t it = list_begin(symbol->parameters); list_current(it) != NULL; list_next(&it)) {
+            tac_file_writer_add(&writer, list_current(it));
+        }
+    }
+
+    tac_file_symbol_t* symbols = malloc((writer.symbol_count + 1) * sizeof(tac_file_symbol_t));
+    uint32_t* parameters = malloc((parameter_count + 1) * sizeof(uint32_t));
+    size_t strings_size = 0;
+    size_t next_parameter = 0;
+    for(size_t i = 0; i < writer.symbol_count; i++) {
+        symbol_t* symbol = writer.symbols[i];
+        symbols[i].name = strings_size;
+        symbols[i].type = symbol->type;
+        symbols[i].data_type = symbol->data_type;
+        symbols[i].scope = tac_file_writer_find(&writer, symbol->scope);
+        symbols[i].line = symbol->first_define_at_line;
+        symbols[i].first_parameter = TAC_FILE_NONE;
+        symbols[i].parameter_count = TAC_FILE_NONE;
+        if(symbol->parameters != NULL) {
+            symbols[i].first_parameter = next_parameter;
+            symbols[i].parameter_count = list_size(symbol->parameters);
+            for(list_iterator_t it = list_begin(symbol->parameters); list_current(it) != NULL; list_next(&it)) {
+                parameters[next_parameter++] = tac_file_writer_find(&writer, list_current(it));
+            }
+        }
+        strings_size += strlen(symbol->value) + 1;
+    }
+
+    tac_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TAC_FILE_MAGIC, sizeof(header.magic));
+    header.version = TAC_FILE_VERSION;
+    header.symbol_count = writer.symbol_count;
+    header.parameter_count = parameter_count;
+    header.tac_count = list_size(code);
+    header.strings_size = strings_size;
+
+    bool success = fwrite(&header, sizeof(header), 1, stream) == 1;
+    success = success && fwrite(symbols, sizeof(tac_file_symbol_t), writer.symbol_count, stream)
+                         == writer.symbol_count;
+    success = success && fwrite(parameters, sizeof(uint32_t), parameter_count, stream) == parameter_count;
+    for(list_iterator_t it = list_begin(code); success && list_current(it) != NULL; list_next(&it)) {
+        tac_t* tac = list_current(it);
+        tac_file_tac_t record;
+        record.type = tac->type;
+        for(tac_operand_t operand = 0; operand < TAC_OPERANDS; operand++) {
+            record.operands[operand] = tac_file_writer_find(&writer, tac_get_operand(tac, operand));
+        }
+        success = fwrite(&record, sizeof(record), 1, stream) == 1;
+    }
+    for(size_t i = 0; success && i < writer.symbol_count; i++) {
+        const char* name = writer.symbols[i]->value;
+        success = fwrite(name, 1, strlen(name) + 1, stream) == strlen(name) + 1;
+    }
+
+    free(symbols);
+    free(parameters);
+    free(writer.symbols);
+    free(writer.slots);
+    free(writer.slot_indices);
+    return success;
+}
+
+
+tac_file_t* load_tac_file(const char* path) {
+    int descriptor = open(path, O_RDONLY);
+    if(descriptor == -1) {
+        return NULL;
+    }
+
+    struct stat status;
+    if(fstat(descriptor, &status) == -1) {
+        int error = errno;
+        close(descriptor);
+        errno = error;
+        return NULL;
+    }
+    size_t size = status.st_size;
+    if(size < sizeof(tac_file_header_t)) {
+        close(descriptor);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    int error = errno;
+    close(descriptor);
+    if(mapping == MAP_FAILED) {
+        errno = error;
+        return NULL;
+    }
+    if(!tac_file_is_valid(mapping, size)) {
+        munmap(mapping, size);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    const tac_file_header_t* header = mapping;
+    const tac_file_symbol_t* symbol_records = (const void*)(header + 1);
+    const uint32_t* parameters = (const void*)(symbol_records + header->symbol_count);
+    const tac_file_tac_t* tac_records = (const void*)(parameters + header->parameter_count);
+    char* strings = (char*)(tac_records + header->tac_count);
+
+    tac_file_t* file = malloc(sizeof(tac_file_t));
+    file->mapping = mapping;
+    file->mapping_size = size;
+    file->symbol_count = header->symbol_count;
+    file->symbols = malloc((header->symbol_count + 1) * sizeof(symbol_t));
+    file->tacs = malloc((header->tac_count + 1) * sizeof(tac_t));
+    file->code = new_list();
+
+    symbol_t* symbols = file->symbols;
+    for(size_t i = 0; i < header->symbol_count; i++) {
+        const tac_file_symbol_t* record = &symbol_records[i];
+        symbols[i].id = i;
+        symbols[i].value = strings + record->name;
+        symbols[i].type = record->type;
+        symbols[i].data_type = record->data_type;
+        symbols[i].scope = record->scope != TAC_FILE_NONE ? &symbols[record->scope] : NULL;
+        symbols[i].first_define_at_line = record->line;
+        symbols[i].parameters = NULL;
+        if(record->parameter_count != TAC_FILE_NONE) {
+            symbols[i].parameters = new_list();
+            for(size_t j = 0; j < record->parameter_count; j++) {
+                list_push_back(symbols[i].parameters, &symbols[parameters[record->first_parameter + j]]);
+            }
+        }
+    }
+    for(size_t i = 0; i < header->tac_count; i++) {
+        tac_t* tac = &file->tacs[i];
+        tac->type = tac_records[i].type;
+        for(tac_operand_t operand = 0; operand < TAC_OPERANDS; operand++) {
+            uint32_t index = tac_records[i].operands[operand];
+            tac_set_operand(tac, operand, index != TAC_FILE_NONE ? &symbols[index] : NOP);
+        }
+        list_push_back(file->code, tac);
+    }
+    return file;
+}
+
+
+void delete_tac_file(tac_file_t* file) {
+    if(file == NULL) {
+        return;
+    }
+    for(size_t i = 0; i < file->symbol_count; i++) {
+        delete_list(file->symbols[i].parameters, NULL);
+    }
+    delete_list(file->code, NULL);
+    free(file->symbols);
+    free(file->tacs);
+    munmap(file->mapping, file->mapping_size);
+    free(file);
+}
+
+
+list_t* tac_file_code(tac_file_t* file) {
+    return file->code;
+}
+
+
+uint32_t tac_file_writer_add(tac_file_writer_t* writer, symbol_t* symbol) {
+    if(symbol == NULL) {
+        return TAC_FILE_NONE;
+    }
+    if(2 * (writer->symbol_count + 1) > writer->slot_count) {
+        size_t old_count = writer->slot_count;
+        symbol_t** old_slots = writer->slots;
+        uint32_t* old_indices = writer->slot_indices;
+        writer->slot_count = old_count > 0 ? 2 * old_count : 256;
+        writer->slots = calloc(writer->slot_count, sizeof(symbol_t*));
+        writer->slot_indices = malloc(writer->slot_count * sizeof(uint32_t));
+        for(size_t i = 0; i < old_count; i++) {
+            if(old_slots[i] != NULL) {
+                size_t slot = tac_file_slot(writer, old_slots[i]);
+                writer->slots[slot] = old_slots[i];
+                writer->slot_indices[slot] = old_indices[i];
+            }
+        }
+        free(old_slots);
+        free(old_indices);
+    }
+
+    size_t slot = tac_file_slot(writer, symbol);
+    if(writer->slots[slot] == NULL) {
+        if(writer->symbol_count == writer->symbol_capacity) {
+            writer->symbol_capacity = writer->symbol_capacity > 0 ? 2 * writer->symbol_capacity : 256;
+            writer->symbols = realloc(writer->symbols, writer->symbol_capacity * sizeof(symbol_t*));
+        }
+        writer->slots[slot] = symbol;
+        writer->slot_indices[slot] = writer->symbol_count;
+        writer->symbols[writer->symbol_count++] = symbol;
+    }
+    return writer->slot_indices[slot];
+}
+
+
+uint32_t tac_file_writer_find(const tac_file_writer_t* writer, const symbol_t* symbol) {
+    if(symbol == NULL) {
+        return TAC_FILE_NONE;
+    }
+    return writer->slot_indices[tac_file_slot(writer, symbol)];
+}
+
+
+// Slot holding the symbol, or the empty slot where it belongs
+size_t tac_file_slot(const tac_file_writer_t* writer, const symbol_t* symbol) {
+    size_t mask = writer->slot_count - 1;
+    size_t slot = ((uintptr_t)symbol >> 4) * 0x9E3779B97F4A7C15ULL & mask;
+    while(writer->slots[slot] != NULL && writer->slots[slot] != symbol) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+
+// Checks every size, index and enumeration in the file, and that every
+// instruction has the operands the back end reads, so that loading can
+// trust the records
+bool tac_file_is_valid(const uint8_t* data, size_t size) {
+    const tac_file_header_t* header = (const void*)data;
+    if(memcmp(header->magic, TAC_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+       header->version != TAC_FILE_VERSION) {
+        return false;
+    }
+    uint64_t expected_size = sizeof(tac_file_header_t) +
+                             (uint64_t)header->symbol_count * sizeof(tac_file_symbol_t) +
+                             (uint64_t)header->parameter_count * sizeof(uint32_t) +
+                             (uint64_t)header->tac_count * sizeof(tac_file_tac_t) +
+                             header->strings_size;
+    if(expected_size != size) {
+        return false;
+    }
+
+    const tac_file_symbol_t* symbols = (const void*)(header + 1);
+    const uint32_t* parameters = (const void*)(symbols + header->symbol_count);
+    const tac_file_tac_t* tacs = (const void*)(parameters + header->parameter_count);
+    const char* strings = (const char*)(tacs + header->tac_count);
+    if(header->strings_size > 0 && strings[header->strings_size - 1] != '\0') {
+        return false;
+    }
+
+    for(size_t i = 0; i < header->symbol_count; i++) {
+        const tac_file_symbol_t* symbol = &symbols[i];
+        if(symbol->name >= header->strings_size ||
+           symbol->type >= SYMBOL_TYPE_COUNT ||
+           symbol->data_type > data_type_bool ||
+           (symbol->scope != TAC_FILE_NONE && symbol->scope >= header->symbol_count)) {
+            return false;
+        }
+        if(symbol->parameter_count != TAC_FILE_NONE &&
+           (uint64_t)symbol->first_parameter + symbol->parameter_count > header->parameter_count) {
+            return false;
+        }
+        // Functions are generated from their parameter list
+        if(symbol->type == symbol_function && symbol->parameter_count == TAC_FILE_NONE) {
+            return false;
+        }
+    }
+    for(size_t i = 0; i < header->parameter_count; i++) {
+        if(parameters[i] >= header->symbol_count) {
+            return false;
+        }
+    }
+    for(size_t i = 0; i < header->tac_count; i++) {
+        if(tacs[i].type >= TAC_TYPE_COUNT) {
+            return false;
+        }
+        for(tac_operand_t operand = 0; operand < TAC_OPERANDS; operand++) {
+            uint32_t index = tacs[i].operands[operand];
+            if(index != TAC_FILE_NONE && index >= header->symbol_count) {
+                return false;
+            }
+            if(index == TAC_FILE_NONE && tac_file_requires_operand(&tacs[i], symbols, operand)) {
+                return false;
+            }
+        }
+        uint32_t function = tac_file_function_operand(&tacs[i]);
+        if(function != TAC_FILE_NONE && symbols[function].type != symbol_function) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool tac_file_requires_operand(const tac_file_tac_t* tac, const tac_file_symbol_t* symbols,
+                               tac_operand_t operand) {
+    if(required_operands[tac->type] & (1 << operand)) {
+        return true;
+    }
+    // The result of an initializer is required, so its type can be read
+    return tac->type == tac_init && operand == tac_operand_op2 &&
+           symbols[tac->operands[tac_operand_res]].data_type == data_type_float;
+}
+
+
+// Operand naming the function that begins, ends, is called or is returned
+// from, TAC_FILE_NONE for other instructions
+uint32_t tac_file_function_operand(const tac_file_tac_t* tac) {
+    switch(tac->type) {
+        case tac_begin_function:
+        case tac_end_function:
+            return tac->operands[tac_operand_res];
+        case tac_call:
+        case tac_return:
+            return tac->operands[tac_operand_op1];
+        default:
+            return TAC_FILE_NONE;
+    }
+}
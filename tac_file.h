@@ -0,0 +1,42 @@
+#ifndef TAC_FILE_H
+#define TAC_FILE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "list.h"
+
+/*
+ * Binary form of a generated TAC program, so that the back end can run
+ * again without the front end. All fields are 32-bit words in host byte
+ * order, laid out one table after the other:
+ *
+ *   header        magic "ETAPATAC", version and the size of every table
+ *   symbols       name, symbol type, data type, scope, line, and the range
+ *                 of the function's parameters in the parameter table
+ *   parameters    symbol indices
+ *   instructions  TAC type and the symbol indices of res, op1 and op2
+ *   strings       NUL terminated symbol names
+ *
+ * A missing scope, parameter list or operand is stored as all ones.
+ * Loading maps the file and builds the symbols and instructions straight
+ * from the fixed-width records: names point into the mapping.
+ */
+
+#define TAC_FILE_VERSION 1
+
+typedef struct tac_file tac_file_t;
+
+// Returns false if writing to the stream failed
+bool write_tac_file(FILE* stream, list_t* code);
+
+// Returns NULL and sets errno if the file can't be mapped, errno is EINVAL
+// if it isn't a TAC file of this version
+tac_file_t* load_tac_file(const char* path);
+
+void delete_tac_file(tac_file_t* file);
+
+// Instructions of the file, owned by it
+list_t* tac_file_code(tac_file_t* file);
+
+#endif
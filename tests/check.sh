@@ -0,0 +1,161 @@
+#!/bin/sh
+# Checks the compiler given as the only argument. Every program with an
+# expected output must print it unoptimized, optimized and when scanned
+# from a memory-mapped source, once assembled and linked with $CC. Written
+# as an object with --object and linked with $CC, or run in process with
+# --run, it must print the same and exit with the same status as the
+# assembled program. TAC files damaged after --emit-tac must be refused by
+# --load-tac with EINVAL, without crashing.
+
+compiler=$1
+tests=$(dirname "$0")
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+failures=0
+
+# A missing operand
+TAC_FILE_NONE=4294967295
+
+# Number of a constant in an enumeration of the compiler's sources, which
+# all count from zero
+enum_number() {
+    awk -v enumeration="$2" -v name="$3" '
+        $0 ~ "^typedef enum " enumeration " \\{" { inside = 1; next }
+        inside && /\}/ { exit }
+        inside && NF { gsub(/[ \t,]/, ""); if($0 == name) print number + 0; number++ }
+    ' "$tests/../$1"
+}
+
+# Files are read and written as 32-bit little endian words
+read_word() {
+    od -An -tu4 -j $(($2 * 4)) -N 4 "$1" | tr -d ' '
+}
+
+write_word() {
+    value=$3
+    bytes=""
+    for byte in 1 2 3 4; do
+        bytes="$bytes\\$(printf '%03o' $((value & 255)))"
+        value=$((value >> 8))
+    done
+    printf "$bytes" | dd of="$1" bs=4 seek="$2" conv=notrunc 2>/dev/null
+}
+
+# Word index of the first instruction of the given type, after the header
+# and the symbol and parameter tables. When a data type is given, the
+# result of the instruction must have it.
+find_instruction() {
+    symbol_count=$(read_word "$1" 3)
+    parameter_count=$(read_word "$1" 4)
+    tac_count=$(read_word "$1" 5)
+    word=$((8 + symbol_count * 7 + parameter_count))
+    for i in $(seq 1 "$tac_count"); do
+        if [ "$(read_word "$1" "$word")" = "$2" ] &&
+           { [ -z "$3" ] || [ "$(read_word "$1" $((8 + $(read_word "$1" $((word + 1))) * 7 + 2)))" = "$3" ]; }; then
+            echo "$word"
+            return
+        fi
+        word=$((word + 4))
+    done
+}
+
+# Loads the damaged copy of the TAC file and expects it to be refused
+check_corrupt() {
+    if [ -z "$2" ]; then
+        echo "FAILED corrupt TAC file: $1 (no instruction to damage)"
+        failures=$((failures + 1))
+        return
+    fi
+    "$compiler" --load-tac "$work/corrupt.tac" "$work/corrupt.s" 2> "$work/corrupt.err" > /dev/null
+    status=$?
+    if [ $status -ne 0 ] && [ $status -lt 128 ] && grep -q "Invalid argument" "$work/corrupt.err"; then
+        echo "ok corrupt TAC file: $1"
+    else
+        echo "FAILED corrupt TAC file: $1 (exit status $status)"
+        failures=$((failures + 1))
+    fi
+}
+
+for expected in "$tests"/*.expected; do
+    program=${expected%.expected}
+    name=$(basename "$program")
+    for flags in --no-optimize "" --mmap; do
+        if "$compiler" $flags "$program.txt" "$work/$name.s" > /dev/null 2>&1 &&
+           ${CC:-cc} -o "$work/$name" "$work/$name.s" 2> /dev/null &&
+           "$work/$name" > "$work/$name.out" &&
+           cmp -s "$work/$name.out" "$expected"; then
+            echo "ok $name ${flags:-optimized}"
+        else
+            echo "FAILED $name ${flags:-optimized}"
+            failures=$((failures + 1))
+        fi
+    done
+    if "$compiler" --object "$program.txt" "$work/$name.o" > /dev/null 2>&1 &&
+       ${CC:-cc} -o "$work/$name" "$work/$name.o" 2> /dev/null &&
+       "$work/$name" > "$work/$name.out" &&
+       cmp -s "$work/$name.out" "$expected"; then
+        echo "ok $name --object"
+    else
+        echo "FAILED $name --object"
+        failures=$((failures + 1))
+    fi
+    rm -f "$work/$name"
+    "$compiler" "$program.txt" "$work/$name.s" > /dev/null 2>&1 &&
+    ${CC:-cc} -o "$work/$name" "$work/$name.s" 2> /dev/null
+    "$work/$name" > "$work/$name.out"
+    status=$?
+    "$compiler" --run "$program.txt" > "$work/$name.run" 2> /dev/null
+    if [ $? -eq $status ] && [ -s "$work/$name.out" ] && cmp -s "$work/$name.run" "$work/$name.out"; then
+        echo "ok $name --run"
+    else
+        echo "FAILED $name --run"
+        failures=$((failures + 1))
+    fi
+done
+
+# Unoptimized, so that every instruction type is still there
+if ! "$compiler" --no-optimize --emit-tac "$tests/tac_file.txt" "$work/valid.tac" > /dev/null 2>&1 ||
+   ! "$compiler" --load-tac "$work/valid.tac" "$work/valid.s" > /dev/null 2>&1; then
+    echo "FAILED TAC file round trip"
+    exit 1
+fi
+
+# One operand the back end reads, per instruction type, as the word of the
+# record that holds it
+for damage in init:op1 temp:res vector_uninit:op1 vector_init:op1 \
+              vector_init_value:op1 vector_index:op2 sum:op2 sub:op2 mul:op2 \
+              div:op2 eq:op2 dif:op2 gt:op2 ge:op2 lt:op2 le:op2 move:op1 \
+              vector_move:op2 begin_function:res end_function:res \
+              jump_false:op1 jump:res call:op1 argument:res parameter:res \
+              return:op1 print:res read:res label:res; do
+    type=${damage%:*}
+    operand=${damage#*:}
+    case $operand in
+        res) offset=1 ;;
+        op1) offset=2 ;;
+        op2) offset=3 ;;
+    esac
+    tac=$(find_instruction "$work/valid.tac" "$(enum_number tac.h tac_type "tac_$type")")
+    cp "$work/valid.tac" "$work/corrupt.tac"
+    [ -n "$tac" ] && write_word "$work/corrupt.tac" $((tac + offset)) $TAC_FILE_NONE
+    check_corrupt "$type without $operand" "$tac"
+done
+
+init=$(find_instruction "$work/valid.tac" "$(enum_number tac.h tac_type tac_init)" \
+       "$(enum_number data_type.h data_type data_type_float)")
+cp "$work/valid.tac" "$work/corrupt.tac"
+[ -n "$init" ] && write_word "$work/corrupt.tac" $((init + 3)) $TAC_FILE_NONE
+check_corrupt "float init without op2" "$init"
+
+call=$(find_instruction "$work/valid.tac" "$(enum_number tac.h tac_type tac_call)")
+cp "$work/valid.tac" "$work/corrupt.tac"
+[ -n "$call" ] && write_word "$work/corrupt.tac" $((call + 2)) "$(read_word "$work/valid.tac" $((call + 1)))"
+check_corrupt "call to a temporary" "$call"
+
+# The parameter count is the last word of the symbol record
+begin=$(find_instruction "$work/valid.tac" "$(enum_number tac.h tac_type tac_begin_function)")
+cp "$work/valid.tac" "$work/corrupt.tac"
+[ -n "$begin" ] && write_word "$work/corrupt.tac" $((8 + $(read_word "$work/valid.tac" $((begin + 1))) * 7 + 6)) $TAC_FILE_NONE
+check_corrupt "function without a parameter list" "$begin"
+
+[ $failures -eq 0 ]
@@ -0,0 +1,137 @@
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+typedef struct thread_pool_job thread_pool_job_t;
+
+struct thread_pool_job {
+    thread_pool_task_t task;
+    void* argument;
+    thread_pool_job_t* next;
+};
+
+struct thread_pool {
+    pthread_t* threads;
+    size_t thread_count;
+    pthread_mutex_t lock;
+    pthread_cond_t job_available;
+    pthread_cond_t all_done;
+    thread_pool_job_t* first;
+    thread_pool_job_t* last;
+    size_t pending;
+    bool stopping;
+};
+
+void* thread_pool_worker(void* argument);
+
+
+thread_pool_t* new_thread_pool(size_t threads) {
+    thread_pool_t* pool = malloc(sizeof(thread_pool_t));
+    pool->thread_count = threads > 0 ? threads : thread_pool_default_size();
+    pool->threads = malloc(pool->thread_count * sizeof(pthread_t));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->job_available, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+    pool->first = NULL;
+    pool->last = NULL;
+    pool->pending = 0;
+    pool->stopping = false;
+    for(size_t i = 0; i < pool->thread_count; i++) {
+        pthread_create(&pool->threads[i], NULL, &thread_pool_worker, pool);
+    }
+    return pool;
+}
+
+
+void delete_thread_pool(thread_pool_t* pool) {
+    if(pool == NULL) {
+        return;
+    }
+    thread_pool_wait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->job_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(size_t i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->all_done);
+    pthread_cond_destroy(&pool->job_available);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+
+void thread_pool_submit(thread_pool_t* pool, thread_pool_task_t task, void* argument) {
+    thread_pool_job_t* job = malloc(sizeof(thread_pool_job_t));
+    job->task = task;
+    job->argument = argument;
+    job->next = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if(pool->last != NULL) {
+        pool->last->next = job;
+    } else {
+        pool->first = job;
+    }
+    pool->last = job;
+    pool->pending++;
+    pthread_cond_signal(&pool->job_available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+void thread_pool_wait(thread_pool_t* pool) {
+    pthread_mutex_lock(&pool->lock);
+    while(pool->pending > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+size_t thread_pool_size(const thread_pool_t* pool) {
+    return pool->thread_count;
+}
+
+
+size_t thread_pool_default_size() {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (size_t)processors : 1;
+}
+
+
+void* thread_pool_worker(void* argument) {
+    thread_pool_t* pool = argument;
+    pthread_mutex_lock(&pool->lock);
+    while(true) {
+        while(pool->first == NULL && !pool->stopping) {
+            pthread_cond_wait(&pool->job_available, &pool->lock);
+        }
+        if(pool->first == NULL) {
+            break;
+        }
+        thread_pool_job_t* job = pool->first;
+        pool->first = job->next;
+        if(pool->first == NULL) {
+            pool->last = NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        job->task(job->argument);
+        free(job);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->pending--;
+        if(pool->pending == 0) {
+            pthread_cond_broadcast(&pool->all_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
@@ -0,0 +1,24 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdlib.h>
+
+typedef struct thread_pool thread_pool_t;
+
+typedef void (*thread_pool_task_t)(void* argument);
+
+// A thread count of zero sizes the pool to the number of online processors
+thread_pool_t* new_thread_pool(size_t threads);
+
+// Waits for every submitted task before stopping the workers
+void delete_thread_pool(thread_pool_t* pool);
+
+void thread_pool_submit(thread_pool_t* pool, thread_pool_task_t task, void* argument);
+
+void thread_pool_wait(thread_pool_t* pool);
+
+size_t thread_pool_size(const thread_pool_t* pool);
+
+size_t thread_pool_default_size();
+
+#endif
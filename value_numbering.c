@@ -0,0 +1,263 @@
+#include "value_numbering.h"
+
+#include <stdlib.h>
+
+#include "optimizer.h"
+
+typedef struct symbol_value {
+    // Block the value number was given in, it is unknown in other blocks
+    size_t block;
+    // Calls made in the block before the value number was given
+    size_t calls;
+    size_t value;
+    // Literals keep their value number in every block
+    bool constant;
+} symbol_value_t;
+
+typedef struct value_expression {
+    size_t block;
+    tac_type_t type;
+    data_type_t data_type;
+    size_t first;
+    size_t second;
+    // Symbol the result was written to, which holds it while its value
+    // number is still the result's
+    symbol_t* holder;
+    size_t value;
+} value_expression_t;
+
+typedef struct value_numberer {
+    compilation_context_t* context;
+    tac_buffer_t* buffer;
+    size_t block;
+    size_t calls;
+    size_t next_value;
+    // Indexed by symbol id
+    symbol_value_t* symbols;
+    // Open addressing table of the operations of the current block, entries
+    // of earlier blocks are free slots
+    value_expression_t* expressions;
+    size_t expression_capacity;
+    size_t expression_count;
+} value_numberer_t;
+
+void number_literals(value_numberer_t* numberer);
+
+void number_function_values(value_numberer_t* numberer, tac_function_range_t range);
+
+void number_expression(value_numberer_t* numberer, tac_id_t id);
+
+void start_value_block(value_numberer_t* numberer);
+
+size_t symbol_value(value_numberer_t* numberer, const symbol_t* symbol);
+
+void set_symbol_value(value_numberer_t* numberer, const symbol_t* symbol, size_t value);
+
+value_expression_t* find_expression(value_numberer_t* numberer, const value_expression_t* key);
+
+void grow_expressions(value_numberer_t* numberer);
+
+bool is_commutative(tac_type_t type);
+
+
+void number_values(compilation_context_t* context, tac_buffer_t* buffer) {
+    value_numberer_t numberer;
+    numberer.context = context;
+    numberer.buffer = buffer;
+    numberer.block = 0;
+    numberer.calls = 0;
+    numberer.next_value = 0;
+    numberer.symbols = calloc(symbol_table_size(context->symbol_table), sizeof(symbol_value_t));
+    numberer.expression_capacity = 64;
+    numberer.expressions = calloc(numberer.expression_capacity, sizeof(value_expression_t));
+    numberer.expression_count = 0;
+
+    number_literals(&numberer);
+    for(size_t i = 0; i < tac_buffer_function_count(buffer); i++) {
+        number_function_values(&numberer, tac_buffer_function(buffer, i));
+    }
+
+    free(numberer.symbols);
+    free(numberer.expressions);
+}
+
+
+// Literals initialized with the same literal and of the same type share
+// their value number, wherever they were created
+void number_literals(value_numberer_t* numberer) {
+    tac_buffer_t* buffer = numberer->buffer;
+    symbol_t** first_literals = calloc(symbol_table_size(numberer->context->symbol_table), sizeof(symbol_t*));
+    for(tac_id_t id = tac_buffer_first(buffer); id != TAC_ID_NONE; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        if(tac->type != tac_init || tac->res->type != symbol_label || tac->op2 != NOP) {
+            continue;
+        }
+        symbol_value_t* value = &numberer->symbols[tac->res->id];
+        symbol_t* first = first_literals[tac->op1->id];
+        if(first != NULL && first->data_type == tac->res->data_type) {
+            *value = numberer->symbols[first->id];
+            continue;
+        }
+        if(first == NULL) {
+            first_literals[tac->op1->id] = tac->res;
+        }
+        value->value = numberer->next_value++;
+        value->constant = true;
+    }
+    free(first_literals);
+}
+
+
+// Symbols a call clobbers get a new value number when read after it, and
+// expressions they hold are no longer found
+void number_function_values(value_numberer_t* numberer, tac_function_range_t range) {
+    tac_buffer_t* buffer = numberer->buffer;
+    start_value_block(numberer);
+    for(tac_id_t id = range.begin; id != TAC_ID_NONE && id != range.end; id = tac_buffer_next(buffer, id)) {
+        tac_t* tac = tac_buffer_get(buffer, id);
+        switch(tac->type) {
+            case tac_label:
+                start_value_block(numberer);
+                break;
+            case tac_call:
+                numberer->calls++;
+                break;
+            case tac_sum:
+            case tac_sub:
+            case tac_mul:
+            case tac_div:
+            case tac_eq:
+            case tac_dif:
+            case tac_gt:
+            case tac_ge:
+            case tac_lt:
+            case tac_le:
+            case tac_vector_index:
+                number_expression(numberer, id);
+                break;
+            // Conversions give a new value
+            case tac_move:
+                if(tac->res->data_type == tac->op1->data_type) {
+                    set_symbol_value(numberer, tac->res, symbol_value(numberer, tac->op1));
+                } else {
+                    set_symbol_value(numberer, tac->res, numberer->next_value++);
+                }
+                break;
+            // The value number of a vector stands for its elements
+            case tac_vector_move:
+                set_symbol_value(numberer, tac->res, numberer->next_value++);
+                break;
+            default:
+                if(tac_operand_is_definition(tac->type, tac_operand_res)) {
+                    set_symbol_value(numberer, tac->res, numberer->next_value++);
+                }
+                break;
+        }
+    }
+}
+
+
+// Operands are converted to the type of the result, which is part of the
+// expression with the value numbers of the operands
+void number_expression(value_numberer_t* numberer, tac_id_t id) {
+    tac_t* tac = tac_buffer_get(numberer->buffer, id);
+    value_expression_t key;
+    key.block = numberer->block;
+    key.type = tac->type;
+    key.data_type = tac->res->data_type;
+    key.first = symbol_value(numberer, tac->op1);
+    key.second = symbol_value(numberer, tac->op2);
+    if(is_commutative(tac->type) && key.first > key.second) {
+        size_t first = key.first;
+        key.first = key.second;
+        key.second = first;
+    }
+
+    value_expression_t* expression = find_expression(numberer, &key);
+    if(expression->block == numberer->block && expression->holder != tac->res &&
+       symbol_value(numberer, expression->holder) == expression->value) {
+        tac->type = tac_move;
+        tac->op1 = expression->holder;
+        tac->op2 = NOP;
+        set_symbol_value(numberer, tac->res, expression->value);
+        numberer->context->statistics.reused_expressions++;
+        return;
+    }
+
+    bool is_new = expression->block != numberer->block;
+    *expression = key;
+    expression->holder = tac->res;
+    expression->value = numberer->next_value++;
+    set_symbol_value(numberer, tac->res, expression->value);
+    if(is_new && ++numberer->expression_count * 2 > numberer->expression_capacity) {
+        grow_expressions(numberer);
+    }
+}
+
+
+// Value numbers are never given twice, so those of earlier blocks match
+// nothing in the new one
+void start_value_block(value_numberer_t* numberer) {
+    numberer->block++;
+    numberer->expression_count = 0;
+}
+
+
+// Symbols first read in the block, or since a call clobbered them, get a
+// new value number
+size_t symbol_value(value_numberer_t* numberer, const symbol_t* symbol) {
+    symbol_value_t* value = &numberer->symbols[symbol->id];
+    if(!value->constant && (value->block != numberer->block ||
+                            (value->calls != numberer->calls && tac_call_clobbers(symbol)))) {
+        value->block = numberer->block;
+        value->calls = numberer->calls;
+        value->value = numberer->next_value++;
+    }
+    return value->value;
+}
+
+
+void set_symbol_value(value_numberer_t* numberer, const symbol_t* symbol, size_t value) {
+    numberer->symbols[symbol->id].block = numberer->block;
+    numberer->symbols[symbol->id].calls = numberer->calls;
+    numberer->symbols[symbol->id].value = value;
+}
+
+
+// Returns the entry of the expression, or the free slot where it goes
+value_expression_t* find_expression(value_numberer_t* numberer, const value_expression_t* key) {
+    size_t hash = (size_t)key->type;
+    hash = hash * 31 + (size_t)key->data_type;
+    hash = hash * 1000003 + key->first;
+    hash = hash * 1000003 + key->second;
+    size_t mask = numberer->expression_capacity - 1;
+    for(size_t i = hash & mask; ; i = (i + 1) & mask) {
+        value_expression_t* expression = &numberer->expressions[i];
+        if(expression->block != numberer->block) {
+            return expression;
+        }
+        if(expression->type == key->type && expression->data_type == key->data_type &&
+           expression->first == key->first && expression->second == key->second) {
+            return expression;
+        }
+    }
+}
+
+
+void grow_expressions(value_numberer_t* numberer) {
+    value_expression_t* expressions = numberer->expressions;
+    size_t capacity = numberer->expression_capacity;
+    numberer->expression_capacity = capacity * 2;
+    numberer->expressions = calloc(numberer->expression_capacity, sizeof(value_expression_t));
+    for(size_t i = 0; i < capacity; i++) {
+        if(expressions[i].block == numberer->block) {
+            *find_expression(numberer, &expressions[i]) = expressions[i];
+        }
+    }
+    free(expressions);
+}
+
+
+bool is_commutative(tac_type_t type) {
+    return type == tac_sum || type == tac_mul || type == tac_eq || type == tac_dif;
+}
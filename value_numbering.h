@@ -0,0 +1,18 @@
+#ifndef VALUE_NUMBERING_H
+#define VALUE_NUMBERING_H
+
+#include "compilation_context.h"
+#include "tac_buffer.h"
+
+/*
+ * Local value numbering. Within each basic block, an arithmetic operation,
+ * comparison or vector read of the same operands as an earlier one becomes
+ * a move from the symbol holding the earlier result, as long as none of
+ * the operands changed in between. Moves carry the value of their source,
+ * and vector writes change every element of the vector. A call does not
+ * end the block: only the symbols tac_call_clobbers matches get a new
+ * value number when read after it.
+ */
+void number_values(compilation_context_t* context, tac_buffer_t* buffer);
+
+#endif
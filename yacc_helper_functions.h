@@ -1,10 +1,12 @@
 #ifndef YACC_HELPER_FUNCTIONS_H
 #define YACC_HELPER_FUNCTIONS_H
 
-#include "syntax_tree.h"
+#include "compilation_context.h"
 
-void yacc_init(ast_t* ast);
+void yacc_init(compilation_context_t* context);
 
-bool syntax_error_occured();
+int yacc_parse(compilation_context_t* context);
+
+bool syntax_error_occured(compilation_context_t* context);
 
 #endif